@@ -0,0 +1,215 @@
+/**
+ * Benchmark da compressão de fluxo
+ * --------------------------------
+ * Mede a troca entre banda e CPU da compressão por conexão (deflate com
+ * contexto persistente e Z_SYNC_FLUSH por mensagem) em três cargas:
+ *
+ *   - conversa: DELIVER_MSG de alguns remetentes com frases
+ *     variadas (o que um LOGIN com fila offline grande entrega)
+ *   - USERS: respostas repetidas de LIST_USERS com 200 usuários
+ *   - bate-papo curto: DELIVER_MSG/OK pequenos, abaixo do limite de
+ *     compressão (mostra que o caminho de latência não muda)
+ *
+ * Para cada carga compara os bytes no fio (frames LENGTH completos) e o
+ * custo por mensagem de comprimir e descomprimir: sem compressão, deflate
+ * sem contexto (um fluxo novo por mensagem) e o fluxo persistente em alguns
+ * níveis. Antes de medir, confere que cada mensagem volta idêntica.
+ *
+ * Uso: bench_compression [--messages N]
+ */
+
+#include "compression.hpp"
+#include "protocol.hpp"
+#include "socket_utils.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+
+struct Workload
+{
+    const char* name;
+    vector<string> messages;
+};
+
+/**
+ * Frases "naturais" a partir de um vocabulário pequeno (gerador fixo:
+ * resultados reproduzíveis)
+ */
+string sentence(uint32_t& seed)
+{
+    static const char* WORDS[] = {
+        "oi", "tudo", "bem", "hoje", "amanhã", "reunião", "projeto", "servidor", "cliente",
+        "mensagem", "vamos", "almoçar", "depois", "da", "aula", "você", "viu", "o", "relatório",
+        "está", "pronto", "falta", "revisar", "a", "parte", "de", "testes", "já", "enviei",
+        "obrigado", "até", "mais", "tarde", "então", "combinado", "às", "três", "horas",
+    };
+    constexpr size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+    string text;
+    seed = seed * 1103515245 + 12345;
+    size_t words = 6 + (seed >> 16) % 30;
+    for (size_t i = 0; i < words; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        if (i > 0)
+            text.push_back(' ');
+        text.append(WORDS[(seed >> 16) % WORD_COUNT]);
+    }
+    return text;
+}
+
+vector<Workload> buildWorkloads(size_t count)
+{
+    const char* senders[] = {"maria_s", "joao_p", "ana_b", "carlos_r"};
+    uint32_t seed = 42;
+
+    Workload history{"conversa", {}};
+    for (size_t i = 0; i < count; ++i)
+        history.messages.push_back(Protocol::encodeDeliverMessage(senders[i % 4], sentence(seed),
+                                                                  1700000000 + static_cast<time_t>(i)));
+
+    vector<Protocol::UserInfo> users;
+    for (int i = 0; i < 200; ++i)
+        users.push_back({"user" + to_string(i), "Usuário número " + to_string(i), i % 3 == 0});
+
+    Workload lists{"USERS (200)", {}};
+    for (size_t i = 0; i < count / 50 + 1; ++i)
+    {
+        users[i % users.size()].isOnline = !users[i % users.size()].isOnline;
+        lists.messages.push_back(Protocol::encodeUsersList(users));
+    }
+
+    Workload chat{"curtas", {}};
+    for (size_t i = 0; i < count; ++i)
+        chat.messages.push_back(i % 2 ? string(Protocol::OK_RESPONSE)
+                                      : Protocol::encodeDeliverMessage(senders[i % 4], "ok!", 1700000000));
+
+    return {history, lists, chat};
+}
+
+struct Mode
+{
+    const char* name;
+    bool compress;
+    bool persistent;    // Um contexto para a conexão inteira (senão um por mensagem)
+    int level;
+};
+
+const Mode MODES[] = {
+    {"sem compressão", false, false, 0},
+    {"deflate/msg 6", true, false, 6},
+    {"fluxo 1", true, true, 1},
+    {"fluxo 6", true, true, 6},
+    {"fluxo 9", true, true, 9},
+};
+
+struct Result
+{
+    size_t wireBytes = 0;
+    double compressNs = 0;
+    double decompressNs = 0;
+    bool ok = true;
+};
+
+/**
+ * Envia a carga como faria a OutboundQueue (mesmo limite de tamanho e mesma
+ * flag no cabeçalho) e a recebe como o FrameReader.
+ */
+Result run(const Workload& workload, const Mode& mode)
+{
+    Result result;
+    vector<string> frames;
+    frames.reserve(workload.messages.size());
+
+    unique_ptr<DeflateStream> deflater = make_unique<DeflateStream>(mode.level);
+    auto start = chrono::steady_clock::now();
+    for (const string& message : workload.messages)
+    {
+        string frame(SocketUtils::FRAME_HEADER_SIZE, '\0');
+        uint8_t type = 0;
+        if (mode.compress && message.size() >= SocketUtils::MIN_COMPRESSED_SIZE)
+        {
+            if (!mode.persistent)
+                deflater = make_unique<DeflateStream>(mode.level);
+            deflater->compress(message, frame);
+            type = SocketUtils::COMPRESSED_FRAME_FLAG;
+        }
+        else
+            frame.append(message);
+
+        SocketUtils::writeFrameHeader(frame.data(), frame.size() - SocketUtils::FRAME_HEADER_SIZE, type);
+        result.wireBytes += frame.size();
+        frames.push_back(std::move(frame));
+    }
+    result.compressNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+    unique_ptr<InflateStream> inflater = make_unique<InflateStream>();
+    string out;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        string_view payload = string_view(frames[i]).substr(SocketUtils::FRAME_HEADER_SIZE);
+        out.clear();
+        if (static_cast<uint8_t>(frames[i][4]) & SocketUtils::COMPRESSED_FRAME_FLAG)
+        {
+            if (!mode.persistent)
+                inflater = make_unique<InflateStream>();
+            result.ok &= inflater->decompress(payload, out, SocketUtils::MAX_LENGTH_FRAME_SIZE);
+        }
+        else
+            out.assign(payload);
+        result.ok &= out == workload.messages[i];
+    }
+    result.decompressNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+    result.compressNs /= workload.messages.size();
+    result.decompressNs /= workload.messages.size();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    size_t messages = 20000;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--messages" && i + 1 < argc) messages = stoul(argv[++i]);
+    }
+
+    cout << left << setw(14) << "Carga" << setw(18) << "Modo"
+         << right << setw(12) << "bytes" << setw(10) << "% cru"
+         << setw(14) << "comp ns/msg" << setw(14) << "desc ns/msg" << endl;
+
+    for (const Workload& workload : buildWorkloads(messages))
+    {
+        size_t raw = 0;
+        for (const Mode& mode : MODES)
+        {
+            Result result = run(workload, mode);
+            if (!result.ok)
+            {
+                cerr << "Divergência: " << workload.name << " / " << mode.name << endl;
+                return 1;
+            }
+            if (!mode.compress)
+                raw = result.wireBytes;
+
+            cout << left << setw(14) << workload.name << setw(18) << mode.name << right << fixed
+                 << setw(12) << result.wireBytes << setw(9) << setprecision(1)
+                 << 100.0 * result.wireBytes / raw << "%"
+                 << setw(14) << result.compressNs << setw(14) << result.decompressNs << endl;
+        }
+        cout << endl;
+    }
+    return 0;
+}
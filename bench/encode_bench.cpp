@@ -0,0 +1,131 @@
+/**
+ * Benchmark do encoder de respostas
+ * ---------------------------------
+ * Confere que os encoders diretos (Protocol::encodeDeliverMessage &cia. e
+ * as respostas constantes) produzem exatamente os bytes do dump() dos
+ * builders sobre nlohmann::json, inclusive com escapes e UTF-8, e compara
+ * o tempo de serialização dos dois caminhos.
+ *
+ * Uso: bench_encode [--iterations N]
+ */
+
+#include "protocol.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Protocol;
+
+namespace
+{
+
+int mismatches = 0;
+
+void expectSame(const string& name, const string& expected, string_view actual)
+{
+    if (expected == actual)
+        return;
+
+    ++mismatches;
+    cerr << "Divergência em " << name << ":\n  dump:    " << expected << "\n  encoder: " << actual << endl;
+}
+
+void checkCompatibility()
+{
+    expectSame("OK", buildOkResponse().dump(), OK_RESPONSE);
+    for (int e = 0; e <= static_cast<int>(ErrorType::INTERNAL_SERVER_ERROR); ++e)
+    {
+        auto error = static_cast<ErrorType>(e);
+        expectSame(errorTypeToString(error), buildErrorResponse(error).dump(), errorResponse(error));
+    }
+
+    // Texto com tudo o que exige escape (e o que não exige: DEL, UTF-8)
+    string tricky = "aspas \" barra \\ / tab\t nl\n cr\r bs\b ff\f nul";
+    tricky.push_back('\0');
+    tricky += " \x01\x1f\x7f Olá, João — ✓ 😀";
+
+    vector<string> texts = {"", "oi", tricky, string(4096, 'x')};
+    for (const string& text : texts)
+    {
+        expectSame("DELIVER_MSG", buildDeliverMessage("maria_s", text, 1700000000).dump(),
+                   encodeDeliverMessage("maria_s", text, 1700000000));
+        expectSame("LOGIN_OK", buildLoginOkResponse(text).dump(), encodeLoginOk(text));
+    }
+    expectSame("DELIVER_MSG ts", buildDeliverMessage("a", "b", 0).dump(), encodeDeliverMessage("a", "b", 0));
+    expectSame("DELIVER_MSG ts<0", buildDeliverMessage("a", "b", -5).dump(), encodeDeliverMessage("a", "b", -5));
+    expectSame("HELLO_OK", buildHelloOkResponse("length", "msgpack").dump(), encodeHelloOk("length", "msgpack"));
+    expectSame("HELLO_OK deflate", buildHelloOkResponse("length", "json", "deflate").dump(),
+               encodeHelloOk("length", "json", "deflate"));
+
+    vector<UserInfo> users;
+    expectSame("USERS vazio", buildUsersListResponse(users).dump(), encodeUsersList(users));
+    users.push_back({"maria_s", "Maria \"da\" Silva", true});
+    users.push_back({"joao_p", tricky, false});
+    expectSame("USERS", buildUsersListResponse(users).dump(), encodeUsersList(users));
+
+    expectSame("BATCH_OK vazio", buildBatchOkResponse({}).dump(), encodeBatchOk({}));
+    expectSame("BATCH_OK", buildBatchOkResponse({buildOkResponse(), buildErrorResponse(ErrorType::BAD_FORMAT),
+                                                 buildUsersListResponse(users)}).dump(),
+               encodeBatchOk({string(OK_RESPONSE), string(errorResponse(ErrorType::BAD_FORMAT)),
+                              encodeUsersList(users)}));
+}
+
+template <typename Encoder>
+double measure(int iterations, Encoder encoder)
+{
+    volatile size_t sink = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        sink = sink + encoder().size();
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / iterations;
+}
+
+void report(const char* name, double dom, double direct)
+{
+    cout << left << setw(16) << name << right << fixed << setprecision(1)
+         << setw(14) << dom << setw(14) << direct << setw(9) << dom / direct << "x" << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int iterations = 200000;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) iterations = stoi(argv[++i]);
+    }
+
+    checkCompatibility();
+    if (mismatches > 0)
+        return 1;
+
+    string text(120, 'x');
+    vector<UserInfo> users;
+    for (int i = 0; i < 50; ++i)
+        users.push_back({"user" + to_string(i), "Usuário número " + to_string(i), i % 3 == 0});
+
+    cout << left << setw(16) << "Resposta" << right << setw(14) << "dump ns/op"
+         << setw(14) << "direto ns/op" << setw(10) << "ganho" << endl;
+
+    report("OK",
+           measure(iterations, [] { return buildOkResponse().dump(); }),
+           measure(iterations, [] { return string(OK_RESPONSE); }));
+    report("ERROR",
+           measure(iterations, [] { return buildErrorResponse(ErrorType::NO_SUCH_USER).dump(); }),
+           measure(iterations, [] { return string(errorResponse(ErrorType::NO_SUCH_USER)); }));
+    report("LOGIN_OK",
+           measure(iterations, [] { return buildLoginOkResponse("maria_s").dump(); }),
+           measure(iterations, [] { return encodeLoginOk("maria_s"); }));
+    report("DELIVER_MSG",
+           measure(iterations, [&] { return buildDeliverMessage("maria_s", text, 1700000000).dump(); }),
+           measure(iterations, [&] { return encodeDeliverMessage("maria_s", text, 1700000000); }));
+    report("USERS (50)",
+           measure(iterations / 10, [&] { return buildUsersListResponse(users).dump(); }),
+           measure(iterations / 10, [&] { return encodeUsersList(users); }));
+    return 0;
+}
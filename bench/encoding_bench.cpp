@@ -0,0 +1,165 @@
+/**
+ * Benchmark das codificações do fio
+ * ---------------------------------
+ * Para um conjunto de mensagens típicas do protocolo (requisições e
+ * respostas), compara JSON, MessagePack, CBOR e o protocolo compacto: bytes
+ * no fio (payload do frame, sem o cabeçalho de 5 bytes do framing LENGTH),
+ * custo de serializar o DOM e custo de interpretar os bytes de volta para o
+ * DOM. Antes de medir, confere que cada codificação reproduz a mensagem
+ * original. Por fim, compara o parse das requisições no servidor
+ * (Protocol::parseRequest) em JSON e no protocolo compacto.
+ *
+ * Uso: bench_encoding [--iterations N]
+ */
+
+#include "compact_codec.hpp"
+#include "protocol.hpp"
+#include "request_parser.hpp"
+#include "socket_utils.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using json = nlohmann::json;
+using SocketUtils::Encoding;
+
+namespace
+{
+
+const Encoding ENCODINGS[] = {Encoding::JSON, Encoding::MSGPACK, Encoding::CBOR, Encoding::COMPACT};
+
+struct Sample
+{
+    const char* name;
+    json message;
+};
+
+vector<Sample> buildSamples()
+{
+    string text(120, 'x');
+    vector<Protocol::UserInfo> users;
+    for (int i = 0; i < 50; ++i)
+        users.push_back({"user" + to_string(i), "Usuário número " + to_string(i), i % 3 == 0});
+
+    return {
+        {"REGISTER", Protocol::buildRegisterRequest("maria_s", "Maria da Silva")},
+        {"LOGIN", Protocol::buildLoginRequest("maria_s")},
+        {"SEND_MSG", Protocol::buildSendMessageRequest("joao_p", text)},
+        {"OK", Protocol::buildOkResponse()},
+        {"DELIVER_MSG", Protocol::buildDeliverMessage("maria_s", text, 1700000000)},
+        {"USERS (50)", Protocol::buildUsersListResponse(users)},
+    };
+}
+
+string serialize(const json& message, Encoding encoding)
+{
+    switch (encoding)
+    {
+        case Encoding::MSGPACK:
+        {
+            string out;
+            json::to_msgpack(message, out);
+            return out;
+        }
+        case Encoding::CBOR:
+        {
+            string out;
+            json::to_cbor(message, out);
+            return out;
+        }
+        case Encoding::COMPACT:
+            return Protocol::encodeCompact(message);
+        default:
+            return message.dump();
+    }
+}
+
+template <typename Operation>
+double measure(int iterations, Operation operation)
+{
+    volatile size_t sink = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        sink = sink + operation();
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int iterations = 100000;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) iterations = stoi(argv[++i]);
+    }
+
+    vector<Sample> samples = buildSamples();
+
+    // Ida e volta por cada codificação, e o caminho do servidor (toWire) igual ao do DOM
+    for (const Sample& sample : samples)
+    {
+        for (Encoding encoding : ENCODINGS)
+        {
+            string wire = serialize(sample.message, encoding);
+            if (Protocol::parseWire(wire, encoding) != sample.message ||
+                Protocol::toWire(sample.message.dump(), encoding) != wire ||
+                (encoding != Encoding::JSON && Protocol::detectEncoding(wire) != encoding))
+            {
+                cerr << "Divergência em " << sample.name << " (" << SocketUtils::encodingName(encoding) << ")" << endl;
+                return 1;
+            }
+        }
+    }
+
+    cout << left << setw(16) << "Mensagem" << setw(10) << "Codif." << right
+         << setw(10) << "bytes" << setw(12) << "% do JSON"
+         << setw(14) << "serial. ns" << setw(14) << "parse ns" << endl;
+
+    for (const Sample& sample : samples)
+    {
+        int rounds = sample.message.dump().size() > 1024 ? iterations / 10 : iterations;
+        size_t json_bytes = sample.message.dump().size();
+
+        for (Encoding encoding : ENCODINGS)
+        {
+            string wire = serialize(sample.message, encoding);
+            double serialize_ns = measure(rounds, [&] { return serialize(sample.message, encoding).size(); });
+            double parse_ns = measure(rounds, [&] { return Protocol::parseWire(wire, encoding).size(); });
+
+            cout << left << setw(16) << sample.name << setw(10) << SocketUtils::encodingName(encoding)
+                 << right << setw(10) << wire.size() << fixed << setprecision(1)
+                 << setw(11) << 100.0 * wire.size() / json_bytes << "%"
+                 << setw(14) << serialize_ns << setw(14) << parse_ns << endl;
+        }
+    }
+
+    // Caminho do servidor: parseRequest (views, sem DOM) nos dois formatos
+    cout << endl << left << setw(16) << "Requisição" << right
+         << setw(14) << "json ns/op" << setw(14) << "compact ns/op" << endl;
+    for (const Sample& sample : samples)
+    {
+        Protocol::MessageType type = Protocol::parseMessageType(sample.message);
+        if (type != Protocol::MessageType::REGISTER && type != Protocol::MessageType::LOGIN &&
+            type != Protocol::MessageType::SEND_MSG)
+            continue;
+
+        string text = sample.message.dump();
+        string compact = Protocol::encodeCompact(sample.message);
+        auto parse = [](const string& frame)
+        {
+            Protocol::Request request = Protocol::parseRequest(frame);
+            return request.nickname.value.size() + request.fullname.value.size() +
+                   request.to.value.size() + request.text.value.size();
+        };
+
+        cout << left << setw(16) << sample.name << right << fixed << setprecision(1)
+             << setw(14) << measure(iterations, [&] { return parse(text); })
+             << setw(14) << measure(iterations, [&] { return parse(compact); }) << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,266 @@
+/**
+ * Gerador de carga do mensageiro
+ * ------------------------------
+ * Abre N conexões, registra e loga um usuário por conexão e faz cada par
+ * (0↔1, 2↔3, ...) trocar M mensagens SEND_MSG. Mede mensagens roteadas por
+ * segundo e, se o PID do servidor for informado, o tempo de CPU consumido
+ * pelo servidor (mensagens por segundo de CPU ≈ mensagens/s por núcleo).
+ *
+ * Com --batch B os SEND_MSG vão em envelopes BATCH de B requisições (um frame
+ * e um BATCH_OK por envelope); a janela continua contada em mensagens.
+ *
+ * Uso: bench_load [host] [porta] [--clients N] [--messages M] [--window W] [--batch B] [--server-pid PID]
+ *
+ * Exemplo comparando backends:
+ *   ./build/server 12345 --mode epoll >/dev/null & ./build/bench_load --server-pid $!
+ *   ./build/server 12345 --mode uring >/dev/null & ./build/bench_load --server-pid $!
+ */
+
+#include "protocol.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using json = nlohmann::json;
+
+namespace
+{
+
+struct Options
+{
+    string host = "127.0.0.1";
+    int port = 12345;
+    int clients = 16;
+    int messages = 10000;
+    int window = 16;
+    int batch = 1;
+    int serverPid = -1;
+};
+
+/**
+ * Conexão bloqueante com leitura bufferizada por linha
+ */
+class BenchConnection
+{
+public:
+    bool connectTo(const string& host, int port)
+    {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+        return connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0;
+    }
+
+    ~BenchConnection() { if (fd >= 0) close(fd); }
+
+    bool sendLine(const string& line)
+    {
+        string data = line + "\n";
+        size_t sent = 0;
+        while (sent < data.size())
+        {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += n;
+        }
+        return true;
+    }
+
+    bool readLine(string& line)
+    {
+        while (true)
+        {
+            size_t pos = buffer.find('\n', offset);
+            if (pos != string::npos)
+            {
+                line.assign(buffer, offset, pos - offset);
+                offset = pos + 1;
+                return true;
+            }
+
+            buffer.erase(0, offset);
+            offset = 0;
+
+            char chunk[16384];
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) return false;
+            buffer.append(chunk, n);
+        }
+    }
+
+private:
+    int fd = -1;
+    string buffer;
+    size_t offset = 0;
+};
+
+/**
+ * Tempo de CPU (usuário + sistema) do processo em segundos, via /proc
+ */
+double processCpuSeconds(int pid)
+{
+    ifstream stat("/proc/" + to_string(pid) + "/stat");
+    string content((istreambuf_iterator<char>(stat)), istreambuf_iterator<char>());
+    size_t pos = content.rfind(')');
+    if (pos == string::npos) return 0.0;
+
+    istringstream fields(content.substr(pos + 2));
+    string field;
+    unsigned long utime = 0, stime = 0;
+    for (int i = 3; i <= 15 && fields >> field; ++i)
+    {
+        if (i == 14) utime = stoul(field);
+        if (i == 15) stime = stoul(field);
+    }
+    return static_cast<double>(utime + stime) / sysconf(_SC_CLK_TCK);
+}
+
+bool isType(const string& line, const char* type)
+{
+    return line.find(string("\"type\":\"") + type + "\"") != string::npos;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    int positional = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--clients" && i + 1 < argc) opt.clients = stoi(argv[++i]);
+        else if (arg == "--messages" && i + 1 < argc) opt.messages = stoi(argv[++i]);
+        else if (arg == "--window" && i + 1 < argc) opt.window = stoi(argv[++i]);
+        else if (arg == "--batch" && i + 1 < argc) opt.batch = stoi(argv[++i]);
+        else if (arg == "--server-pid" && i + 1 < argc) opt.serverPid = stoi(argv[++i]);
+        else if (positional++ == 0) opt.host = arg;
+        else opt.port = stoi(arg);
+    }
+    if (opt.clients % 2) ++opt.clients;
+    opt.batch = max(1, min(opt.batch, static_cast<int>(Protocol::MAX_BATCH_SIZE)));
+
+    string prefix = "b" + to_string(getpid() % 100000) + "_";
+    vector<unique_ptr<BenchConnection>> conns;
+
+    // Registro e login
+    for (int i = 0; i < opt.clients; ++i)
+    {
+        auto conn = make_unique<BenchConnection>();
+        if (!conn->connectTo(opt.host, opt.port))
+        {
+            cerr << "Falha ao conectar cliente " << i << endl;
+            return 1;
+        }
+
+        string nick = prefix + to_string(i);
+        string line;
+        conn->sendLine(Protocol::buildRegisterRequest(nick, "Bench " + to_string(i)).dump());
+        conn->readLine(line);
+        conn->sendLine(Protocol::buildLoginRequest(nick).dump());
+        conn->readLine(line);
+        if (!isType(line, "LOGIN_OK"))
+        {
+            cerr << "Login falhou para " << nick << ": " << line << endl;
+            return 1;
+        }
+        conns.push_back(std::move(conn));
+    }
+
+    atomic<long> failures{0};
+    double cpu_before = opt.serverPid > 0 ? processCpuSeconds(opt.serverPid) : 0.0;
+    auto start = chrono::steady_clock::now();
+
+    vector<thread> workers;
+    for (int i = 0; i < opt.clients; ++i)
+    {
+        workers.emplace_back([&, i]()
+        {
+            BenchConnection& conn = *conns[i];
+            string peer = prefix + to_string(i ^ 1);
+            json message = Protocol::buildSendMessageRequest(peer, "mensagem de benchmark");
+            string request = message.dump();
+
+            // Envelope cheio e o do resto (o último pode ser menor)
+            auto envelope = [&](int count)
+            {
+                return Protocol::buildBatchRequest(vector<json>(count, message)).dump();
+            };
+            string full_batch = envelope(opt.batch);
+            string last_batch = envelope(max(1, opt.messages % opt.batch));
+
+            int sent = 0, acked = 0, delivered = 0;
+            string line;
+
+            // Janela de requisições em voo; entregas do par chegam intercaladas
+            while (acked < opt.messages || delivered < opt.messages)
+            {
+                while (sent < opt.messages && sent - acked < opt.window)
+                {
+                    int count = min(opt.batch, opt.messages - sent);
+                    const string& frame = opt.batch == 1 ? request : count == opt.batch ? full_batch : last_batch;
+                    if (!conn.sendLine(frame)) { ++failures; return; }
+                    sent += count;
+                }
+
+                if (!conn.readLine(line)) { ++failures; return; }
+                if (isType(line, "BATCH_OK"))
+                {
+                    // Antes de "OK": as respostas de dentro também casariam
+                    for (const json& response : Protocol::parseBatchResponses(json::parse(line)))
+                    {
+                        if (response.value("type", "") != "OK") ++failures;
+                        ++acked;
+                    }
+                }
+                else if (isType(line, "OK")) ++acked;
+                else if (isType(line, "DELIVER_MSG")) ++delivered;
+                else { ++failures; ++acked; }
+            }
+        });
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    long total = static_cast<long>(opt.clients) * opt.messages;
+
+    cout << "Clientes:            " << opt.clients << endl;
+    cout << "Mensagens roteadas:  " << total << endl;
+    cout << "Requisições/frame:   " << opt.batch << endl;
+    cout << "Falhas:              " << failures << endl;
+    cout << "Tempo:               " << elapsed << " s" << endl;
+    cout << "Mensagens/s:         " << static_cast<long>(total / elapsed) << endl;
+
+    if (opt.serverPid > 0)
+    {
+        double cpu = processCpuSeconds(opt.serverPid) - cpu_before;
+        cout << "CPU do servidor:     " << cpu << " s" << endl;
+        if (cpu > 0)
+            cout << "Mensagens/s de CPU:  " << static_cast<long>(total / cpu) << endl;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+/**
+ * Benchmark do parser de requisições
+ * ----------------------------------
+ * Compara, sobre um conjunto de frames típicos das seis requisições do
+ * protocolo, o caminho antigo (json::parse + Protocol::parseNickname &cia.
+ * sobre o DOM) com o parser especializado (Protocol::parseRequest). Mostra
+ * o tempo por requisição e as alocações por requisição (operator new
+ * contado neste binário).
+ *
+ * Uso: bench_parse [--iterations N]
+ */
+
+#include "protocol.hpp"
+#include "request_parser.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace std;
+using json = nlohmann::json;
+
+namespace
+{
+
+atomic<uint64_t> allocationCount{0};
+
+struct Sample
+{
+    const char* name;
+    string frame;
+};
+
+vector<Sample> buildSamples()
+{
+    string text(120, 'x');
+    return {
+        {"REGISTER", R"({"payload":{"fullname":"Maria da Silva","nickname":"maria_s"},"type":"REGISTER"})"},
+        {"LOGIN", R"({"payload":{"nickname":"maria_s"},"type":"LOGIN"})"},
+        {"SEND_MSG", R"({"payload":{"text":")" + text + R"(","to":"joao_p"},"type":"SEND_MSG"})"},
+        {"SEND_MSG utf8", R"({"payload":{"text":"Olá, João! Já são três horas; até já.","to":"joao_p"},"type":"SEND_MSG"})"},
+        {"LIST_USERS", R"({"payload":{},"type":"LIST_USERS"})"},
+        {"LOGOUT", R"({"payload":{},"type":"LOGOUT"})"},
+        {"DELETE_USER", R"({"payload":{"nickname":"maria_s"},"type":"DELETE_USER"})"},
+    };
+}
+
+/**
+ * Caminho antigo: DOM completo e strings copiadas do payload
+ */
+size_t parseWithDom(const string& frame)
+{
+    json request = json::parse(frame);
+    size_t bytes = 0;
+    switch (Protocol::parseMessageType(request))
+    {
+        case Protocol::MessageType::REGISTER:
+            bytes += Protocol::parseNickname(request).size() + Protocol::parseFullName(request).size();
+            break;
+        case Protocol::MessageType::LOGIN:
+        case Protocol::MessageType::DELETE_USER:
+            bytes += Protocol::parseNickname(request).size();
+            break;
+        case Protocol::MessageType::SEND_MSG:
+            bytes += Protocol::parseRecipient(request).size() + Protocol::parseMessageText(request).size();
+            break;
+        default:
+            break;
+    }
+    return bytes;
+}
+
+/**
+ * Parser especializado: views para dentro do frame
+ */
+size_t parseWithViews(const string& frame)
+{
+    Protocol::Request request = Protocol::parseRequest(frame);
+    size_t bytes = 0;
+    switch (request.type)
+    {
+        case Protocol::MessageType::REGISTER:
+            bytes += Protocol::parseNickname(request).size() + Protocol::parseFullName(request).size();
+            break;
+        case Protocol::MessageType::LOGIN:
+        case Protocol::MessageType::DELETE_USER:
+            bytes += Protocol::parseNickname(request).size();
+            break;
+        case Protocol::MessageType::SEND_MSG:
+            bytes += Protocol::parseRecipient(request).size() + Protocol::parseMessageText(request).size();
+            break;
+        default:
+            break;
+    }
+    return bytes;
+}
+
+struct Result
+{
+    double nsPerOp;
+    double allocsPerOp;
+};
+
+template <typename Parser>
+Result measure(const string& frame, int iterations, Parser parser)
+{
+    volatile size_t sink = 0;
+    uint64_t allocs_before = allocationCount.load(memory_order_relaxed);
+    auto start = chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i)
+        sink = sink + parser(frame);
+
+    auto elapsed = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    uint64_t allocs = allocationCount.load(memory_order_relaxed) - allocs_before;
+    return {elapsed / iterations, static_cast<double>(allocs) / iterations};
+}
+
+} // namespace
+
+// Conta as alocações do processo. noinline: inlinados, o GCC pareia o
+// malloc/free de dentro deles com os new/delete de fora (-Wmismatched-new-delete)
+__attribute__((noinline)) void* operator new(size_t size)
+{
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* ptr = malloc(size ? size : 1))
+        return ptr;
+    throw bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* ptr) noexcept { free(ptr); }
+__attribute__((noinline)) void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+int main(int argc, char* argv[])
+{
+    int iterations = 200000;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) iterations = stoi(argv[++i]);
+    }
+
+    vector<Sample> samples = buildSamples();
+
+    // Os dois caminhos precisam concordar antes de medir
+    for (const Sample& sample : samples)
+    {
+        Protocol::Request request;
+        if (!Protocol::parseRequestFast(sample.frame, request) ||
+            parseWithDom(sample.frame) != parseWithViews(sample.frame))
+        {
+            cerr << "Divergência no frame " << sample.name << endl;
+            return 1;
+        }
+    }
+
+    cout << left << setw(18) << "Requisição"
+         << right << setw(14) << "json ns/op" << setw(14) << "aloc/op"
+         << setw(14) << "views ns/op" << setw(14) << "aloc/op" << setw(10) << "ganho" << endl;
+
+    double total_dom = 0, total_views = 0;
+    for (const Sample& sample : samples)
+    {
+        Result dom = measure(sample.frame, iterations, parseWithDom);
+        Result views = measure(sample.frame, iterations, parseWithViews);
+        total_dom += dom.nsPerOp;
+        total_views += views.nsPerOp;
+
+        cout << left << setw(16) << sample.name << right << fixed << setprecision(1)
+             << setw(14) << dom.nsPerOp << setw(14) << dom.allocsPerOp
+             << setw(14) << views.nsPerOp << setw(14) << views.allocsPerOp
+             << setw(9) << dom.nsPerOp / views.nsPerOp << "x" << endl;
+    }
+
+    cout << left << setw(17) << "Média" << right << fixed << setprecision(1)
+         << setw(14) << total_dom / samples.size() << setw(14) << ""
+         << setw(14) << total_views / samples.size() << setw(14) << ""
+         << setw(9) << total_dom / total_views << "x" << endl;
+    return 0;
+}
@@ -0,0 +1,197 @@
+/**
+ * Benchmark dos validadores de texto
+ * ----------------------------------
+ * Confere e mede os núcleos de TextValidation que a CPU executa (escalar,
+ * SSSE3, AVX2):
+ *
+ *   - correção: casos fixos de UTF-8 inválido (formas longas, surrogates,
+ *     acima de U+10FFFF, sequência cortada, inclusive na fronteira dos
+ *     blocos de 16/32 bytes) e mutações aleatórias de textos válidos; cada
+ *     núcleo tem de concordar com o escalar em todos
+ *   - desempenho: ns por chamada e GB/s para textos ASCII, português,
+ *     CJK e emoji de 4 KiB (o limite do SEND_MSG), um texto curto e um
+ *     apelido
+ *
+ * Uso: bench_validation [--iterations N]
+ */
+
+#include "text_validation.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+
+/**
+ * Repete 'piece' até 'size' bytes sem cortar caractere
+ */
+string repeat(const string& piece, size_t size)
+{
+    string text;
+    while (text.size() + piece.size() <= size)
+        text += piece;
+    return text;
+}
+
+struct Case
+{
+    string text;
+    bool valid;
+};
+
+vector<Case> fixedCases()
+{
+    vector<Case> cases = {
+        {"", true},
+        {"abc", true},
+        {"Olá, João", true},
+        {"\xE2\x82\xAC", true},                 // €
+        {"\xF0\x9F\x98\x80", true},             // 😀
+        {"\xF4\x8F\xBF\xBF", true},             // U+10FFFF
+        {"\xED\x9F\xBF", true},                 // U+D7FF
+        {"\xC0\xAF", false},                    // Forma longa de '/'
+        {"\xC1\xBF", false},
+        {"\xE0\x80\xAF", false},
+        {"\xE0\x9F\xBF", false},
+        {"\xF0\x80\x80\xAF", false},
+        {"\xF0\x8F\xBF\xBF", false},
+        {"\xED\xA0\x80", false},                // Surrogate
+        {"\xED\xBF\xBF", false},
+        {"\xF4\x90\x80\x80", false},            // Acima de U+10FFFF
+        {"\xF5\x80\x80\x80", false},
+        {"\xFF", false},
+        {"\x80", false},                        // Continuação solta
+        {"a\xBF", false},
+        {"\xC3", false},                        // Cortadas no fim
+        {"\xE2\x82", false},
+        {"\xF0\x9F\x98", false},
+        {"\xC3(", false},
+        {"\xE2(\xAC", false},
+        {"\xF0\x9F\x98\x80\x80", false},        // Continuação a mais
+    };
+
+    // Os mesmos casos em cada posição em volta das fronteiras de bloco
+    vector<Case> shifted;
+    for (const Case& c : cases)
+        for (size_t pad : {13u, 14u, 15u, 16u, 29u, 30u, 31u, 32u, 61u, 63u, 64u})
+        {
+            shifted.push_back({string(pad, 'x') + c.text, c.valid});
+            shifted.push_back({string(pad, 'x') + c.text + "yz", c.valid});
+        }
+    cases.insert(cases.end(), shifted.begin(), shifted.end());
+    return cases;
+}
+
+/**
+ * Compara cada núcleo com o escalar
+ */
+bool checkKernels(const vector<TextValidation::Kernel>& kernels)
+{
+    const TextValidation::Kernel& reference = kernels.front();
+    bool ok = true;
+    auto expect = [&](const string& text, bool utf8, bool nickname)
+    {
+        for (const auto& kernel : kernels)
+        {
+            if (kernel.utf8(text) != utf8 || kernel.nickname(text) != nickname)
+            {
+                cerr << "Divergência (" << kernel.name << ") em " << text.size() << " bytes: utf8 esperado "
+                     << utf8 << ", apelido esperado " << nickname << endl;
+                ok = false;
+            }
+        }
+    };
+
+    for (const Case& c : fixedCases())
+    {
+        if (reference.utf8(c.text) != c.valid)
+        {
+            cerr << "Escalar errado num caso fixo de " << c.text.size() << " bytes" << endl;
+            ok = false;
+        }
+        expect(c.text, c.valid, reference.nickname(c.text));
+    }
+
+    // Mutações de um byte em textos válidos de vários tamanhos
+    const string bases[] = {repeat("Olá 😀 日本 ação_x9Z ", 300), repeat("maria_Silva_99", 300)};
+    uint32_t seed = 7;
+    auto next = [&]() { seed = seed * 1103515245 + 12345; return seed >> 8; };
+    for (int round = 0; round < 200000; ++round)
+    {
+        string text = bases[round % 2].substr(next() % 64, next() % 200);
+        if (!text.empty() && next() % 4)
+            text[next() % text.size()] = static_cast<char>(next());
+        expect(text, reference.utf8(text), reference.nickname(text));
+    }
+    return ok;
+}
+
+struct Workload
+{
+    const char* name;
+    string text;
+    bool nickname;  // Mede o núcleo do apelido (senão o de UTF-8)
+};
+
+template <typename Fn>
+double measure(int iterations, Fn fn)
+{
+    volatile bool sink = false;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        sink = fn();
+    (void)sink;
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int iterations = 200000;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) iterations = stoi(argv[++i]);
+    }
+
+    vector<TextValidation::Kernel> kernels = TextValidation::availableKernels();
+    cout << "Núcleo ativo: " << TextValidation::activeKernel().name << endl;
+    if (!checkKernels(kernels))
+        return 1;
+    cout << "Núcleos conferidos contra o escalar" << endl << endl;
+
+    const Workload workloads[] = {
+        {"ASCII 4K", repeat("mensagem de teste em ascii puro, ", 4096), false},
+        {"pt-BR 4K", repeat("Olá, você já viu a reunião de amanhã às três? ", 4096), false},
+        {"CJK 4K", repeat("日本語のテキストです", 4096), false},
+        {"emoji 4K", repeat("😀🎉🚀", 4096), false},
+        {"texto 120B", repeat("Já são três horas; até já! ", 120), false},
+        {"apelido", "maria_silva_99", true},
+        {"apelido 32B", "maria_silva_99_maria_silva_99_ab", true},
+    };
+
+    cout << left << setw(16) << "Carga" << setw(10) << "SIMD"
+         << right << setw(12) << "ns/chamada" << setw(10) << "GB/s" << endl;
+
+    for (const Workload& workload : workloads)
+    {
+        for (const auto& kernel : kernels)
+        {
+            auto validate = workload.nickname ? kernel.nickname : kernel.utf8;
+            string_view text = workload.text;
+            double ns = measure(iterations, [&]() { return validate(text); });
+
+            cout << left << setw(16) << workload.name << setw(10) << kernel.name << right << fixed
+                 << setw(12) << setprecision(1) << ns << setw(10) << setprecision(2)
+                 << workload.text.size() / ns << endl;
+        }
+        cout << endl;
+    }
+    return 0;
+}
@@ -1,9 +1,11 @@
 #include "client.hpp"
-#include "socket_utils.hpp"
+#include "protocol.hpp"
 #include <arpa/inet.h>
+#include <cerrno>
 #include <cstring>
 #include <iostream>
 #include <netinet/in.h>
+#include <poll.h>
 #include <stdexcept>
 #include <sys/socket.h>
 #include <unistd.h>
@@ -11,7 +13,8 @@
 using namespace std;
 
 Client::Client()
-    : sockfd(-1), connected(false), receiving(false) {}
+    : sockfd(-1), connected(false), receiving(false), sendFraming(SocketUtils::Framing::LINE),
+      sendEncoding(SocketUtils::Encoding::JSON), receiveEncoding(SocketUtils::Encoding::JSON) {}
 
 Client::~Client()
 {
@@ -67,11 +70,82 @@ bool Client::connectToServer(const string& host, int port)
         return false;
     }
 
+    // Buffers, framing e codificação de uma conexão anterior
+    receiveBuffer.clear();
+    receiveBuffer.setFraming(SocketUtils::Framing::LINE);
+    receiveEncoding = SocketUtils::Encoding::JSON;
+    sendRing.clear();
+    sendFraming = SocketUtils::Framing::LINE;
+    sendEncoding = SocketUtils::Encoding::JSON;
+    sendDeflater.reset();
+    receiveBuffer.setCompression(SocketUtils::Compression::NONE);
+
     connected = true;
     cout << "[Client] Conectado ao servidor!" << endl;
     return true;
 }
 
+bool Client::negotiateFraming(SocketUtils::Framing framing, SocketUtils::Encoding encoding,
+                              SocketUtils::Compression compression)
+{
+    // Binário pode conter '\n': só com prefixo de tamanho
+    if (encoding != SocketUtils::Encoding::JSON || compression != SocketUtils::Compression::NONE)
+        framing = SocketUtils::Framing::LENGTH;
+
+    if (framing == SocketUtils::Framing::LINE)
+        return true;
+
+    // O HELLO e o HELLO_OK trafegam em linha, em JSON e sem compressão
+    if (!sendJson(Protocol::buildHelloRequest(SocketUtils::framingName(framing),
+                                              SocketUtils::encodingName(encoding),
+                                              SocketUtils::compressionName(compression)).dump()))
+        return false;
+
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(HELLO_TIMEOUT_MS);
+    while (connected && chrono::steady_clock::now() < deadline)
+    {
+        auto reply = receiveJson();
+        if (!reply)
+        {
+            pollfd pfd{sockfd, POLLIN, 0};
+            poll(&pfd, 1, 50);
+            continue;
+        }
+
+        auto response = nlohmann::json::parse(*reply, nullptr, false);
+        bool accepted = !response.is_discarded() &&
+                        Protocol::peekMessageType(*reply) == Protocol::MessageType::HELLO_OK &&
+                        response.value("/payload/framing"_json_pointer, "") ==
+                            SocketUtils::framingName(framing) &&
+                        response.value("/payload/encoding"_json_pointer, "json") ==
+                            SocketUtils::encodingName(encoding) &&
+                        response.value("/payload/compression"_json_pointer, "none") ==
+                            SocketUtils::compressionName(compression);
+        if (!accepted)
+        {
+            cerr << "[Client] Servidor recusou o framing: " << *reply << endl;
+            return false;
+        }
+
+        {
+            lock_guard<mutex> lock(sendMutex);
+            sendFraming = framing;
+            sendEncoding = encoding;
+            if (compression != SocketUtils::Compression::NONE)
+                sendDeflater = make_unique<DeflateStream>();
+        }
+        receiveBuffer.setFraming(framing);
+        receiveBuffer.setCompression(compression);
+        receiveEncoding = encoding;
+        cout << "[Client] Framing negociado: " << SocketUtils::framingName(framing) << ", "
+             << SocketUtils::encodingName(encoding) << ", " << SocketUtils::compressionName(compression) << endl;
+        return true;
+    }
+
+    cerr << "[Client] Servidor não respondeu ao HELLO" << endl;
+    return false;
+}
+
 bool Client::sendJson(const string& json)
 {
     if (!connected)
@@ -80,13 +154,125 @@ bool Client::sendJson(const string& json)
         return false;
     }
 
-    return SocketUtils::sendMessage(sockfd, json);
+    lock_guard<mutex> lock(sendMutex);
+
+    if (!sendRing.allocated() && !sendRing.allocate(SocketUtils::MAX_FRAME_SIZE))
+        return false;
+
+    if (sendFraming == SocketUtils::Framing::LENGTH)
+    {
+        // O tipo do cabeçalho sai do JSON; o payload vai na codificação negociada
+        string binary;
+        string_view payload = json;
+        if (sendEncoding != SocketUtils::Encoding::JSON)
+        {
+            try
+            {
+                payload = binary = Protocol::toWire(json, sendEncoding);
+            }
+            catch (const nlohmann::json::exception& e)
+            {
+                cerr << "[Client] Mensagem não é JSON válido: " << e.what() << endl;
+                return false;
+            }
+        }
+
+        auto type = static_cast<uint8_t>(Protocol::peekMessageType(json));
+
+        // Como no servidor: mensagens pequenas (ou falha do zlib) seguem cruas
+        string compressed;
+        if (sendDeflater && payload.size() >= SocketUtils::MIN_COMPRESSED_SIZE &&
+            sendDeflater->compress(payload, compressed))
+        {
+            payload = compressed;
+            type |= SocketUtils::COMPRESSED_FRAME_FLAG;
+        }
+
+        if (SocketUtils::FRAME_HEADER_SIZE + payload.size() > sendRing.writable())
+        {
+            cerr << "[Client] Mensagem muito longa para envio" << endl;
+            return false;
+        }
+
+        char header[SocketUtils::FRAME_HEADER_SIZE];
+        SocketUtils::writeFrameHeader(header, payload.size(), type);
+        sendRing.write(header, sizeof(header));
+        sendRing.write(payload.data(), payload.size());
+        return flushSendRing();
+    }
+
+    if (json.size() + 1 > sendRing.writable())
+    {
+        cerr << "[Client] Mensagem muito longa para envio" << endl;
+        return false;
+    }
+
+    sendRing.write(json.data(), json.size());
+    sendRing.write("\n", 1);
+    return flushSendRing();
+}
+
+bool Client::sendBatch(const vector<nlohmann::json>& requests)
+{
+    if (requests.size() > Protocol::MAX_BATCH_SIZE)
+    {
+        cerr << "[Client] BATCH com mais de " << Protocol::MAX_BATCH_SIZE << " requisições" << endl;
+        return false;
+    }
+    return sendJson(Protocol::buildBatchRequest(requests).dump());
+}
+
+bool Client::flushSendRing()
+{
+    while (sendRing.readable() > 0)
+    {
+        ssize_t sent = send(sockfd, sendRing.readPtr(), sendRing.readable(), MSG_NOSIGNAL);
+
+        if (sent > 0)
+        {
+            sendRing.consume(static_cast<size_t>(sent));
+            continue;
+        }
+
+        if (sent < 0 && errno == EINTR)
+            continue;
+
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            // Socket não-bloqueante (por causa da thread receptora): espera espaço
+            pollfd pfd{sockfd, POLLOUT, 0};
+            if (poll(&pfd, 1, SEND_TIMEOUT_MS) > 0)
+                continue;
+            cerr << "[Client] Tempo esgotado ao enviar" << endl;
+        }
+        else
+            cerr << "[Client] Erro ao enviar: " << strerror(errno) << endl;
+
+        sendRing.clear();
+        return false;
+    }
+
+    return true;
 }
 
 optional<string> Client::receiveJson()
 {
     if (!connected) return nullopt;
-    return SocketUtils::receiveMessage(sockfd, receiveBuffer);
+    auto frame = SocketUtils::receiveMessage(sockfd, receiveBuffer);
+    if (!frame) return nullopt;
+    if (receiveEncoding == SocketUtils::Encoding::JSON)
+        return string(*frame);
+
+    try
+    {
+        return Protocol::parseWire(*frame, receiveEncoding).dump();
+    }
+    catch (const nlohmann::json::exception& e)
+    {
+        cerr << "[Client] Frame " << SocketUtils::encodingName(receiveEncoding)
+             << " inválido: " << e.what() << endl;
+        return nullopt;
+    }
 }
 
 void Client::disconnect()
@@ -125,7 +311,22 @@ void Client::receiverLoop()
     {
         auto msg = receiveJson();
         
-        if (msg)
+        if (msg && Protocol::peekMessageType(*msg) == Protocol::MessageType::BATCH_OK)
+        {
+            // Desempacota o BATCH_OK: quem lê a fila vê as respostas avulsas
+            try
+            {
+                vector<nlohmann::json> responses = Protocol::parseBatchResponses(nlohmann::json::parse(*msg));
+                lock_guard<mutex> lock(queueMutex);
+                for (const auto& response : responses)
+                    messageQueue.push(response.dump());
+            }
+            catch (const exception& e)
+            {
+                cerr << "[Client] BATCH_OK inválido: " << e.what() << endl;
+            }
+        }
+        else if (msg)
         {
             lock_guard<mutex> lock(queueMutex);
             messageQueue.push(*msg);
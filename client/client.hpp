@@ -1,11 +1,18 @@
 #pragma once
 
+#include "compression.hpp"
+#include "frame_reader.hpp"
+#include "ring_buffer.hpp"
+#include "socket_utils.hpp"
 #include <atomic>
+#include <memory>
 #include <mutex>
+#include <nlohmann/json.hpp>
 #include <optional>
 #include <queue>
 #include <string>
 #include <thread>
+#include <vector>
 
 /**
  * Classe Client
@@ -28,15 +35,40 @@ public:
     bool connectToServer(const std::string& host, int port);
 
     /**
-     * Envia uma string JSON para o servidor
-     * @param json String contendo a mensagem JSON (será adicionado delimitador se necessário)
+     * Negocia framing, codificação e compressão da conexão com um HELLO
+     * (antes de qualquer outro comando e da thread receptora). LINE + JSON
+     * sem compressão não precisa de negociação; as codificações binárias e
+     * a compressão implicam LENGTH.
+     * @param framing Framing desejado
+     * @param encoding Codificação desejada
+     * @param compression Compressão desejada
+     * @return true se o servidor confirmou os três com HELLO_OK
+     */
+    bool negotiateFraming(SocketUtils::Framing framing,
+                          SocketUtils::Encoding encoding = SocketUtils::Encoding::JSON,
+                          SocketUtils::Compression compression = SocketUtils::Compression::NONE);
+
+    /**
+     * Envia uma string JSON para o servidor (convertida para a codificação
+     * negociada, se binária)
+     * @param json String contendo a mensagem JSON (recebe o '\n' ou o cabeçalho do framing)
      * @return true se o envio ocorrer sem erros, false caso contrário
      */
     bool sendJson(const std::string& json);
 
+    /**
+     * Envia várias requisições num único frame BATCH (no máximo
+     * Protocol::MAX_BATCH_SIZE). As respostas do BATCH_OK entram na fila de
+     * recebidas uma a uma, na ordem das requisições.
+     * @param requests Documentos dos builders de Protocol
+     * @return true se o envio ocorrer sem erros, false caso contrário
+     */
+    bool sendBatch(const std::vector<nlohmann::json>& requests);
+
     /**
      * Recebe uma mensagem JSON do servidor (operação não-bloqueante).
-     * Utiliza buffer interno para reconstruir a mensagem completa.
+     * Utiliza buffer interno para reconstruir a mensagem completa; frames
+     * MessagePack/CBOR voltam como texto JSON.
      * @return std::optional contendo a mensagem ou nullopt se não houver dados completos
      */
     std::optional<std::string> receiveJson();
@@ -69,15 +101,33 @@ public:
     bool isConnected() const { return connected; }
 
 private:
+    static constexpr int SEND_TIMEOUT_MS = 5000;
+    static constexpr int HELLO_TIMEOUT_MS = 2000;
+
     int sockfd;
     std::atomic<bool> connected;
     std::atomic<bool> receiving;
     std::thread receiverThread;
 
     /**
-     * Buffer interno para acumular dados parciais em receiveJson()
+     * Anel de envio: o frame (JSON + '\n' ou cabeçalho + JSON) é montado
+     * direto nele e enviado a partir dele, sem a cópia da concatenação
      */
-    std::string receiveBuffer;
+    RingBuffer sendRing;
+    std::mutex sendMutex;
+    SocketUtils::Framing sendFraming;
+    SocketUtils::Encoding sendEncoding;
+    std::unique_ptr<DeflateStream> sendDeflater;    // Só com compressão negociada
+
+    /**
+     * Codificação dos frames recebidos (só a thread de leitura usa)
+     */
+    SocketUtils::Encoding receiveEncoding;
+
+    /**
+     * Buffer de leitura: acumula dados parciais entre chamadas de receiveJson()
+     */
+    FrameReader receiveBuffer;
 
     /**
      * Mutex para proteção de acesso concorrente à fila de mensagens
@@ -94,4 +144,10 @@ private:
      * Mantém um loop de leitura do socket enquanto conectado.
      */
     void receiverLoop();
+
+    /**
+     * Envia o conteúdo do anel de envio, aguardando espaço no socket
+     * (não-bloqueante) até SEND_TIMEOUT_MS.
+     */
+    bool flushSendRing();
 };
\ No newline at end of file
@@ -42,8 +42,9 @@ Comandos disponíveis:
   list
       → Lista todos os usuários e seus status.
 
-  msg <destinatário> <texto...>
-      → Envia uma mensagem privada.
+  msg <destinatário>[,<destinatário>...] <texto...>
+      → Envia uma mensagem privada (vários destinatários
+        vão num único BATCH).
 
   logout
       → Faz logout da sessão atual.
@@ -108,7 +109,7 @@ Command Interface::parse(const string& line)
         cmd.type = CommandType::List;
     else if (name_cmd == "msg")
         if (parts.size() < 3)
-            error("Uso: msg <apelido_dest> <mensagem>");
+            error("Uso: msg <apelido_dest>[,<apelido_dest>...] <mensagem>");
         else
         {
             cmd.type = CommandType::Msg;
@@ -182,18 +183,26 @@ void Interface::displayMessage(const json& msg)
     }
 }
 
-void Interface::run(Client& client)
+void Interface::run(Client& client, const string& host, int port, SocketUtils::Framing framing,
+                    SocketUtils::Encoding encoding, SocketUtils::Compression compression)
 {
     cout << "\nBem-vindo ao Mensageiro Rudimentar!" << endl;
     cout << "Digite 'help' para ver os comandos disponíveis.\n" << endl;
 
     // Conecta ao servidor
-    if (!client.connectToServer("127.0.0.1", 12345))
+    if (!client.connectToServer(host, port))
     {
         error("Falha ao conectar ao servidor.");
         return;
     }
 
+    if (!client.negotiateFraming(framing, encoding, compression))
+    {
+        error("Falha ao negociar o framing.");
+        client.disconnect();
+        return;
+    }
+
     // Inicia thread de recepção de rede (Socket -> Queue)
     client.startReceiverThread();
 
@@ -278,8 +287,24 @@ void Interface::run(Client& client)
                     request = Protocol::buildListUsersRequest();
                     break;
                 case CommandType::Msg:
+                {
+                    // "a,b,c": um SEND_MSG por destinatário, no mesmo frame
+                    vector<json> messages;
+                    stringstream recipients(cmd.args[0]);
+                    string to;
+                    while (getline(recipients, to, ','))
+                        if (!to.empty())
+                            messages.push_back(Protocol::buildSendMessageRequest(to, cmd.args[1]));
+
+                    if (messages.size() > 1)
+                    {
+                        if (!client.sendBatch(messages))
+                            error("Falha ao enviar mensagem ao servidor.");
+                        continue;
+                    }
                     request = Protocol::buildSendMessageRequest(cmd.args[0], cmd.args[1]);
                     break;
+                }
                 case CommandType::Logout:
                     request = Protocol::buildLogoutRequest();
                     break;
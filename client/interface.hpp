@@ -45,8 +45,16 @@ public:
      * Conecta ao servidor, inicia thread receptora e processa comandos do usuário.
      * 
      * @param client Referência para o objeto Client
+     * @param host Endereço IP do servidor
+     * @param port Porta do servidor
+     * @param framing Framing a negociar logo após conectar
+     * @param encoding Codificação a negociar junto com o framing
+     * @param compression Compressão a negociar junto com o framing
      */
-    void run(Client& client);
+    void run(Client& client, const std::string& host, int port,
+             SocketUtils::Framing framing = SocketUtils::Framing::LINE,
+             SocketUtils::Encoding encoding = SocketUtils::Encoding::JSON,
+             SocketUtils::Compression compression = SocketUtils::Compression::NONE);
     
     /**
      * Exibe mensagem de ajuda com todos os comandos disponíveis
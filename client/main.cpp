@@ -12,16 +12,63 @@ int main(int argc, char* argv[])
         std::string host = "127.0.0.1";
         int port = DEFAULT_PORT;
         
-        // Argumentos: ./client [host] [porta]
-        if (argc > 1) host = argv[1];
-        if (argc > 2) port = std::stoi(argv[2]);
+        SocketUtils::Framing framing = SocketUtils::Framing::LINE;
+        SocketUtils::Encoding encoding = SocketUtils::Encoding::JSON;
+        SocketUtils::Compression compression = SocketUtils::Compression::NONE;
+
+        // Argumentos: ./client [host] [porta] [--framing line|length] [--encoding json|msgpack|cbor|compact]
+        //             [--compression none|deflate]
+        int positional = 0;
+        for (int i = 1; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--framing") == 0 && i + 1 < argc)
+            {
+                auto parsed = SocketUtils::parseFraming(argv[++i]);
+                if (!parsed)
+                {
+                    std::cerr << "Framing inválido: " << argv[i] << " (use line ou length)" << std::endl;
+                    return 1;
+                }
+                framing = *parsed;
+            }
+            else if (std::strcmp(argv[i], "--encoding") == 0 && i + 1 < argc)
+            {
+                auto parsed = SocketUtils::parseEncoding(argv[++i]);
+                if (!parsed)
+                {
+                    std::cerr << "Codificação inválida: " << argv[i] << " (use json, msgpack, cbor ou compact)" << std::endl;
+                    return 1;
+                }
+                encoding = *parsed;
+            }
+            else if (std::strcmp(argv[i], "--compression") == 0 && i + 1 < argc)
+            {
+                auto parsed = SocketUtils::parseCompression(argv[++i]);
+                if (!parsed)
+                {
+                    std::cerr << "Compressão inválida: " << argv[i] << " (use none ou deflate)" << std::endl;
+                    return 1;
+                }
+                compression = *parsed;
+            }
+            else if (positional == 0)
+            {
+                host = argv[i];
+                ++positional;
+            }
+            else if (positional == 1)
+            {
+                port = std::stoi(argv[i]);
+                ++positional;
+            }
+        }
         
         std::cout << "Iniciando CLIENTE" << std::endl;
         std::cout << "Conectando em " << host << ":" << port << std::endl;
         
         Client client;
         Interface interface;
-        interface.run(client);
+        interface.run(client, host, port, framing, encoding, compression);
     }
     catch (const std::exception& e)
     {
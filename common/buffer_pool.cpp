@@ -0,0 +1,281 @@
+#include "buffer_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace
+{
+    // Bytes movidos por vez entre a cache da thread e a reserva (e tamanho do slab)
+    constexpr size_t BATCH_BYTES = 128 * 1024;
+
+    struct Block
+    {
+        Block* next;
+    };
+
+    struct FreeList
+    {
+        Block* head = nullptr;
+        size_t count = 0;
+
+        void push(Block* block)
+        {
+            block->next = head;
+            head = block;
+            ++count;
+        }
+
+        Block* pop()
+        {
+            Block* block = head;
+            head = block->next;
+            --count;
+            return block;
+        }
+    };
+
+    /**
+     * Cache de uma thread. Os contadores só são escritos pela dona; são
+     * atômicos para que stats() possa lê-los de outra thread.
+     */
+    struct ThreadCache
+    {
+        FreeList lists[BufferPool::CLASSES];
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> localHits{0};
+        std::atomic<int64_t> inUse{0};      // Pode ficar negativo: blocos de outras threads
+    };
+
+    /**
+     * Reserva global: blocos devolvidos pelas caches e contadores das
+     * threads que já terminaram
+     */
+    struct Depot
+    {
+        std::mutex mutex;
+        FreeList lists[BufferPool::CLASSES];
+        std::vector<ThreadCache*> caches;
+        uint64_t retiredAllocations = 0;
+        uint64_t retiredHits = 0;
+        int64_t retiredInUse = 0;
+        std::atomic<uint64_t> refills{0};
+        std::atomic<uint64_t> slabs{0};
+        std::atomic<uint64_t> oversized{0};
+        std::atomic<uint64_t> bytesReserved{0};
+    };
+
+    // Nunca destruída: caches de threads (e objetos estáticos) podem liberar blocos até o fim
+    Depot& depot()
+    {
+        static Depot* instance = new Depot;
+        return *instance;
+    }
+
+    size_t classOf(size_t bytes)
+    {
+        if (bytes <= BufferPool::MIN_BLOCK)
+            return 0;
+        // ceil(log2(bytes)) - log2(MIN_BLOCK)
+        return static_cast<size_t>(64 - __builtin_clzll(bytes - 1)) - 6;
+    }
+
+    size_t blockSize(size_t cls) { return BufferPool::MIN_BLOCK << cls; }
+
+    size_t batchSize(size_t cls) { return std::max<size_t>(2, BATCH_BYTES / blockSize(cls)); }
+
+    // A cache guarda até dois lotes: libera metade ao passar disso
+    size_t localLimit(size_t cls) { return 2 * batchSize(cls); }
+
+    /**
+     * Move até 'batch' blocos da reserva para 'list'; com a reserva vazia,
+     * fatia um slab novo.
+     */
+    void refill(FreeList& list, size_t cls)
+    {
+        Depot& global = depot();
+        size_t batch = batchSize(cls);
+        {
+            std::lock_guard<std::mutex> lock(global.mutex);
+            FreeList& source = global.lists[cls];
+            while (source.count > 0 && list.count < batch)
+                list.push(source.pop());
+        }
+        global.refills.fetch_add(1, std::memory_order_relaxed);
+
+        if (list.count > 0)
+            return;
+
+        size_t block = blockSize(cls);
+        char* slab = static_cast<char*>(::operator new(batch * block));
+        for (size_t i = batch; i-- > 0;)
+            list.push(reinterpret_cast<Block*>(slab + i * block));
+
+        global.slabs.fetch_add(1, std::memory_order_relaxed);
+        global.bytesReserved.fetch_add(batch * block, std::memory_order_relaxed);
+    }
+
+    /**
+     * Devolve à reserva os blocos de 'list' acima de 'keep'
+     */
+    void spill(FreeList& list, size_t cls, size_t keep)
+    {
+        Depot& global = depot();
+        std::lock_guard<std::mutex> lock(global.mutex);
+        while (list.count > keep)
+            global.lists[cls].push(list.pop());
+    }
+
+    /**
+     * Registra a cache da thread na criação e a esvazia na saída da thread
+     * (modo threads: uma thread por cliente)
+     */
+    class CacheOwner
+    {
+    public:
+        CacheOwner();
+        ~CacheOwner();
+
+        ThreadCache cache;
+    };
+
+    thread_local ThreadCache* currentCache = nullptr;
+    thread_local bool cacheRetired = false;
+
+    CacheOwner::CacheOwner()
+    {
+        Depot& global = depot();
+        std::lock_guard<std::mutex> lock(global.mutex);
+        global.caches.push_back(&cache);
+        currentCache = &cache;
+    }
+
+    CacheOwner::~CacheOwner()
+    {
+        currentCache = nullptr;
+        cacheRetired = true;
+
+        for (size_t cls = 0; cls < BufferPool::CLASSES; ++cls)
+            spill(cache.lists[cls], cls, 0);
+
+        Depot& global = depot();
+        std::lock_guard<std::mutex> lock(global.mutex);
+        global.retiredAllocations += cache.allocations.load(std::memory_order_relaxed);
+        global.retiredHits += cache.localHits.load(std::memory_order_relaxed);
+        global.retiredInUse += cache.inUse.load(std::memory_order_relaxed);
+        global.caches.erase(std::find(global.caches.begin(), global.caches.end(), &cache));
+    }
+
+    // nullptr depois que a cache da thread foi destruída
+    ThreadCache* localCache()
+    {
+        if (currentCache || cacheRetired)
+            return currentCache;
+
+        thread_local CacheOwner owner;
+        return currentCache;
+    }
+
+    // Incremento de contador escrito por uma única thread (sem lock de barramento)
+    template <typename T>
+    void bump(std::atomic<T>& counter, T delta)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+}
+
+// ==================== ALOCAÇÃO ====================
+
+void* BufferPool::allocate(size_t bytes)
+{
+    if (bytes > MAX_BLOCK)
+    {
+        depot().oversized.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(bytes);
+    }
+
+    size_t cls = classOf(bytes);
+    ThreadCache* cache = localCache();
+
+    // Thread encerrando: trabalha direto com a reserva
+    if (!cache)
+    {
+        FreeList list;
+        refill(list, cls);
+        Block* block = list.pop();
+        spill(list, cls, 0);
+
+        Depot& global = depot();
+        std::lock_guard<std::mutex> lock(global.mutex);
+        ++global.retiredAllocations;
+        ++global.retiredInUse;
+        return block;
+    }
+
+    FreeList& list = cache->lists[cls];
+    if (list.count > 0)
+        bump(cache->localHits, uint64_t(1));
+    else
+        refill(list, cls);
+
+    bump(cache->allocations, uint64_t(1));
+    bump(cache->inUse, int64_t(1));
+    return list.pop();
+}
+
+void BufferPool::deallocate(void* ptr, size_t bytes) noexcept
+{
+    if (!ptr)
+        return;
+
+    if (bytes > MAX_BLOCK)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    size_t cls = classOf(bytes);
+    ThreadCache* cache = localCache();
+
+    if (!cache)
+    {
+        Depot& global = depot();
+        std::lock_guard<std::mutex> lock(global.mutex);
+        global.lists[cls].push(static_cast<Block*>(ptr));
+        --global.retiredInUse;
+        return;
+    }
+
+    FreeList& list = cache->lists[cls];
+    list.push(static_cast<Block*>(ptr));
+    bump(cache->inUse, int64_t(-1));
+
+    if (list.count > localLimit(cls))
+        spill(list, cls, batchSize(cls));
+}
+
+// ==================== ESTATÍSTICAS ====================
+
+BufferPool::Stats BufferPool::stats()
+{
+    Depot& global = depot();
+    Stats result;
+
+    std::lock_guard<std::mutex> lock(global.mutex);
+    result.allocations = global.retiredAllocations;
+    result.localHits = global.retiredHits;
+    result.blocksInUse = global.retiredInUse;
+    for (const ThreadCache* cache : global.caches)
+    {
+        result.allocations += cache->allocations.load(std::memory_order_relaxed);
+        result.localHits += cache->localHits.load(std::memory_order_relaxed);
+        result.blocksInUse += cache->inUse.load(std::memory_order_relaxed);
+    }
+
+    result.refills = global.refills.load(std::memory_order_relaxed);
+    result.slabs = global.slabs.load(std::memory_order_relaxed);
+    result.oversized = global.oversized.load(std::memory_order_relaxed);
+    result.bytesReserved = global.bytesReserved.load(std::memory_order_relaxed);
+    return result;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Classe BufferPool
+ * -----------------
+ * Alocador por classes de tamanho (potências de 2, de 64 B a 64 KiB) para
+ * os buffers de rede e os objetos que vivem por frame ou por conexão
+ * (frames da fila de saída, frames aguardando o pool, conexões).
+ *
+ * Cada thread tem uma cache de blocos livres por classe, acessada sem lock.
+ * Quando a cache de uma classe esvazia, ela busca um lote na reserva global
+ * (mutex); só com a reserva vazia um slab novo é pedido ao sistema e
+ * fatiado em blocos. Quando passa do limite, metade volta para a reserva.
+ * Assim um bloco liberado por outra thread (ex: mensagem roteada entre
+ * reactors) circula de volta sem crescer o pool.
+ *
+ * Em regime (pool aquecido), alocar e liberar é um pop/push numa lista
+ * intrusiva: abrir/fechar conexões e trocar mensagens não chama malloc.
+ * Os slabs nunca voltam ao sistema; a memória fica limitada pelo pico de
+ * uso. Pedidos maiores que MAX_BLOCK vão direto ao operador new.
+ */
+class BufferPool
+{
+public:
+    static constexpr size_t MIN_BLOCK = 64;
+    static constexpr size_t MAX_BLOCK = 64 * 1024;
+    static constexpr size_t CLASSES = 11;
+
+    /**
+     * Contadores acumulados de todas as threads (para /metrics)
+     */
+    struct Stats
+    {
+        uint64_t allocations = 0;   // Pedidos atendidos por alguma classe
+        uint64_t localHits = 0;     // Atendidos pela cache da própria thread
+        uint64_t refills = 0;       // Lotes buscados na reserva global
+        uint64_t slabs = 0;         // Slabs pedidos ao sistema
+        uint64_t oversized = 0;     // Pedidos acima de MAX_BLOCK (operador new)
+        uint64_t bytesReserved = 0; // Bytes em slabs (nunca diminui)
+        int64_t blocksInUse = 0;    // Blocos entregues e ainda não liberados
+    };
+
+    /**
+     * Aloca 'bytes' (alinhamento de max_align_t).
+     * @throws std::bad_alloc se o sistema negar memória
+     */
+    static void* allocate(size_t bytes);
+
+    /**
+     * Libera um bloco; 'bytes' deve ser o mesmo tamanho pedido em allocate().
+     */
+    static void deallocate(void* ptr, size_t bytes) noexcept;
+
+    static Stats stats();
+};
+
+/**
+ * Allocator STL sobre o BufferPool (sem estado: qualquer instância libera
+ * o que outra alocou)
+ */
+template <typename T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) { return static_cast<T*>(BufferPool::allocate(n * sizeof(T))); }
+    void deallocate(T* ptr, size_t n) noexcept { BufferPool::deallocate(ptr, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+};
+
+/**
+ * Base para objetos alocados com new/unique_ptr que devem sair do pool
+ * (ex: estado de conexão)
+ */
+struct PoolAllocated
+{
+    static void* operator new(size_t size) { return BufferPool::allocate(size); }
+    static void operator delete(void* ptr, size_t size) noexcept { BufferPool::deallocate(ptr, size); }
+};
+
+using PooledString = std::basic_string<char, std::char_traits<char>, PoolAllocator<char>>;
+
+template <typename T>
+using PooledDeque = std::deque<T, PoolAllocator<T>>;
+
+template <typename Key, typename Value>
+using PooledMap = std::unordered_map<Key, Value, std::hash<Key>, std::equal_to<Key>,
+                                     PoolAllocator<std::pair<const Key, Value>>>;
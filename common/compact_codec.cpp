@@ -0,0 +1,479 @@
+#include "compact_codec.hpp"
+#include "protocol_registry.hpp"
+#include <array>
+#include <ctime>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace Protocol
+{
+
+// Os códigos do fio são os valores dos enums: não reordenar
+static_assert(static_cast<int>(MessageType::REGISTER) == 0 && static_cast<int>(MessageType::HELLO_OK) == 12 &&
+              static_cast<int>(MessageType::BATCH_OK) == 14,
+              "códigos de MessageType do protocolo compacto mudaram");
+static_assert(static_cast<int>(ErrorType::INTERNAL_SERVER_ERROR) == 7,
+              "códigos de ErrorType do protocolo compacto mudaram");
+
+namespace
+{
+    constexpr size_t MAX_VARINT_BYTES = 10;
+
+    /**
+     * Cursor de leitura sobre o payload. Qualquer leitura além do fim lança
+     * ParseException.
+     */
+    class Reader
+    {
+    public:
+        explicit Reader(std::string_view payload) : pos(payload.data()), end(payload.data() + payload.size()) {}
+
+        uint8_t byte()
+        {
+            if (pos == end)
+                throw ParseException("Payload compacto truncado");
+            return static_cast<uint8_t>(*pos++);
+        }
+
+        uint64_t varint()
+        {
+            uint64_t value = 0;
+            for (size_t i = 0; i < MAX_VARINT_BYTES; ++i)
+            {
+                uint8_t b = byte();
+                value |= static_cast<uint64_t>(b & 0x7F) << (7 * i);
+                if (!(b & 0x80))
+                    return value;
+            }
+            throw ParseException("Varint inválido");
+        }
+
+        /**
+         * String UTF-8 (view para dentro do payload)
+         */
+        std::string_view string(size_t max_length = SIZE_MAX)
+        {
+            uint64_t length = varint();
+            if (length > static_cast<uint64_t>(end - pos))
+                throw ParseException("Payload compacto truncado");
+            if (length > max_length)
+                throw ParseException("Campo maior que o limite do protocolo");
+
+            std::string_view value(pos, static_cast<size_t>(length));
+            if (!isValidUtf8(value))
+                throw ParseException("String com UTF-8 inválido");
+            pos += length;
+            return value;
+        }
+
+        /**
+         * Bytes sem validação (payload v2 aninhado no BATCH)
+         */
+        std::string_view bytes()
+        {
+            uint64_t length = varint();
+            if (length > static_cast<uint64_t>(end - pos))
+                throw ParseException("Payload compacto truncado");
+
+            std::string_view value(pos, static_cast<size_t>(length));
+            pos += length;
+            return value;
+        }
+
+        /**
+         * Quantidade de itens de uma lista (cada item ocupa ao menos um byte)
+         */
+        uint64_t count(uint64_t max_count = UINT64_MAX)
+        {
+            uint64_t value = varint();
+            if (value > static_cast<uint64_t>(end - pos) || value > max_count)
+                throw ParseException("Quantidade inválida no payload compacto");
+            return value;
+        }
+
+        void finish() const
+        {
+            if (pos != end)
+                throw ParseException("Bytes extras no payload compacto");
+        }
+
+    private:
+        const char* pos;
+        const char* end;
+    };
+
+    void writeVarint(std::string& out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    void writeString(std::string& out, std::string_view value)
+    {
+        writeVarint(out, value.size());
+        out.append(value);
+    }
+
+    uint64_t zigzag(int64_t value)
+    {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t unzigzag(uint64_t value)
+    {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    std::string header(MessageType type)
+    {
+        std::string out;
+        out.push_back(static_cast<char>(COMPACT_VERSION));
+        out.push_back(static_cast<char>(type));
+        return out;
+    }
+
+    /**
+     * OK e respostas de erro já no v2 (cabeçalho + código do erro)
+     */
+    struct CompactResponses
+    {
+        std::string ok;
+        std::array<std::string, static_cast<size_t>(ErrorType::INTERNAL_SERVER_ERROR) + 1> errors;
+    };
+
+    const CompactResponses& compactResponses()
+    {
+        static const CompactResponses responses = []
+        {
+            CompactResponses built;
+            built.ok = header(MessageType::OK);
+            for (size_t code = 0; code < built.errors.size(); ++code)
+            {
+                built.errors[code] = header(MessageType::ERROR_MSG);
+                built.errors[code].push_back(static_cast<char>(code));
+            }
+            return built;
+        }();
+        return responses;
+    }
+
+    /**
+     * Itens de um BATCH/BATCH_OK: quantidade + payload v2 de cada um
+     */
+    void writeList(std::string& out, const json& items)
+    {
+        if (!items.is_array())
+            throw ParseException("Lista do BATCH inválida");
+
+        writeVarint(out, items.size());
+        for (const json& item : items)
+            writeString(out, encodeCompact(item));
+    }
+
+    std::vector<json> readList(Reader& in)
+    {
+        std::vector<json> items;
+        for (uint64_t i = in.count(MAX_BATCH_SIZE); i > 0; --i)
+        {
+            std::string_view item = in.bytes();
+            if (item.size() > 1 && (static_cast<uint8_t>(item[1]) == static_cast<uint8_t>(MessageType::BATCH) ||
+                                    static_cast<uint8_t>(item[1]) == static_cast<uint8_t>(MessageType::BATCH_OK)))
+                throw ParseException("BATCH aninhado no protocolo compacto");
+            items.push_back(decodeCompact(item));
+        }
+        return items;
+    }
+
+    const json& member(const json& object, const char* key)
+    {
+        auto it = object.find(key);
+        if (it == object.end())
+            throw ParseException(std::string("Campo '") + key + "' ausente");
+        return *it;
+    }
+
+    std::string_view stringMember(const json& object, const char* key)
+    {
+        const json& value = member(object, key);
+        if (!value.is_string())
+            throw ParseException(std::string("Campo '") + key + "' inválido");
+        return value.get_ref<const std::string&>();
+    }
+
+    /**
+     * Requisição de campos string no v2 (a negociação, HELLO, fica em JSON;
+     * o BATCH tem formato próprio)
+     */
+    const MessageDescriptor* compactRequest(MessageType type)
+    {
+        if (static_cast<size_t>(type) >= MESSAGE_TYPE_COUNT || type == MessageType::HELLO ||
+            type == MessageType::BATCH)
+            return nullptr;
+        const MessageDescriptor& message = messageDescriptor(type);
+        return message.isRequest() ? &message : nullptr;
+    }
+}
+
+// ==================== REQUISIÇÕES (SERVIDOR) ====================
+
+Request parseCompactRequest(std::string_view payload)
+{
+    Reader in(payload);
+    if (in.byte() != COMPACT_VERSION)
+        throw ParseException("Versão do protocolo compacto não suportada");
+
+    Request request;
+    const MessageDescriptor* message = messageDescriptor(in.byte());
+
+    // Tipo que não é requisição: UNKNOWN_COMMAND/BAD_STATE no handler
+    if (!message || !message->isRequest())
+    {
+        request.type = message ? message->type : MessageType::UNKNOWN;
+        return request;
+    }
+
+    request.type = message->type;
+
+    // Itens como views do mesmo payload
+    if (request.type == MessageType::BATCH)
+    {
+        uint64_t count = in.count(MAX_BATCH_SIZE);
+        request.batch.reserve(count);
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            std::string_view item = in.bytes();
+
+            // BATCH aninhado não é interpretado (o handler responde com erro)
+            if (isCompact(item) && item.size() > 1 && static_cast<uint8_t>(item[1]) == static_cast<uint8_t>(MessageType::BATCH))
+                request.batch.emplace_back().type = MessageType::BATCH;
+            else
+                request.batch.push_back(parseCompactRequest(item));
+        }
+        in.finish();
+        return request;
+    }
+
+    for (size_t i = 0; i < message->fieldCount; ++i)
+    {
+        const FieldDescriptor& field = fieldDescriptor(message->fields[i]);
+        request.*(field.member) = {in.string(field.maxLength), RequestField::State::STRING};
+    }
+
+    in.finish();
+    return request;
+}
+
+// ==================== CODIFICAÇÃO ====================
+
+std::string encodeCompact(const json& message)
+{
+    MessageType type = stringToMessageType(stringMember(message, "type"));
+    std::string out = header(type);
+
+    static const json EMPTY = json::object();
+    auto it = message.find("payload");
+    const json& payload = it != message.end() ? *it : EMPTY;
+
+    // Requisições: os campos do registro, na ordem dele
+    if (const MessageDescriptor* request = compactRequest(type))
+    {
+        for (size_t i = 0; i < request->fieldCount; ++i)
+            writeString(out, stringMember(payload, fieldDescriptor(request->fields[i]).key.data()));
+        return out;
+    }
+
+    switch (type)
+    {
+        case MessageType::LOGIN_OK:
+            writeString(out, stringMember(payload, "nickname"));
+            break;
+        case MessageType::OK:
+            break;
+        case MessageType::ERROR_MSG:
+            out.push_back(static_cast<char>(stringToErrorType(std::string(stringMember(payload, "message")))));
+            break;
+        case MessageType::DELIVER_MSG:
+        {
+            writeString(out, stringMember(message, "from"));
+            writeString(out, stringMember(payload, "text"));
+            const json& ts = member(payload, "ts");
+            if (!ts.is_number_integer())
+                throw ParseException("Campo 'ts' inválido");
+            writeVarint(out, zigzag(ts.get<int64_t>()));
+            break;
+        }
+        case MessageType::USERS:
+        {
+            const json& users = member(payload, "users");
+            if (!users.is_array())
+                throw ParseException("Campo 'users' inválido");
+
+            writeVarint(out, users.size());
+            for (const json& user : users)
+            {
+                writeString(out, stringMember(user, "nick"));
+                writeString(out, stringMember(user, "name"));
+                const json& online = member(user, "online");
+                if (!online.is_boolean())
+                    throw ParseException("Campo 'online' inválido");
+                out.push_back(online.get<bool>() ? 1 : 0);
+            }
+            break;
+        }
+        case MessageType::BATCH:
+            writeList(out, member(payload, "requests"));
+            break;
+        case MessageType::BATCH_OK:
+            writeList(out, member(payload, "responses"));
+            break;
+        default:
+            throw ParseException("Tipo sem representação no protocolo compacto");
+    }
+    return out;
+}
+
+std::string_view compactOk()
+{
+    return compactResponses().ok;
+}
+
+std::string_view compactError(ErrorType error)
+{
+    return compactResponses().errors[static_cast<size_t>(error)];
+}
+
+std::string encodeCompactLoginOk(std::string_view nickname)
+{
+    std::string out = header(MessageType::LOGIN_OK);
+    writeString(out, nickname);
+    return out;
+}
+
+std::string encodeCompactDeliver(std::string_view from, std::string_view text, int64_t ts)
+{
+    std::string out = header(MessageType::DELIVER_MSG);
+    out.reserve(from.size() + text.size() + 2 + 3 * MAX_VARINT_BYTES);
+    writeString(out, from);
+    writeString(out, text);
+    writeVarint(out, zigzag(ts));
+    return out;
+}
+
+std::string encodeCompactUsers(const std::vector<UserInfo>& users)
+{
+    std::string out = header(MessageType::USERS);
+    writeVarint(out, users.size());
+    for (const UserInfo& user : users)
+    {
+        writeString(out, user.nickname);
+        writeString(out, user.fullName);
+        out.push_back(user.isOnline ? 1 : 0);
+    }
+    return out;
+}
+
+std::string encodeCompactBatchOk(const std::vector<std::string>& responses)
+{
+    std::string out = header(MessageType::BATCH_OK);
+    writeVarint(out, responses.size());
+    for (const auto& response : responses)
+        writeString(out, response);
+    return out;
+}
+
+std::string transcodeToCompact(std::string_view json_text)
+{
+    // Respostas constantes (a maioria das respostas de um bot): sem parse
+    if (json_text == OK_RESPONSE)
+        return std::string(compactOk());
+
+    if (peekMessageType(json_text) == MessageType::ERROR_MSG)
+    {
+        for (uint8_t code = 0; code <= static_cast<uint8_t>(ErrorType::INTERNAL_SERVER_ERROR); ++code)
+            if (json_text == errorResponse(static_cast<ErrorType>(code)))
+                return std::string(compactError(static_cast<ErrorType>(code)));
+    }
+
+    return encodeCompact(json::parse(json_text));
+}
+
+// ==================== DECODIFICAÇÃO ====================
+
+json decodeCompact(std::string_view payload)
+{
+    Reader in(payload);
+    if (in.byte() != COMPACT_VERSION)
+        throw ParseException("Versão do protocolo compacto não suportada");
+
+    json message;
+    auto type = static_cast<MessageType>(in.byte());
+
+    // Requisições: mesmo documento dos builders ({"type", "payload"})
+    if (const MessageDescriptor* request = compactRequest(type))
+    {
+        json payload = json::object();
+        for (size_t i = 0; i < request->fieldCount; ++i)
+            payload[std::string(fieldDescriptor(request->fields[i]).key)] = std::string(in.string());
+
+        in.finish();
+        return {{"type", std::string(request->name)}, {"payload", std::move(payload)}};
+    }
+
+    switch (type)
+    {
+        case MessageType::OK:
+            message = buildOkResponse();
+            break;
+        case MessageType::LOGIN_OK:
+            message = buildLoginOkResponse(std::string(in.string()));
+            break;
+        case MessageType::ERROR_MSG:
+        {
+            uint8_t code = in.byte();
+            if (code > static_cast<uint8_t>(ErrorType::INTERNAL_SERVER_ERROR))
+                throw ParseException("Código de erro desconhecido");
+            message = buildErrorResponse(static_cast<ErrorType>(code));
+            break;
+        }
+        case MessageType::DELIVER_MSG:
+        {
+            std::string from(in.string());
+            std::string text(in.string());
+            message = buildDeliverMessage(from, text, static_cast<time_t>(unzigzag(in.varint())));
+            break;
+        }
+        case MessageType::USERS:
+        {
+            uint64_t count = in.varint();
+            std::vector<UserInfo> users;
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                UserInfo user;
+                user.nickname = in.string();
+                user.fullName = in.string();
+                user.isOnline = in.byte() != 0;
+                users.push_back(std::move(user));
+            }
+            message = buildUsersListResponse(users);
+            break;
+        }
+        case MessageType::BATCH:
+            message = buildBatchRequest(readList(in));
+            break;
+        case MessageType::BATCH_OK:
+            message = buildBatchOkResponse(readList(in));
+            break;
+        default:
+            throw ParseException("Tipo desconhecido no protocolo compacto");
+    }
+
+    in.finish();
+    return message;
+}
+
+} // namespace Protocol
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "protocol.hpp"
+#include "request_parser.hpp"
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Protocolo compacto (v2)
+ * -----------------------
+ * Codificação binária negociada com "encoding":"compact" no HELLO (sempre
+ * com framing LENGTH). Em vez das chaves e dos nomes de tipo/erro do JSON,
+ * cada payload leva os códigos numéricos de MessageType/ErrorType e os
+ * campos na ordem fixa do tipo:
+ *
+ *   [versão = 0x02][tipo: u8][campos...]
+ *
+ *   REGISTER     nickname, fullname
+ *   LOGIN        nickname
+ *   DELETE_USER  nickname
+ *   SEND_MSG     to, text
+ *   LOGIN_OK     nickname
+ *   ERROR        código (u8)
+ *   DELIVER_MSG  from, text, ts
+ *   USERS        quantidade e, por usuário: nick, name, online (u8)
+ *   LOGOUT, LIST_USERS, OK: sem campos
+ *   BATCH        quantidade e, por requisição, o payload v2 dela (bytes)
+ *   BATCH_OK     quantidade e, por resposta, o payload v2 dela (bytes)
+ *
+ * Strings: tamanho em varint (LEB128) + bytes UTF-8. Inteiros: varint
+ * (ts em zigzag). HELLO/HELLO_OK não existem no v2: a negociação é em JSON.
+ *
+ * O servidor interpreta as requisições direto para Protocol::Request (views
+ * para dentro do frame, sem alocar), então os handlers são os mesmos do
+ * JSON. Payload malformado lança ParseException (BAD_FORMAT).
+ */
+
+namespace Protocol
+{
+
+constexpr uint8_t COMPACT_VERSION = 0x02;
+
+/**
+ * O payload é do protocolo compacto (primeiro byte = versão)
+ */
+inline bool isCompact(std::string_view payload)
+{
+    return !payload.empty() && static_cast<uint8_t>(payload.front()) == COMPACT_VERSION;
+}
+
+/**
+ * Requisição compacta, no mesmo formato do parser JSON.
+ * @throws ParseException se o payload é malformado
+ */
+Request parseCompactRequest(std::string_view payload);
+
+/**
+ * Mensagem (requisição ou resposta, no formato dos builders) para o v2.
+ * @throws ParseException se o tipo não existe no v2 ou falta campo
+ */
+std::string encodeCompact(const nlohmann::json& message);
+
+/**
+ * Respostas do servidor escritas direto no v2, a partir dos campos (os
+ * mesmos bytes do encodeCompact sobre o documento dos builders). OK e erros
+ * são constantes.
+ */
+std::string_view compactOk();
+std::string_view compactError(ErrorType error);
+std::string encodeCompactLoginOk(std::string_view nickname);
+std::string encodeCompactDeliver(std::string_view from, std::string_view text, int64_t ts);
+std::string encodeCompactUsers(const std::vector<UserInfo>& users);
+
+/**
+ * BATCH_OK com as respostas já no v2 (entram sem conversão)
+ */
+std::string encodeCompactBatchOk(const std::vector<std::string>& responses);
+
+/**
+ * Mensagem JSON já serializada para o v2. As respostas constantes (OK e
+ * erros) são traduzidas sem parse.
+ * @throws nlohmann::json::parse_error se 'json_text' não é JSON válido
+ * @throws ParseException como encodeCompact
+ */
+std::string transcodeToCompact(std::string_view json_text);
+
+/**
+ * Payload v2 para o DOM equivalente dos builders.
+ * @throws ParseException se o payload é malformado
+ */
+nlohmann::json decodeCompact(std::string_view payload);
+
+} // namespace Protocol
@@ -0,0 +1,156 @@
+#include "compression.hpp"
+#include <zlib.h>
+
+namespace
+{
+    // Deflate cru com a janela máxima (32 KiB de histórico)
+    constexpr int RAW_WINDOW_BITS = -MAX_WBITS;
+    constexpr int MEM_LEVEL = 8;
+    constexpr size_t WINDOW_SIZE = size_t(1) << MAX_WBITS;
+    constexpr size_t INFLATE_CHUNK = 16384;
+
+    // Fim de todo Z_SYNC_FLUSH (bloco stored vazio): fica fora do fio
+    constexpr unsigned char FLUSH_TRAILER[] = {0x00, 0x00, 0xFF, 0xFF};
+
+    Bytef* bytes(const char* data)
+    {
+        return reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    }
+}
+
+// ==================== DEFLATE ====================
+
+DeflateStream::DeflateStream(int level) : stream(std::make_unique<z_stream>()), ok(false)
+{
+    ok = deflateInit2(stream.get(), level, Z_DEFLATED, RAW_WINDOW_BITS, MEM_LEVEL, Z_DEFAULT_STRATEGY) == Z_OK;
+}
+
+DeflateStream::~DeflateStream()
+{
+    deflateEnd(stream.get());
+}
+
+bool DeflateStream::compress(std::string_view message, std::string& out)
+{
+    if (!ok)
+        return false;
+
+    size_t start = out.size();
+    stream->next_in = bytes(message.data());
+    stream->avail_in = static_cast<uInt>(message.size());
+
+    // O limite do deflateBound cobre quase sempre a mensagem numa volta só
+    size_t chunk = deflateBound(stream.get(), static_cast<uLong>(message.size())) + sizeof(FLUSH_TRAILER);
+    do
+    {
+        size_t used = out.size();
+        out.resize(used + chunk);
+        stream->next_out = bytes(out.data() + used);
+        stream->avail_out = static_cast<uInt>(chunk);
+
+        int result = deflate(stream.get(), Z_SYNC_FLUSH);
+        out.resize(used + chunk - stream->avail_out);
+        if (result != Z_OK && result != Z_BUF_ERROR)
+        {
+            ok = false;
+            return false;
+        }
+    } while (stream->avail_out == 0);
+
+    size_t produced = out.size() - start;
+    if (produced < sizeof(FLUSH_TRAILER) ||
+        out.compare(out.size() - sizeof(FLUSH_TRAILER), sizeof(FLUSH_TRAILER),
+                    reinterpret_cast<const char*>(FLUSH_TRAILER), sizeof(FLUSH_TRAILER)) != 0)
+    {
+        ok = false;
+        return false;
+    }
+
+    out.resize(out.size() - sizeof(FLUSH_TRAILER));
+    return true;
+}
+
+std::string DeflateStream::window() const
+{
+    std::string window(WINDOW_SIZE, '\0');
+    uInt length = static_cast<uInt>(window.size());
+    if (!ok || deflateGetDictionary(stream.get(), bytes(window.data()), &length) != Z_OK)
+        return {};
+    window.resize(length);
+    return window;
+}
+
+bool DeflateStream::setWindow(std::string_view window)
+{
+    // Deflate cru: só antes da primeira mensagem do contexto
+    if (!ok || window.empty())
+        return ok;
+    ok = deflateSetDictionary(stream.get(), bytes(window.data()), static_cast<uInt>(window.size())) == Z_OK;
+    return ok;
+}
+
+// ==================== INFLATE ====================
+
+InflateStream::InflateStream() : stream(std::make_unique<z_stream>()), ok(false)
+{
+    ok = inflateInit2(stream.get(), RAW_WINDOW_BITS) == Z_OK;
+}
+
+InflateStream::~InflateStream()
+{
+    inflateEnd(stream.get());
+}
+
+bool InflateStream::decompress(std::string_view frame, std::string& out, size_t max_size)
+{
+    if (!ok)
+        return false;
+
+    size_t start = out.size();
+    auto feed = [&](const char* data, size_t len)
+    {
+        stream->next_in = bytes(data);
+        stream->avail_in = static_cast<uInt>(len);
+        do
+        {
+            size_t used = out.size();
+            out.resize(used + INFLATE_CHUNK);
+            stream->next_out = bytes(out.data() + used);
+            stream->avail_out = static_cast<uInt>(INFLATE_CHUNK);
+
+            int result = inflate(stream.get(), Z_SYNC_FLUSH);
+            out.resize(used + INFLATE_CHUNK - stream->avail_out);
+
+            // Z_STREAM_END: o peer nunca fecha o fluxo (bloco final é erro)
+            if ((result != Z_OK && result != Z_BUF_ERROR) || out.size() - start > max_size)
+                return false;
+
+            // Sem progresso possível: a entrada acabou
+            if (result == Z_BUF_ERROR && stream->avail_out != 0)
+                break;
+        } while (stream->avail_in > 0 || stream->avail_out == 0);
+        return true;
+    };
+
+    ok = feed(frame.data(), frame.size()) &&
+         feed(reinterpret_cast<const char*>(FLUSH_TRAILER), sizeof(FLUSH_TRAILER));
+    return ok;
+}
+
+std::string InflateStream::window() const
+{
+    std::string window(WINDOW_SIZE, '\0');
+    uInt length = static_cast<uInt>(window.size());
+    if (!ok || inflateGetDictionary(stream.get(), bytes(window.data()), &length) != Z_OK)
+        return {};
+    window.resize(length);
+    return window;
+}
+
+bool InflateStream::setWindow(std::string_view window)
+{
+    if (!ok || window.empty())
+        return ok;
+    ok = inflateSetDictionary(stream.get(), bytes(window.data()), static_cast<uInt>(window.size())) == Z_OK;
+    return ok;
+}
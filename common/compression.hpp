@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+struct z_stream_s;
+
+/**
+ * Compressão de fluxo (deflate)
+ * -----------------------------
+ * Contextos deflate/inflate de uma conexão, negociados com
+ * "compression":"deflate" no HELLO. O contexto vive enquanto a conexão
+ * existir: cada mensagem é comprimida com o histórico (janela de 32 KiB) das
+ * anteriores, então chaves e apelidos que se repetem em DELIVER_MSG e USERS
+ * custam poucos bits depois da primeira vez.
+ *
+ * Cada mensagem termina com Z_SYNC_FLUSH: tudo o que entrou sai na hora, sem
+ * esperar a próxima mensagem, e o frame é decodificável sozinho (dado o
+ * histórico). Os 4 bytes finais do flush (00 00 FF FF) são sempre iguais e
+ * não vão no fio, como no permessage-deflate do WebSocket (RFC 7692).
+ *
+ * Deflate cru (sem cabeçalho zlib): o enquadramento já é do framing LENGTH.
+ * Não é thread-safe: pertence à thread dona da conexão.
+ */
+
+class DeflateStream
+{
+public:
+    /**
+     * Nível padrão: o 1 já pega a repetição entre mensagens (o grosso do
+     * ganho) com uma fração da CPU do 6 (ver bench_compression)
+     */
+    static constexpr int DEFAULT_LEVEL = 1;
+
+    explicit DeflateStream(int level = DEFAULT_LEVEL);
+    ~DeflateStream();
+
+    DeflateStream(const DeflateStream&) = delete;
+    DeflateStream& operator=(const DeflateStream&) = delete;
+
+    /**
+     * Acrescenta a 'out' a mensagem comprimida (sem o trailer do flush).
+     * @return false se o zlib falhar (o contexto fica inutilizável)
+     */
+    bool compress(std::string_view message, std::string& out);
+
+    /**
+     * Janela atual (últimos até 32 KiB de entrada), para o handoff: um
+     * contexto novo com setWindow() continua o mesmo fluxo.
+     */
+    std::string window() const;
+    bool setWindow(std::string_view window);
+
+private:
+    std::unique_ptr<z_stream_s> stream;
+    bool ok;
+};
+
+class InflateStream
+{
+public:
+    InflateStream();
+    ~InflateStream();
+
+    InflateStream(const InflateStream&) = delete;
+    InflateStream& operator=(const InflateStream&) = delete;
+
+    /**
+     * Acrescenta a 'out' a mensagem descomprimida de um frame.
+     * @param max_size Limite da mensagem descomprimida (proteção contra bombas)
+     * @return false se o frame é inválido ou passa do limite
+     */
+    bool decompress(std::string_view frame, std::string& out, size_t max_size);
+
+    /**
+     * Janela atual (últimos até 32 KiB de saída), para o handoff.
+     */
+    std::string window() const;
+    bool setWindow(std::string_view window);
+
+private:
+    std::unique_ptr<z_stream_s> stream;
+    bool ok;
+};
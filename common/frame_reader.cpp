@@ -0,0 +1,231 @@
+#include "frame_reader.hpp"
+#include <sys/socket.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+// ==================== CONSTRUTOR ====================
+
+FrameReader::FrameReader(size_t max_frame_size)
+    : framing(SocketUtils::Framing::LINE), scanned(0), expected(0), skipping(0), type(0),
+      maxFrameSize(max_frame_size), inflatedUsed(0), failed(false) {}
+
+// ==================== RECEPÇÃO ====================
+
+ssize_t FrameReader::fill(int sockfd)
+{
+    if (failed)
+    {
+        errno = EPROTO;
+        return -1;
+    }
+    recycleInflated();
+
+    // Frame LENGTH incompleto: o anel passa a caber o frame inteiro
+    size_t wanted = expected > ring.readable() ? expected - ring.readable() : 1;
+    if (!reserve(wanted))
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    while (true)
+    {
+        ssize_t bytes = recv(sockfd, ring.writePtr(), ring.writable(), 0);
+        if (bytes < 0 && errno == EINTR)
+            continue;
+
+        if (bytes > 0)
+            ring.commit(static_cast<size_t>(bytes));
+        return bytes;
+    }
+}
+
+bool FrameReader::append(const char* data, size_t len)
+{
+    if (failed)
+        return false;
+    recycleInflated();
+
+    if (len == 0)
+        return true;
+
+    if (!reserve(len))
+        return false;
+
+    ring.write(data, len);
+    return true;
+}
+
+// ==================== FRAMING ====================
+
+std::optional<std::string_view> FrameReader::next()
+{
+    return framing == SocketUtils::Framing::LENGTH ? nextPrefixed() : nextLine();
+}
+
+void FrameReader::setFraming(SocketUtils::Framing mode)
+{
+    framing = mode;
+    scanned = expected = skipping = 0;
+}
+
+std::optional<std::string_view> FrameReader::nextLine()
+{
+    const char* base = ring.readPtr();
+    size_t available = ring.readable();
+    const char* newline = available > scanned
+        ? static_cast<const char*>(memchr(base + scanned, '\n', available - scanned))
+        : nullptr;
+
+    if (!newline)
+    {
+        // Proteção contra mensagens gigantescas
+        if (available > maxFrameSize)
+        {
+            std::cerr << "[SocketUtils] Mensagem muito longa, descartando" << std::endl;
+            clear();
+        }
+        else
+            scanned = available;
+        return std::nullopt;
+    }
+
+    // Mesmo cruzando o fim do anel o frame é contíguo (segunda cópia)
+    size_t length = static_cast<size_t>(newline - base);
+    ring.consume(length + 1);
+    scanned = 0;
+    return std::string_view(base, length);
+}
+
+std::optional<std::string_view> FrameReader::nextPrefixed()
+{
+    while (skipDiscarded() && ring.readable() >= SocketUtils::FRAME_HEADER_SIZE)
+    {
+        const auto* header = reinterpret_cast<const unsigned char*>(ring.readPtr());
+        size_t length = (size_t(header[0]) << 24) | (size_t(header[1]) << 16) |
+                        (size_t(header[2]) << 8) | size_t(header[3]);
+
+        // Proteção contra mensagens gigantescas: pula o payload sem guardá-lo
+        if (length > SocketUtils::MAX_LENGTH_FRAME_SIZE)
+        {
+            std::cerr << "[SocketUtils] Mensagem muito longa, descartando" << std::endl;
+            ring.consume(SocketUtils::FRAME_HEADER_SIZE);
+            skipping = length;
+            expected = 0;
+            continue;
+        }
+
+        size_t total = SocketUtils::FRAME_HEADER_SIZE + length;
+        if (ring.readable() < total)
+        {
+            expected = total;
+            return std::nullopt;
+        }
+
+        const char* payload = ring.readPtr() + SocketUtils::FRAME_HEADER_SIZE;
+        type = header[4];
+        ring.consume(total);
+        expected = 0;
+
+        // O anel só é sobrescrito no próximo fill(): a view ainda vale
+        if (type & SocketUtils::COMPRESSED_FRAME_FLAG)
+            return inflate(std::string_view(payload, length));
+        return std::string_view(payload, length);
+    }
+
+    return std::nullopt;
+}
+
+bool FrameReader::skipDiscarded()
+{
+    size_t dropped = std::min(skipping, ring.readable());
+    ring.consume(dropped);
+    skipping -= dropped;
+    return skipping == 0;
+}
+
+// ==================== COMPRESSÃO ====================
+
+void FrameReader::setCompression(SocketUtils::Compression mode)
+{
+    if (mode == SocketUtils::Compression::NONE)
+        inflater.reset();
+    else if (!inflater)
+        inflater = std::make_unique<InflateStream>();
+}
+
+std::string FrameReader::compressionWindow() const
+{
+    return inflater ? inflater->window() : std::string();
+}
+
+bool FrameReader::setCompressionWindow(std::string_view window)
+{
+    return inflater && inflater->setWindow(window);
+}
+
+std::optional<std::string_view> FrameReader::inflate(std::string_view payload)
+{
+    type &= static_cast<uint8_t>(~SocketUtils::COMPRESSED_FRAME_FLAG);
+
+    if (inflatedUsed == inflated.size())
+        inflated.emplace_back();
+    std::string& out = inflated[inflatedUsed];
+    out.clear();
+
+    if (!inflater || !inflater->decompress(payload, out, SocketUtils::MAX_LENGTH_FRAME_SIZE))
+    {
+        // Sem o frame o contexto do peer e o nosso divergem: não há como seguir
+        std::cerr << "[SocketUtils] Frame comprimido inválido, encerrando leitura" << std::endl;
+        clear();
+        failed = true;
+        return std::nullopt;
+    }
+
+    ++inflatedUsed;
+    return std::string_view(out);
+}
+
+void FrameReader::recycleInflated()
+{
+    // Um frame grande não deixa o buffer dele preso à conexão
+    for (size_t i = 0; i < inflatedUsed; ++i)
+        if (inflated[i].capacity() > CHUNK_SIZE)
+            std::string().swap(inflated[i]);
+    inflatedUsed = 0;
+}
+
+// ==================== ANEL ====================
+
+void FrameReader::clear()
+{
+    ring.clear();
+    scanned = expected = skipping = 0;
+    failed = false;
+    recycleInflated();
+}
+
+bool FrameReader::reserve(size_t len)
+{
+    size_t standard = maxFrameSize + CHUNK_SIZE;
+
+    // Anel crescido por um append grande: volta ao padrão quando esvazia
+    if (ring.readable() == 0 && ring.capacity() > standard)
+        ring.release();
+
+    if (!ring.allocated())
+        return ring.allocate(std::max(standard, len));
+
+    if (ring.writable() >= len)
+        return true;
+
+    RingBuffer grown;
+    if (!grown.allocate(ring.readable() + len))
+        return false;
+
+    grown.write(ring.readPtr(), ring.readable());
+    ring = std::move(grown);
+    return true;
+}
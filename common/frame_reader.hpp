@@ -0,0 +1,148 @@
+#pragma once
+
+#include "compression.hpp"
+#include "ring_buffer.hpp"
+#include "socket_utils.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+
+/**
+ * Classe FrameReader
+ * ------------------
+ * Buffer de leitura de uma conexão. fill() puxa do socket tudo o que couber
+ * no espaço livre com um único recv e next() devolve views dos frames
+ * completos sem copiá-los. No framing LINE os '\n' são localizados com
+ * memchr (vetorizado pela libc); no LENGTH o cabeçalho já diz o tamanho do
+ * frame e fill() garante espaço para ele inteiro antes do recv.
+ *
+ * Os bytes ficam num RingBuffer espelhado de tamanho fixo (limite de frame +
+ * CHUNK_SIZE): um frame que cruza o fim do anel continua contíguo, então não
+ * há compactação nem realocação no caminho normal. O anel só é mapeado na
+ * primeira leitura; se um append() maior que o espaço livre o fizer crescer
+ * (ex: bytes herdados no handoff), ele volta ao tamanho padrão ao esvaziar.
+ *
+ * Com compressão DEFLATE, frames marcados com COMPRESSED_FRAME_FLAG são
+ * descomprimidos pelo contexto da conexão para buffers próprios do leitor;
+ * os demais continuam como views do anel. Um frame comprimido inválido
+ * encerra a leitura: fill() passa a devolver -1 (EPROTO) e append() false.
+ *
+ * As views devolvidas por next() apontam para o anel (ou para os buffers de
+ * descompressão) e valem até a próxima chamada de fill(), append() ou
+ * clear(): quem precisa guardar o frame (ex: fila do pool) deve copiá-lo
+ * antes de ler mais.
+ *
+ * Não é thread-safe: pertence à thread dona da conexão.
+ */
+class FrameReader
+{
+public:
+    static constexpr size_t CHUNK_SIZE = 16384;
+
+    explicit FrameReader(size_t max_frame_size = SocketUtils::MAX_FRAME_SIZE);
+
+    /**
+     * Executa um recv no espaço livre do anel (repete em EINTR).
+     * @return Resultado do recv: bytes lidos, 0 em EOF ou -1 com errno
+     *         (ENOMEM se o anel não puder ser mapeado)
+     */
+    ssize_t fill(int sockfd);
+
+    /**
+     * Acrescenta bytes recebidos por outro caminho (buffer do io_uring,
+     * bytes herdados no handoff).
+     * @return false se o anel não puder ser mapeado
+     */
+    bool append(const char* data, size_t len);
+
+    /**
+     * Próximo frame completo (sem o '\n' ou o cabeçalho), ou nullopt se só
+     * há um frame parcial. Frames maiores que o limite são descartados.
+     */
+    std::optional<std::string_view> next();
+
+    /**
+     * Troca o framing; os bytes já recebidos são lidos no novo formato.
+     */
+    void setFraming(SocketUtils::Framing mode);
+    SocketUtils::Framing getFraming() const { return framing; }
+
+    /**
+     * Liga ou desliga a descompressão dos frames marcados. O contexto é
+     * criado vazio; no handoff, setCompressionWindow() restaura o histórico.
+     */
+    void setCompression(SocketUtils::Compression mode);
+    SocketUtils::Compression getCompression() const
+    {
+        return inflater ? SocketUtils::Compression::DEFLATE : SocketUtils::Compression::NONE;
+    }
+
+    /**
+     * Histórico do contexto de descompressão (vazio sem compressão).
+     */
+    std::string compressionWindow() const;
+    bool setCompressionWindow(std::string_view window);
+
+    /**
+     * Tipo declarado no cabeçalho do último frame LENGTH devolvido
+     * (código de Protocol::MessageType, sem COMPRESSED_FRAME_FLAG).
+     */
+    uint8_t frameType() const { return type; }
+
+    /**
+     * Bytes recebidos e ainda não consumidos por next().
+     */
+    std::string_view pending() const { return {ring.readPtr(), ring.readable()}; }
+
+    /**
+     * Fluxo comprimido inválido: nenhum frame sai mais desta conexão.
+     */
+    bool hasFailed() const { return failed; }
+
+    size_t size() const { return ring.readable(); }
+    bool empty() const { return ring.readable() == 0; }
+    void clear();
+
+private:
+    RingBuffer ring;
+    SocketUtils::Framing framing;
+    size_t scanned;         // Bytes da linha parcial já varridos
+    size_t expected;        // Tamanho (com cabeçalho) do frame LENGTH incompleto
+    size_t skipping;        // Bytes restantes de um frame LENGTH descartado
+    uint8_t type;
+    size_t maxFrameSize;
+
+    std::unique_ptr<InflateStream> inflater;
+    std::deque<std::string> inflated;   // Frames descomprimidos (deque: não movem)
+    size_t inflatedUsed;                // Buffers apontados por views desde o último fill()
+    bool failed;                        // Fluxo comprimido inválido
+
+    std::optional<std::string_view> nextLine();
+    std::optional<std::string_view> nextPrefixed();
+
+    /**
+     * Descomprime o payload de um frame marcado para o próximo buffer livre.
+     */
+    std::optional<std::string_view> inflate(std::string_view payload);
+
+    /**
+     * Libera os buffers de descompressão para o próximo lote de frames.
+     */
+    void recycleInflated();
+
+    /**
+     * Descarta até 'skipping' bytes já recebidos.
+     * @return true se o frame descartado terminou
+     */
+    bool skipDiscarded();
+
+    /**
+     * Garante 'len' bytes livres, mapeando ou crescendo o anel se preciso.
+     */
+    bool reserve(size_t len);
+};
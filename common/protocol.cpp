@@ -1,6 +1,10 @@
 #include "protocol.hpp"
+#include "compact_codec.hpp"
+#include "protocol_registry.hpp"
+#include "text_validation.hpp"
 #include <algorithm>
-#include <cctype>
+#include <array>
+#include <charconv>
 
 using json = nlohmann::json;
 
@@ -9,70 +13,44 @@ namespace Protocol
 
 // ==================== VALIDAÇÃO ====================
 
-bool isValidNickname(const std::string& nick)
+bool isValidNickname(std::string_view nick)
 {
-    if (nick.empty() || nick.length() > MAX_NICKNAME_LENGTH)
-        return false;
-    
-    // Apenas alfanuméricos e underscore
-    return std::all_of(nick.begin(), nick.end(), [](char c)
-    {
-        return std::isalnum(c) || c == '_';
-    });
+    // Apenas alfanuméricos ASCII e underscore
+    return !nick.empty() && nick.length() <= MAX_NICKNAME_LENGTH && TextValidation::isNicknameCharset(nick);
 }
 
-bool isValidFullName(const std::string& name)
+bool isValidFullName(std::string_view name)
 {
-    if (name.empty() || name.length() > MAX_FULLNAME_LENGTH)
+    if (name.empty() || name.length() > MAX_FULLNAME_LENGTH || !isValidUtf8(name))
         return false;
-    
+
     // Não pode ter apenas espaços
     return std::any_of(name.begin(), name.end(), [](char c)
     {
-        return !std::isspace(c);
+        return c != ' ' && (c < '\t' || c > '\r');
     });
 }
 
-bool isValidMessage(const std::string& msg)
+bool isValidMessage(std::string_view msg)
 {
-    return !msg.empty() && msg.length() <= MAX_MESSAGE_LENGTH;
+    return !msg.empty() && msg.length() <= MAX_MESSAGE_LENGTH && isValidUtf8(msg);
+}
+
+bool isValidUtf8(std::string_view text)
+{
+    return TextValidation::isValidUtf8(text);
 }
 
 // ==================== CONVERSÃO DE TIPOS ====================
 
-MessageType stringToMessageType(const std::string& type)
-{
-    if (type == "REGISTER") return MessageType::REGISTER;
-    if (type == "LOGIN") return MessageType::LOGIN;
-    if (type == "LOGOUT") return MessageType::LOGOUT;
-    if (type == "SEND_MSG") return MessageType::SEND_MSG;
-    if (type == "LIST_USERS") return MessageType::LIST_USERS;
-    if (type == "DELETE_USER") return MessageType::DELETE_USER;
-    if (type == "OK") return MessageType::OK;
-    if (type == "LOGIN_OK") return MessageType::LOGIN_OK;
-    if (type == "ERROR") return MessageType::ERROR_MSG;
-    if (type == "DELIVER_MSG") return MessageType::DELIVER_MSG;
-    if (type == "USERS") return MessageType::USERS;
-    return MessageType::UNKNOWN;
+MessageType stringToMessageType(std::string_view type)
+{
+    return lookupMessageType(type);
 }
 
 std::string messageTypeToString(MessageType type)
 {
-    switch (type)
-    {
-        case MessageType::REGISTER: return "REGISTER";
-        case MessageType::LOGIN: return "LOGIN";
-        case MessageType::LOGOUT: return "LOGOUT";
-        case MessageType::SEND_MSG: return "SEND_MSG";
-        case MessageType::LIST_USERS: return "LIST_USERS";
-        case MessageType::DELETE_USER: return "DELETE_USER";
-        case MessageType::OK: return "OK";
-        case MessageType::LOGIN_OK: return "LOGIN_OK";
-        case MessageType::ERROR_MSG: return "ERROR";
-        case MessageType::DELIVER_MSG: return "DELIVER_MSG";
-        case MessageType::USERS: return "USERS";
-        default: return "UNKNOWN";
-    }
+    return std::string(messageName(type));
 }
 
 ErrorType stringToErrorType(const std::string& error)
@@ -104,6 +82,22 @@ std::string errorTypeToString(ErrorType error)
     return "INTERNAL_SERVER_ERROR";
 }
 
+MessageType peekMessageType(std::string_view json)
+{
+    constexpr std::string_view key = "\"type\":\"";
+
+    size_t start = json.rfind(key);
+    if (start == std::string_view::npos)
+        return MessageType::UNKNOWN;
+
+    start += key.size();
+    size_t end = json.find('"', start);
+    if (end == std::string_view::npos)
+        return MessageType::UNKNOWN;
+
+    return stringToMessageType(json.substr(start, end - start));
+}
+
 // ==================== BUILDERS - REQUISIÇÕES ====================
 
 json buildRegisterRequest(const std::string& nickname, const std::string& fullName)
@@ -163,6 +157,36 @@ json buildDeleteUserRequest(const std::string& nickname)
     };
 }
 
+json buildHelloRequest(const std::string& framing, const std::string& encoding, const std::string& compression)
+{
+    return {
+        {"type", "HELLO"},
+        {"payload", {
+            {"framing", framing},
+            {"encoding", encoding},
+            {"compression", compression}
+        }}
+    };
+}
+
+json buildBatchOkResponse(const std::vector<json>& responses)
+{
+    return {
+        {"type", "BATCH_OK"},
+        {"payload", {{"responses", responses}}}
+    };
+}
+
+json buildBatchRequest(const std::vector<json>& requests)
+{
+    return {
+        {"type", "BATCH"},
+        {"payload", {
+            {"requests", requests}
+        }}
+    };
+}
+
 // ==================== BUILDERS - RESPOSTAS ====================
 
 json buildOkResponse()
@@ -214,13 +238,489 @@ json buildUsersListResponse(const std::vector<UserInfo>& users)
     };
 }
 
+json buildHelloOkResponse(const std::string& framing, const std::string& encoding, const std::string& compression)
+{
+    return {
+        {"type", "HELLO_OK"},
+        {"payload", {
+            {"framing", framing},
+            {"encoding", encoding},
+            {"compression", compression}
+        }}
+    };
+}
+
+// ==================== RESPOSTAS SERIALIZADAS ====================
+
+namespace
+{
+    // Na ordem de ErrorType
+    constexpr std::string_view ERROR_RESPONSES[] = {
+        R"({"payload":{"message":"NICK_TAKEN"},"type":"ERROR"})",
+        R"({"payload":{"message":"BAD_FORMAT"},"type":"ERROR"})",
+        R"({"payload":{"message":"NO_SUCH_USER"},"type":"ERROR"})",
+        R"({"payload":{"message":"ALREADY_ONLINE"},"type":"ERROR"})",
+        R"({"payload":{"message":"UNAUTHORIZED"},"type":"ERROR"})",
+        R"({"payload":{"message":"BAD_STATE"},"type":"ERROR"})",
+        R"({"payload":{"message":"UNKNOWN_COMMAND"},"type":"ERROR"})",
+        R"({"payload":{"message":"INTERNAL_SERVER_ERROR"},"type":"ERROR"})",
+    };
+    static_assert(std::size(ERROR_RESPONSES) == static_cast<size_t>(ErrorType::INTERNAL_SERVER_ERROR) + 1,
+                  "uma resposta por ErrorType");
+
+    /**
+     * Escape de cada byte: 0 = copia, 'u' = código de 4 dígitos hexadecimais,
+     * senão o caractere que vai após a barra
+     */
+    constexpr std::array<char, 256> ESCAPES = []
+    {
+        std::array<char, 256> table{};
+        for (int c = 0; c < 0x20; ++c)
+            table[c] = 'u';
+        table['\b'] = 'b';
+        table['\t'] = 't';
+        table['\n'] = 'n';
+        table['\f'] = 'f';
+        table['\r'] = 'r';
+        table['"'] = '"';
+        table['\\'] = '\\';
+        return table;
+    }();
+
+    std::string toBinary(const json& document, SocketUtils::Encoding encoding)
+    {
+        std::string out;
+        if (encoding == SocketUtils::Encoding::MSGPACK)
+            json::to_msgpack(document, out);
+        else
+            json::to_cbor(document, out);
+        return out;
+    }
+
+    bool isStructuredBinary(SocketUtils::Encoding encoding)
+    {
+        return encoding == SocketUtils::Encoding::MSGPACK || encoding == SocketUtils::Encoding::CBOR;
+    }
+
+    /**
+     * Escrita direta em MessagePack ou CBOR, com os mesmos bytes do
+     * to_msgpack/to_cbor (menor cabeçalho para cada tamanho ou valor). Os
+     * mapas recebem as chaves na ordem alfabética, como o dump() do JSON.
+     */
+    class BinaryWriter
+    {
+    public:
+        BinaryWriter(std::string& out, SocketUtils::Encoding encoding)
+            : out(out), msgpack(encoding == SocketUtils::Encoding::MSGPACK) {}
+
+        void map(size_t size)
+        {
+            if (msgpack)
+                msgpackHead(size, 0x80, 0xDE);
+            else
+                cborHead(0xA0, size);
+        }
+
+        void array(size_t size)
+        {
+            if (msgpack)
+                msgpackHead(size, 0x90, 0xDC);
+            else
+                cborHead(0x80, size);
+        }
+
+        void string(std::string_view value)
+        {
+            if (!msgpack)
+                cborHead(0x60, value.size());
+            else if (value.size() <= 31)
+                out.push_back(static_cast<char>(0xA0 | value.size()));
+            else if (value.size() <= 0xFF)
+            {
+                out.push_back(static_cast<char>(0xD9));
+                bigEndian(value.size(), 1);
+            }
+            else if (value.size() <= 0xFFFF)
+            {
+                out.push_back(static_cast<char>(0xDA));
+                bigEndian(value.size(), 2);
+            }
+            else
+            {
+                out.push_back(static_cast<char>(0xDB));
+                bigEndian(value.size(), 4);
+            }
+            out.append(value);
+        }
+
+        void integer(int64_t value)
+        {
+            if (!msgpack)
+            {
+                if (value >= 0)
+                    cborHead(0x00, static_cast<uint64_t>(value));
+                else
+                    cborHead(0x20, static_cast<uint64_t>(-(value + 1)));
+                return;
+            }
+
+            if (value >= 0)
+            {
+                auto magnitude = static_cast<uint64_t>(value);
+                if (magnitude < 0x80)
+                    out.push_back(static_cast<char>(magnitude));
+                else
+                    sized(magnitude, 0xCC);
+            }
+            else if (value >= -32)
+                out.push_back(static_cast<char>(value));
+            else
+                sized(static_cast<uint64_t>(value), 0xD0,
+                      value >= INT8_MIN ? 1 : value >= INT16_MIN ? 2 : value >= INT32_MIN ? 4 : 8);
+        }
+
+        void boolean(bool value)
+        {
+            if (msgpack)
+                out.push_back(static_cast<char>(value ? 0xC3 : 0xC2));
+            else
+                out.push_back(static_cast<char>(value ? 0xF5 : 0xF4));
+        }
+
+        /**
+         * Elemento já codificado (resposta de um item do BATCH)
+         */
+        void raw(std::string_view encoded) { out.append(encoded); }
+
+    private:
+        std::string& out;
+        bool msgpack;
+
+        void bigEndian(uint64_t value, int bytes)
+        {
+            for (int shift = 8 * (bytes - 1); shift >= 0; shift -= 8)
+                out.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+
+        /**
+         * Marcador 'base' + 0..3 conforme a largura (1, 2, 4 ou 8 bytes)
+         */
+        void sized(uint64_t value, uint8_t base, int bytes = 0)
+        {
+            if (bytes == 0)
+                bytes = value <= 0xFF ? 1 : value <= 0xFFFF ? 2 : value <= 0xFFFFFFFF ? 4 : 8;
+            int step = bytes == 1 ? 0 : bytes == 2 ? 1 : bytes == 4 ? 2 : 3;
+            out.push_back(static_cast<char>(base + step));
+            bigEndian(value, bytes);
+        }
+
+        void msgpackHead(size_t size, uint8_t fix, uint8_t base16)
+        {
+            if (size <= 15)
+                out.push_back(static_cast<char>(fix | size));
+            else if (size <= 0xFFFF)
+            {
+                out.push_back(static_cast<char>(base16));
+                bigEndian(size, 2);
+            }
+            else
+            {
+                out.push_back(static_cast<char>(base16 + 1));
+                bigEndian(size, 4);
+            }
+        }
+
+        void cborHead(uint8_t major, uint64_t value)
+        {
+            if (value <= 0x17)
+                out.push_back(static_cast<char>(major | value));
+            else
+                sized(value, major | 0x18);
+        }
+    };
+
+    /**
+     * Respostas constantes e finais de documento já em MessagePack/CBOR
+     */
+    struct BinaryResponses
+    {
+        std::string ok;
+        std::array<std::string, std::size(ERROR_RESPONSES)> errors;
+
+        // "type" é a última chave do mapa externo: o documento termina no nome do tipo
+        std::array<std::string, MESSAGE_TYPE_COUNT> typeTails;
+    };
+
+    template <SocketUtils::Encoding ENCODING>
+    const BinaryResponses& binaryResponses()
+    {
+        static const BinaryResponses responses = []
+        {
+            BinaryResponses built;
+            built.ok = toBinary(buildOkResponse(), ENCODING);
+            for (size_t code = 0; code < built.errors.size(); ++code)
+                built.errors[code] = toBinary(buildErrorResponse(static_cast<ErrorType>(code)), ENCODING);
+            for (size_t code = 0; code < MESSAGE_TYPE_COUNT; ++code)
+            {
+                BinaryWriter tail(built.typeTails[code], ENCODING);
+                tail.string("type");
+                tail.string(MESSAGES[code].name);
+            }
+            return built;
+        }();
+        return responses;
+    }
+
+    const BinaryResponses& binaryResponses(SocketUtils::Encoding encoding)
+    {
+        return encoding == SocketUtils::Encoding::MSGPACK ? binaryResponses<SocketUtils::Encoding::MSGPACK>()
+                                                          : binaryResponses<SocketUtils::Encoding::CBOR>();
+    }
+
+    void appendInteger(std::string& out, long long value)
+    {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, result.ptr);
+    }
+}
+
+std::string_view errorResponse(ErrorType error)
+{
+    return ERROR_RESPONSES[static_cast<size_t>(error)];
+}
+
+void appendJsonString(std::string& out, std::string_view value)
+{
+    out.push_back('"');
+
+    // Copia os trechos sem escape de uma vez
+    size_t run = 0;
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        char escape = ESCAPES[static_cast<unsigned char>(value[i])];
+        if (!escape)
+            continue;
+
+        out.append(value.data() + run, i - run);
+        run = i + 1;
+        out.push_back('\\');
+        if (escape == 'u')
+        {
+            constexpr char HEX[] = "0123456789abcdef";
+            auto c = static_cast<unsigned char>(value[i]);
+            out.append("u00");
+            out.push_back(HEX[c >> 4]);
+            out.push_back(HEX[c & 0xF]);
+        }
+        else
+            out.push_back(escape);
+    }
+    out.append(value.data() + run, value.size() - run);
+
+    out.push_back('"');
+}
+
+std::string encodeLoginOk(std::string_view nickname)
+{
+    std::string out;
+    out.reserve(nickname.size() + 48);
+    out.append(R"({"payload":{"nickname":)");
+    appendJsonString(out, nickname);
+    out.append(R"(},"type":"LOGIN_OK"})");
+    return out;
+}
+
+std::string encodeDeliverMessage(std::string_view from, std::string_view text, time_t timestamp)
+{
+    std::string out;
+    out.reserve(from.size() + text.size() + 80);
+    out.append(R"({"from":)");
+    appendJsonString(out, from);
+    out.append(R"(,"payload":{"text":)");
+    appendJsonString(out, text);
+    out.append(R"(,"ts":)");
+    appendInteger(out, static_cast<long long>(timestamp));
+    out.append(R"(},"type":"DELIVER_MSG"})");
+    return out;
+}
+
+std::string encodeUsersList(const std::vector<UserInfo>& users)
+{
+    std::string out;
+    out.reserve(48 + users.size() * 64);
+    out.append(R"({"payload":{"users":[)");
+    for (size_t i = 0; i < users.size(); ++i)
+    {
+        if (i > 0)
+            out.push_back(',');
+        out.append(R"({"name":)");
+        appendJsonString(out, users[i].fullName);
+        out.append(R"(,"nick":)");
+        appendJsonString(out, users[i].nickname);
+        out.append(users[i].isOnline ? R"(,"online":true})" : R"(,"online":false})");
+    }
+    out.append(R"(]},"type":"USERS"})");
+    return out;
+}
+
+std::string_view okResponse(SocketUtils::Encoding encoding)
+{
+    if (encoding == SocketUtils::Encoding::COMPACT)
+        return compactOk();
+    return isStructuredBinary(encoding) ? std::string_view(binaryResponses(encoding).ok) : OK_RESPONSE;
+}
+
+std::string_view errorResponse(ErrorType error, SocketUtils::Encoding encoding)
+{
+    if (encoding == SocketUtils::Encoding::COMPACT)
+        return compactError(error);
+    if (!isStructuredBinary(encoding))
+        return errorResponse(error);
+    return binaryResponses(encoding).errors[static_cast<size_t>(error)];
+}
+
+std::string encodeLoginOk(std::string_view nickname, SocketUtils::Encoding encoding)
+{
+    if (encoding == SocketUtils::Encoding::COMPACT)
+        return encodeCompactLoginOk(nickname);
+    if (!isStructuredBinary(encoding))
+        return encodeLoginOk(nickname);
+
+    std::string out;
+    out.reserve(nickname.size() + 32);
+    BinaryWriter writer(out, encoding);
+    writer.map(2);
+    writer.string("payload");
+    writer.map(1);
+    writer.string("nickname");
+    writer.string(nickname);
+    writer.string("type");
+    writer.string("LOGIN_OK");
+    return out;
+}
+
+std::string encodeDeliverMessage(std::string_view from, std::string_view text, time_t timestamp,
+                                 SocketUtils::Encoding encoding)
+{
+    if (encoding == SocketUtils::Encoding::COMPACT)
+        return encodeCompactDeliver(from, text, static_cast<int64_t>(timestamp));
+    if (!isStructuredBinary(encoding))
+        return encodeDeliverMessage(from, text, timestamp);
+
+    std::string out;
+    out.reserve(from.size() + text.size() + 48);
+    BinaryWriter writer(out, encoding);
+    writer.map(3);
+    writer.string("from");
+    writer.string(from);
+    writer.string("payload");
+    writer.map(2);
+    writer.string("text");
+    writer.string(text);
+    writer.string("ts");
+    writer.integer(static_cast<int64_t>(timestamp));
+    writer.string("type");
+    writer.string("DELIVER_MSG");
+    return out;
+}
+
+std::string encodeUsersList(const std::vector<UserInfo>& users, SocketUtils::Encoding encoding)
+{
+    if (encoding == SocketUtils::Encoding::COMPACT)
+        return encodeCompactUsers(users);
+    if (!isStructuredBinary(encoding))
+        return encodeUsersList(users);
+
+    std::string out;
+    out.reserve(32 + users.size() * 48);
+    BinaryWriter writer(out, encoding);
+    writer.map(2);
+    writer.string("payload");
+    writer.map(1);
+    writer.string("users");
+    writer.array(users.size());
+    for (const UserInfo& user : users)
+    {
+        writer.map(3);
+        writer.string("name");
+        writer.string(user.fullName);
+        writer.string("nick");
+        writer.string(user.nickname);
+        writer.string("online");
+        writer.boolean(user.isOnline);
+    }
+    writer.string("type");
+    writer.string("USERS");
+    return out;
+}
+
+std::string encodeHelloOk(std::string_view framing, std::string_view encoding, std::string_view compression)
+{
+    std::string out;
+    out.reserve(framing.size() + encoding.size() + compression.size() + 80);
+    out.append(R"({"payload":{"compression":)");
+    appendJsonString(out, compression);
+    out.append(R"(,"encoding":)");
+    appendJsonString(out, encoding);
+    out.append(R"(,"framing":)");
+    appendJsonString(out, framing);
+    out.append(R"(},"type":"HELLO_OK"})");
+    return out;
+}
+
+std::string encodeBatchOk(const std::vector<std::string>& responses)
+{
+    size_t size = 48;
+    for (const auto& response : responses)
+        size += response.size() + 1;
+
+    std::string out;
+    out.reserve(size);
+    out.append(R"({"payload":{"responses":[)");
+    for (size_t i = 0; i < responses.size(); ++i)
+    {
+        if (i > 0)
+            out.push_back(',');
+        out.append(responses[i]);
+    }
+    out.append(R"(]},"type":"BATCH_OK"})");
+    return out;
+}
+
+std::string encodeBatchOk(const std::vector<std::string>& responses, SocketUtils::Encoding encoding)
+{
+    if (encoding == SocketUtils::Encoding::COMPACT)
+        return encodeCompactBatchOk(responses);
+    if (!isStructuredBinary(encoding))
+        return encodeBatchOk(responses);
+
+    size_t size = 40;
+    for (const auto& response : responses)
+        size += response.size();
+
+    std::string out;
+    out.reserve(size);
+    BinaryWriter writer(out, encoding);
+    writer.map(2);
+    writer.string("payload");
+    writer.map(1);
+    writer.string("responses");
+    writer.array(responses.size());
+    for (const auto& response : responses)
+        writer.raw(response);
+    writer.string("type");
+    writer.string("BATCH_OK");
+    return out;
+}
+
 // ==================== PARSING SEGURO ====================
 
 MessageType parseMessageType(const json& j)
 {
     if (!j.contains("type") || !j["type"].is_string())
         throw ParseException("Campo 'type' ausente ou inválido");
-    return stringToMessageType(j["type"].get<std::string>());
+    return stringToMessageType(j["type"].get_ref<const std::string&>());
 }
 
 std::string parseNickname(const json& j)
@@ -267,4 +767,124 @@ std::string parseRecipient(const json& j)
     return to;
 }
 
-} // namespace Protocol
\ No newline at end of file
+std::vector<json> parseBatchResponses(const json& j)
+{
+    if (!j.contains("payload") || !j["payload"].contains("responses") || !j["payload"]["responses"].is_array())
+        throw ParseException("Campo 'responses' ausente ou inválido");
+
+    std::vector<json> responses;
+    for (const auto& response : j["payload"]["responses"])
+    {
+        if (!response.is_object())
+            throw ParseException("Resposta do BATCH inválida");
+        responses.push_back(response);
+    }
+    return responses;
+}
+
+std::optional<HelloRequest> parseHello(std::string_view frame)
+{
+    // Filtro barato: só um HELLO contém a string "HELLO" entre aspas
+    if (frame.find("\"HELLO\"") == std::string_view::npos)
+        return std::nullopt;
+
+    json request = json::parse(frame, nullptr, false);
+    if (request.is_discarded() || !request.is_object())
+        return std::nullopt;
+
+    if (!request.contains("type") || request["type"] != "HELLO")
+        return std::nullopt;
+
+    HelloRequest hello{"line", "json", "none"};
+    auto payload = request.find("payload");
+    if (payload == request.end() || !payload->is_object())
+        return hello;
+
+    auto framing = payload->find("framing");
+    if (framing != payload->end() && framing->is_string())
+        hello.framing = framing->get<std::string>();
+
+    auto encoding = payload->find("encoding");
+    if (encoding != payload->end() && encoding->is_string())
+        hello.encoding = encoding->get<std::string>();
+
+    auto compression = payload->find("compression");
+    if (compression != payload->end() && compression->is_string())
+        hello.compression = compression->get<std::string>();
+    return hello;
+}
+
+// ==================== CODIFICAÇÃO BINÁRIA ====================
+
+SocketUtils::Encoding detectEncoding(std::string_view document)
+{
+    if (document.empty())
+        return SocketUtils::Encoding::JSON;
+
+    auto first = static_cast<unsigned char>(document.front());
+    if (first == COMPACT_VERSION)
+        return SocketUtils::Encoding::COMPACT;
+    if ((first >= 0x80 && first <= 0x8F) || first == 0xDE || first == 0xDF)
+        return SocketUtils::Encoding::MSGPACK;
+    if (first >= 0xA0 && first <= 0xBF)
+        return SocketUtils::Encoding::CBOR;
+    return SocketUtils::Encoding::JSON;
+}
+
+json parseWire(std::string_view document, SocketUtils::Encoding encoding)
+{
+    switch (encoding)
+    {
+        case SocketUtils::Encoding::MSGPACK: return json::from_msgpack(document.begin(), document.end());
+        case SocketUtils::Encoding::CBOR: return json::from_cbor(document.begin(), document.end());
+        case SocketUtils::Encoding::COMPACT: return decodeCompact(document);
+        default: return json::parse(document);
+    }
+}
+
+std::string toWire(std::string_view json_text, SocketUtils::Encoding encoding)
+{
+    if (encoding == SocketUtils::Encoding::JSON)
+        return std::string(json_text);
+    if (encoding == SocketUtils::Encoding::COMPACT)
+        return transcodeToCompact(json_text);
+
+    // Respostas constantes (OK e erros): codificadas uma vez a partir dos
+    // builders, sem parse por mensagem. As demais passam pelo DOM.
+    const BinaryResponses& constants = binaryResponses(encoding);
+    if (json_text == OK_RESPONSE)
+        return constants.ok;
+    if (peekMessageType(json_text) == MessageType::ERROR_MSG)
+    {
+        for (size_t code = 0; code < std::size(ERROR_RESPONSES); ++code)
+            if (json_text == ERROR_RESPONSES[code])
+                return constants.errors[code];
+    }
+
+    return toBinary(json::parse(json_text), encoding);
+}
+
+MessageType peekMessageType(std::string_view payload, SocketUtils::Encoding encoding)
+{
+    if (encoding == SocketUtils::Encoding::JSON)
+        return peekMessageType(payload);
+
+    if (encoding == SocketUtils::Encoding::COMPACT)
+    {
+        const MessageDescriptor* message =
+            isCompact(payload) && payload.size() > 1 ? messageDescriptor(static_cast<uint8_t>(payload[1])) : nullptr;
+        return message ? message->type : MessageType::UNKNOWN;
+    }
+
+    const BinaryResponses& constants = binaryResponses(encoding);
+    for (size_t code = 0; code < MESSAGE_TYPE_COUNT; ++code)
+    {
+        const std::string& tail = constants.typeTails[code];
+        if (!tail.empty() && payload.size() >= tail.size() &&
+            payload.compare(payload.size() - tail.size(), tail.size(), tail) == 0)
+            return static_cast<MessageType>(code);
+    }
+    return MessageType::UNKNOWN;
+}
+
+} // namespace Protocol
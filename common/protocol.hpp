@@ -1,7 +1,11 @@
 #pragma once
 
+#include "socket_utils.hpp"
 #include <nlohmann/json.hpp>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 /**
  * Módulo Protocol
@@ -14,7 +18,8 @@ namespace Protocol
 {
 
 /**
- * Tipos de mensagens do protocolo
+ * Tipos de mensagens do protocolo. Os valores são os códigos do fio
+ * (cabeçalho do framing LENGTH e protocolo compacto): só acrescentar no fim.
  */
 enum class MessageType
 {
@@ -25,6 +30,7 @@ enum class MessageType
     SEND_MSG,       // Envio de mensagem direta
     LIST_USERS,     // Solicitação da lista de usuários
     DELETE_USER,    // Remoção de conta
+    HELLO,          // Negociação de framing e codificação (primeiro frame da conexão)
     
     // Respostas do servidor
     OK,             // Confirmação genérica de sucesso
@@ -32,12 +38,17 @@ enum class MessageType
     ERROR_MSG,      // Mensagem de erro
     DELIVER_MSG,    // Entrega de mensagem recebida
     USERS,          // Lista de usuários ativos/cadastrados
+    HELLO_OK,       // Framing e codificação aceitos (valem após esta resposta)
+
+    // Envelope de várias requisições num frame (acrescentado depois: códigos no fim)
+    BATCH,          // Lista de requisições, executadas em ordem
+    BATCH_OK,       // Lista das respostas, na ordem das requisições
     
     UNKNOWN         // Tipo desconhecido ou inválido
 };
 
 /**
- * Tipos de erro possíveis
+ * Tipos de erro possíveis (os valores são os códigos do protocolo compacto)
  */
 enum class ErrorType
 {
@@ -56,6 +67,7 @@ constexpr size_t MAX_NICKNAME_LENGTH = 32;
 constexpr size_t MAX_FULLNAME_LENGTH = 128;
 constexpr size_t MAX_MESSAGE_LENGTH = 4096;
 constexpr size_t MAX_JSON_SIZE = 8192;
+constexpr size_t MAX_BATCH_SIZE = 256;      // Requisições por BATCH
 
 /**
  * Estrutura de informações de um usuário
@@ -68,16 +80,30 @@ struct UserInfo
 };
 
 // ==================== VALIDAÇÃO ====================
-bool isValidNickname(const std::string& nick);
-bool isValidFullName(const std::string& name);
-bool isValidMessage(const std::string& msg);
+// Núcleos SIMD com despacho pela CPU (text_validation.hpp). Nome completo e
+// texto da mensagem também precisam ser UTF-8 válido.
+bool isValidNickname(std::string_view nick);
+bool isValidFullName(std::string_view name);
+bool isValidMessage(std::string_view msg);
+
+/**
+ * UTF-8 válido (RFC 3629: sem formas longas, sem surrogates, até U+10FFFF)
+ */
+bool isValidUtf8(std::string_view text);
 
 // ==================== CONVERSÃO DE TIPOS ====================
-MessageType stringToMessageType(const std::string& type);
+MessageType stringToMessageType(std::string_view type);
 std::string messageTypeToString(MessageType type);
 ErrorType stringToErrorType(const std::string& error);
 std::string errorTypeToString(ErrorType error);
 
+/**
+ * Tipo de uma mensagem já serializada, sem parse: procura a chave "type" a
+ * partir do fim (o dump ordena as chaves e "type" é a última do objeto).
+ * Usado no cabeçalho do framing LENGTH.
+ */
+MessageType peekMessageType(std::string_view json);
+
 // ==================== BUILDERS - REQUISIÇÕES (Cliente -> Servidor) ====================
 nlohmann::json buildRegisterRequest(const std::string& nickname, const std::string& fullName);
 nlohmann::json buildLoginRequest(const std::string& nickname);
@@ -85,6 +111,13 @@ nlohmann::json buildLogoutRequest();
 nlohmann::json buildSendMessageRequest(const std::string& to, const std::string& text);
 nlohmann::json buildListUsersRequest();
 nlohmann::json buildDeleteUserRequest(const std::string& nickname);
+nlohmann::json buildHelloRequest(const std::string& framing, const std::string& encoding = "json",
+                                  const std::string& compression = "none");
+
+/**
+ * Envelope BATCH com as requisições dadas (documentos dos builders acima)
+ */
+nlohmann::json buildBatchRequest(const std::vector<nlohmann::json>& requests);
 
 // ==================== BUILDERS - RESPOSTAS (Servidor -> Cliente) ====================
 nlohmann::json buildOkResponse();
@@ -92,6 +125,53 @@ nlohmann::json buildLoginOkResponse(const std::string& nickname);
 nlohmann::json buildErrorResponse(ErrorType error);
 nlohmann::json buildDeliverMessage(const std::string& from, const std::string& text, time_t timestamp);
 nlohmann::json buildUsersListResponse(const std::vector<UserInfo>& users);
+nlohmann::json buildHelloOkResponse(const std::string& framing, const std::string& encoding,
+                                    const std::string& compression = "none");
+nlohmann::json buildBatchOkResponse(const std::vector<nlohmann::json>& responses);
+
+// ==================== RESPOSTAS SERIALIZADAS (Servidor -> Cliente) ====================
+// Os mesmos bytes do dump() dos builders acima (chaves em ordem alfabética,
+// sem espaços), sem montar o DOM: as respostas constantes ficam prontas em
+// tempo de compilação e as demais são escritas direto numa string.
+
+constexpr std::string_view OK_RESPONSE = R"({"type":"OK"})";
+std::string_view errorResponse(ErrorType error);
+
+std::string encodeLoginOk(std::string_view nickname);
+std::string encodeDeliverMessage(std::string_view from, std::string_view text, time_t timestamp);
+std::string encodeUsersList(const std::vector<UserInfo>& users);
+std::string encodeHelloOk(std::string_view framing, std::string_view encoding,
+                          std::string_view compression = "none");
+
+/**
+ * BATCH_OK com as respostas já serializadas (entram no array sem cópia do DOM)
+ */
+std::string encodeBatchOk(const std::vector<std::string>& responses);
+
+// ==================== RESPOSTAS NA CODIFICAÇÃO DA CONEXÃO ====================
+// As mesmas mensagens escritas direto na codificação negociada, a partir dos
+// campos: em MessagePack/CBOR saem os bytes do to_msgpack()/to_cbor() do
+// documento dos builders; no compacto, os do encodeCompact (compact_codec);
+// em JSON, o JSON acima. A fila de saída envia como estão as mensagens que
+// já chegam na codificação dela.
+
+std::string_view okResponse(SocketUtils::Encoding encoding);
+std::string_view errorResponse(ErrorType error, SocketUtils::Encoding encoding);
+std::string encodeLoginOk(std::string_view nickname, SocketUtils::Encoding encoding);
+std::string encodeDeliverMessage(std::string_view from, std::string_view text, time_t timestamp,
+                                 SocketUtils::Encoding encoding);
+std::string encodeUsersList(const std::vector<UserInfo>& users, SocketUtils::Encoding encoding);
+
+/**
+ * BATCH_OK com as respostas já na mesma codificação (entram sem conversão)
+ */
+std::string encodeBatchOk(const std::vector<std::string>& responses, SocketUtils::Encoding encoding);
+
+/**
+ * Acrescenta 'value' como string JSON (entre aspas), com os escapes do dump():
+ * aspas, barra invertida e caracteres de controle; UTF-8 passa intacto.
+ */
+void appendJsonString(std::string& out, std::string_view value);
 
 // ==================== PARSING SEGURO ====================
 class ParseException : public std::runtime_error
@@ -106,4 +186,58 @@ std::string parseFullName(const nlohmann::json& j);
 std::string parseMessageText(const nlohmann::json& j);
 std::string parseRecipient(const nlohmann::json& j);
 
+/**
+ * Respostas de um BATCH_OK, na ordem das requisições do BATCH.
+ * @throws ParseException se falta "responses" ou ele não é uma lista de objetos
+ */
+std::vector<nlohmann::json> parseBatchResponses(const nlohmann::json& j);
+
+/**
+ * Pedido de um HELLO (campos ausentes: "line", "json" e "none")
+ */
+struct HelloRequest
+{
+    std::string framing;
+    std::string encoding;
+    std::string compression;
+};
+
+/**
+ * Pedido do HELLO, ou nullopt se o frame não é um HELLO. Frames comuns são
+ * descartados sem parse.
+ */
+std::optional<HelloRequest> parseHello(std::string_view frame);
+
+// ==================== CODIFICAÇÃO BINÁRIA ====================
+
+/**
+ * Codificação de um documento pelo primeiro byte: a versão do protocolo
+ * compacto (0x02), um mapa MessagePack (0x80-0x8f, 0xde, 0xdf) ou CBOR
+ * (0xa0-0xbf); qualquer outro é JSON texto (que começa por '{' ou espaço).
+ * As faixas não se sobrepõem.
+ */
+SocketUtils::Encoding detectEncoding(std::string_view document);
+
+/**
+ * DOM de um documento na codificação dada.
+ * @throws nlohmann::json::parse_error se o documento é inválido
+ * @throws ParseException se o documento compacto é inválido
+ */
+nlohmann::json parseWire(std::string_view document, SocketUtils::Encoding encoding);
+
+/**
+ * Converte uma mensagem JSON texto para a codificação dada (JSON: cópia).
+ * Só as mensagens guardadas em JSON (fila offline) passam por aqui; as
+ * respostas constantes (OK e erros) saem prontas, sem parse.
+ * @throws nlohmann::json::parse_error se 'json_text' não é JSON válido
+ */
+std::string toWire(std::string_view json_text, SocketUtils::Encoding encoding);
+
+/**
+ * Tipo de uma mensagem do servidor já na codificação dada, sem parse: no
+ * compacto é o segundo byte; em MessagePack/CBOR, o valor de "type", a
+ * última chave do documento (ordem do dump()).
+ */
+MessageType peekMessageType(std::string_view payload, SocketUtils::Encoding encoding);
+
 } // namespace Protocol
\ No newline at end of file
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "protocol.hpp"
+#include "request_parser.hpp"
+#include "socket_utils.hpp"
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Registro do protocolo
+ * ---------------------
+ * Tabela única, em tempo de compilação, dos tipos de mensagem: nome no JSON,
+ * sentido (requisição ou resposta) e campos do payload de cada requisição,
+ * com os limites e validações de cada campo. Dela saem:
+ *
+ *   - lookupMessageType: hash perfeito nome -> MessageType (uma comparação
+ *     de string por consulta, em vez da cadeia de ifs)
+ *   - messageName: MessageType -> nome, por índice
+ *   - os campos (e a ordem deles) que o parser JSON, o protocolo compacto e
+ *     o CommandHandler (tabela de despacho) usam para cada requisição
+ *
+ * Tipo novo: um valor no fim de MessageType e uma linha em MESSAGES; os
+ * static_asserts apontam o que faltar.
+ */
+
+namespace Protocol
+{
+
+/**
+ * Campos string do payload das requisições
+ */
+enum class Field : uint8_t
+{
+    NICKNAME,
+    FULLNAME,
+    TO,
+    TEXT
+};
+
+struct FieldDescriptor
+{
+    Field field;
+    std::string_view key;               // Chave no payload JSON
+    RequestField Request::* member;     // Onde o parser guarda o valor
+    size_t maxLength;
+    bool (*validate)(std::string_view); // Regra completa do campo (inclui o limite)
+    const char* invalidMessage;         // Texto da ParseException
+};
+
+inline constexpr FieldDescriptor FIELDS[] = {
+    {Field::NICKNAME, "nickname", &Request::nickname, MAX_NICKNAME_LENGTH, isValidNickname, "Apelido inválido"},
+    {Field::FULLNAME, "fullname", &Request::fullname, MAX_FULLNAME_LENGTH, isValidFullName, "Nome completo inválido"},
+    {Field::TO,       "to",       &Request::to,       MAX_NICKNAME_LENGTH, isValidNickname, "Destinatário inválido"},
+    {Field::TEXT,     "text",     &Request::text,     MAX_MESSAGE_LENGTH,  isValidMessage,  "Mensagem inválida ou muito longa"},
+};
+
+constexpr const FieldDescriptor& fieldDescriptor(Field field)
+{
+    return FIELDS[static_cast<size_t>(field)];
+}
+
+enum class Direction : uint8_t
+{
+    REQUEST,    // Cliente -> servidor (despachada pelo CommandHandler)
+    RESPONSE    // Servidor -> cliente
+};
+
+constexpr size_t MAX_REQUEST_FIELDS = 2;
+
+struct MessageDescriptor
+{
+    MessageType type;
+    std::string_view name;
+    Direction direction;
+    uint8_t fieldCount;
+    std::array<Field, MAX_REQUEST_FIELDS> fields;   // Na ordem do protocolo compacto
+
+    constexpr bool isRequest() const { return direction == Direction::REQUEST; }
+};
+
+// Na ordem de MessageType (o índice é o código do fio)
+inline constexpr MessageDescriptor MESSAGES[] = {
+    {MessageType::REGISTER,    "REGISTER",    Direction::REQUEST,  2, {Field::NICKNAME, Field::FULLNAME}},
+    {MessageType::LOGIN,       "LOGIN",       Direction::REQUEST,  1, {Field::NICKNAME}},
+    {MessageType::LOGOUT,      "LOGOUT",      Direction::REQUEST,  0, {}},
+    {MessageType::SEND_MSG,    "SEND_MSG",    Direction::REQUEST,  2, {Field::TO, Field::TEXT}},
+    {MessageType::LIST_USERS,  "LIST_USERS",  Direction::REQUEST,  0, {}},
+    {MessageType::DELETE_USER, "DELETE_USER", Direction::REQUEST,  1, {Field::NICKNAME}},
+    {MessageType::HELLO,       "HELLO",       Direction::REQUEST,  0, {}},
+    {MessageType::OK,          "OK",          Direction::RESPONSE, 0, {}},
+    {MessageType::LOGIN_OK,    "LOGIN_OK",    Direction::RESPONSE, 0, {}},
+    {MessageType::ERROR_MSG,   "ERROR",       Direction::RESPONSE, 0, {}},
+    {MessageType::DELIVER_MSG, "DELIVER_MSG", Direction::RESPONSE, 0, {}},
+    {MessageType::USERS,       "USERS",       Direction::RESPONSE, 0, {}},
+    {MessageType::HELLO_OK,    "HELLO_OK",    Direction::RESPONSE, 0, {}},
+    {MessageType::BATCH,       "BATCH",       Direction::REQUEST,  0, {}},  // Payload: lista de requisições
+    {MessageType::BATCH_OK,    "BATCH_OK",    Direction::RESPONSE, 0, {}},
+};
+
+constexpr size_t MESSAGE_TYPE_COUNT = std::size(MESSAGES);
+
+static_assert(MESSAGE_TYPE_COUNT == static_cast<size_t>(MessageType::UNKNOWN),
+              "uma linha de MESSAGES por MessageType");
+static_assert([]
+{
+    for (size_t i = 0; i < MESSAGE_TYPE_COUNT; ++i)
+        if (static_cast<size_t>(MESSAGES[i].type) != i)
+            return false;
+    return true;
+}(), "MESSAGES fora da ordem de MessageType");
+static_assert([]
+{
+    for (size_t i = 0; i < std::size(FIELDS); ++i)
+        if (static_cast<size_t>(FIELDS[i].field) != i)
+            return false;
+    return true;
+}(), "FIELDS fora da ordem de Field");
+static_assert(MESSAGE_TYPE_COUNT <= SocketUtils::COMPRESSED_FRAME_FLAG,
+              "o código do tipo não pode usar o bit de compressão do cabeçalho");
+
+/**
+ * Descritor de um tipo válido (não UNKNOWN)
+ */
+constexpr const MessageDescriptor& messageDescriptor(MessageType type)
+{
+    return MESSAGES[static_cast<size_t>(type)];
+}
+
+/**
+ * Descritor de um código do fio, ou nullptr se o código não existe
+ */
+constexpr const MessageDescriptor* messageDescriptor(uint8_t code)
+{
+    return code < MESSAGE_TYPE_COUNT ? &MESSAGES[code] : nullptr;
+}
+
+constexpr std::string_view messageName(MessageType type)
+{
+    return static_cast<size_t>(type) < MESSAGE_TYPE_COUNT ? messageDescriptor(type).name : "UNKNOWN";
+}
+
+// ==================== HASH PERFEITO ====================
+
+namespace registry_detail
+{
+    constexpr size_t TYPE_TABLE_SIZE = 32;
+    static_assert(TYPE_TABLE_SIZE >= MESSAGE_TYPE_COUNT && (TYPE_TABLE_SIZE & (TYPE_TABLE_SIZE - 1)) == 0);
+
+    // FNV-1a com semente (achada em tempo de compilação sem colisões entre os nomes)
+    constexpr uint32_t hash(std::string_view name, uint32_t seed)
+    {
+        uint32_t h = 2166136261u ^ seed;
+        for (char c : name)
+        {
+            h ^= static_cast<unsigned char>(c);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    constexpr bool collisionFree(uint32_t seed)
+    {
+        bool used[TYPE_TABLE_SIZE] = {};
+        for (const auto& message : MESSAGES)
+        {
+            size_t slot = hash(message.name, seed) & (TYPE_TABLE_SIZE - 1);
+            if (used[slot])
+                return false;
+            used[slot] = true;
+        }
+        return true;
+    }
+
+    constexpr uint32_t findSeed()
+    {
+        for (uint32_t seed = 0; seed < 100000; ++seed)
+            if (collisionFree(seed))
+                return seed;
+        return UINT32_MAX;
+    }
+
+    constexpr uint32_t SEED = findSeed();
+    static_assert(SEED != UINT32_MAX, "nenhuma semente sem colisões: aumentar TYPE_TABLE_SIZE");
+
+    // Posição -> código + 1 (0 = vazio)
+    constexpr std::array<uint8_t, TYPE_TABLE_SIZE> TYPE_TABLE = []
+    {
+        std::array<uint8_t, TYPE_TABLE_SIZE> table{};
+        for (size_t i = 0; i < MESSAGE_TYPE_COUNT; ++i)
+            table[hash(MESSAGES[i].name, SEED) & (TYPE_TABLE_SIZE - 1)] = static_cast<uint8_t>(i + 1);
+        return table;
+    }();
+}
+
+/**
+ * Nome do JSON -> MessageType (UNKNOWN se não é um tipo do protocolo)
+ */
+constexpr MessageType lookupMessageType(std::string_view name)
+{
+    using namespace registry_detail;
+    uint8_t entry = TYPE_TABLE[hash(name, SEED) & (TYPE_TABLE_SIZE - 1)];
+    if (entry == 0 || MESSAGES[entry - 1].name != name)
+        return MessageType::UNKNOWN;
+    return MESSAGES[entry - 1].type;
+}
+
+static_assert([]
+{
+    for (const auto& message : MESSAGES)
+        if (lookupMessageType(message.name) != message.type)
+            return false;
+    return lookupMessageType("") == MessageType::UNKNOWN && lookupMessageType("ERROR_MSG") == MessageType::UNKNOWN;
+}(), "hash perfeito inconsistente");
+
+/**
+ * Campo de requisição pela chave do payload, ou nullptr se não é um campo
+ * do protocolo
+ */
+constexpr const FieldDescriptor* lookupField(std::string_view key)
+{
+    for (const auto& field : FIELDS)
+        if (field.key == key)
+            return &field;
+    return nullptr;
+}
+
+} // namespace Protocol
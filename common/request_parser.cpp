@@ -0,0 +1,289 @@
+#include "request_parser.hpp"
+#include "compact_codec.hpp"
+#include "protocol_registry.hpp"
+#include <string>
+
+using json = nlohmann::json;
+
+namespace Protocol
+{
+
+namespace
+{
+    /**
+     * Cursor sobre o frame. Só reconhece o subconjunto do JSON usado pelas
+     * requisições; qualquer outra coisa faz o parse rápido desistir.
+     */
+    class Scanner
+    {
+    public:
+        explicit Scanner(std::string_view text) : pos(text.data()), end(text.data() + text.size()) {}
+
+        bool consume(char c)
+        {
+            skipSpace();
+            if (pos == end || *pos != c)
+                return false;
+            ++pos;
+            return true;
+        }
+
+        bool atEnd()
+        {
+            skipSpace();
+            return pos == end;
+        }
+
+        /**
+         * String sem escapes, com UTF-8 válido e sem caracteres de controle
+         * (as mesmas regras do json::parse para o conteúdo literal).
+         */
+        bool string(std::string_view& out)
+        {
+            if (!consume('"'))
+                return false;
+
+            // Bytes de continuação UTF-8 nunca valem '"': acha o fim e valida depois
+            const char* start = pos;
+            bool ascii = true;
+            while (pos < end)
+            {
+                auto c = static_cast<unsigned char>(*pos);
+                if (c == '"')
+                {
+                    out = std::string_view(start, static_cast<size_t>(pos - start));
+                    ++pos;
+                    return ascii || isValidUtf8(out);
+                }
+                if (c == '\\' || c < 0x20)
+                    return false;
+                ascii &= c < 0x80;
+                ++pos;
+            }
+            return false;
+        }
+
+    private:
+        const char* pos;
+        const char* end;
+
+        void skipSpace()
+        {
+            while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r'))
+                ++pos;
+        }
+    };
+
+    bool parseObject(Scanner& in, Request& request, bool nested);
+
+    /**
+     * "requests" do BATCH: itens no formato de uma requisição comum
+     */
+    bool parseBatch(Scanner& in, Request& request)
+    {
+        request.batch.clear();
+        if (!in.consume('['))
+            return false;
+        if (in.consume(']'))
+            return true;
+
+        do
+        {
+            // Acima do limite: o fallback responde com o erro
+            if (request.batch.size() == MAX_BATCH_SIZE || !parseObject(in, request.batch.emplace_back(), true))
+                return false;
+        } while (in.consume(','));
+
+        return in.consume(']');
+    }
+
+    bool parsePayload(Scanner& in, Request& request, bool nested)
+    {
+        if (!in.consume('{'))
+            return false;
+
+        // Payload repetido: vale o último, como no json::parse
+        request.nickname = request.fullname = request.to = request.text = RequestField{};
+        request.batch.clear();
+        if (in.consume('}'))
+            return true;
+
+        do
+        {
+            std::string_view key, value;
+            if (!in.string(key) || !in.consume(':'))
+                return false;
+
+            // Array só no envelope (BATCH aninhado fica para o fallback)
+            if (key == "requests" && !nested)
+            {
+                if (!parseBatch(in, request))
+                    return false;
+                continue;
+            }
+
+            if (!in.string(value))
+                return false;
+
+            if (const FieldDescriptor* field = lookupField(key))
+                request.*(field->member) = {value, RequestField::State::STRING};
+        } while (in.consume(','));
+
+        return in.consume('}');
+    }
+
+    bool parseObject(Scanner& in, Request& request, bool nested)
+    {
+        if (!in.consume('{'))
+            return false;
+
+        bool has_type = false;
+        if (in.consume('}'))
+            return false;
+
+        do
+        {
+            std::string_view key;
+            if (!in.string(key) || !in.consume(':'))
+                return false;
+
+            if (key == "payload")
+            {
+                if (!parsePayload(in, request, nested))
+                    return false;
+                continue;
+            }
+
+            std::string_view value;
+            if (!in.string(value))
+                return false;
+
+            if (key == "type")
+            {
+                request.type = lookupMessageType(value);
+                has_type = true;
+            }
+        } while (in.consume(','));
+
+        return in.consume('}') && has_type;
+    }
+
+    void extractField(const json& payload, std::string_view key, RequestField& field)
+    {
+        auto it = payload.find(key);
+        if (it == payload.end())
+            return;
+
+        if (it->is_string())
+            field = {it->get_ref<const std::string&>(), RequestField::State::STRING};
+        else
+            field.state = RequestField::State::NOT_STRING;
+    }
+
+    void extractFields(const json& message, Request& request)
+    {
+        auto payload = message.find("payload");
+        if (payload != message.end() && payload->is_object())
+        {
+            for (const auto& field : FIELDS)
+                extractField(*payload, field.key, request.*(field.member));
+        }
+    }
+
+    /**
+     * "requests" do BATCH no DOM: as views dos itens apontam para o documento
+     * do envelope. Itens sem "type" invalidam o envelope inteiro.
+     */
+    void extractBatch(const json& message, Request& request)
+    {
+        auto payload = message.find("payload");
+        if (payload == message.end() || !payload->is_object())
+            return;
+
+        auto requests = payload->find("requests");
+        if (requests == payload->end())
+            return;
+        if (!requests->is_array())
+            throw ParseException("Campo 'requests' inválido");
+        if (requests->size() > MAX_BATCH_SIZE)
+            throw ParseException("BATCH com mais de " + std::to_string(MAX_BATCH_SIZE) + " requisições");
+
+        request.batch.reserve(requests->size());
+        for (const json& item : *requests)
+        {
+            if (!item.is_object())
+                throw ParseException("Requisição do BATCH inválida");
+
+            Request& sub = request.batch.emplace_back();
+            sub.fallback = true;
+            sub.type = parseMessageType(item);
+            extractFields(item, sub);
+        }
+    }
+
+    std::string_view requireField(const Request& request, Field field)
+    {
+        const FieldDescriptor& descriptor = fieldDescriptor(field);
+        const RequestField& value = request.*(descriptor.member);
+        if (value.state == RequestField::State::ABSENT)
+            throw ParseException("Campo '" + std::string(descriptor.key) + "' ausente");
+        if (value.state == RequestField::State::NOT_STRING)
+            throw ParseException("Campo '" + std::string(descriptor.key) + "' inválido");
+        if (!descriptor.validate(value.value))
+            throw ParseException(descriptor.invalidMessage);
+        return value.value;
+    }
+}
+
+// ==================== PARSING ====================
+
+bool parseRequestFast(std::string_view frame, Request& request)
+{
+    Scanner in(frame);
+    return parseObject(in, request, false) && in.atEnd();
+}
+
+Request parseRequest(std::string_view frame)
+{
+    // Protocolo compacto: campos em ordem fixa, também sem alocar
+    if (isCompact(frame))
+        return parseCompactRequest(frame);
+
+    Request request;
+    if (parseRequestFast(frame, request))
+        return request;
+
+    // Fora do caminho comum (ou MessagePack/CBOR): DOM completo, com os erros de sempre
+    request = Request{};
+    request.fallback = true;
+    request.document = parseWire(frame, detectEncoding(frame));
+    request.type = parseMessageType(request.document);
+    extractFields(request.document, request);
+    if (request.type == MessageType::BATCH)
+        extractBatch(request.document, request);
+    return request;
+}
+
+// ==================== CAMPOS VALIDADOS ====================
+
+std::string_view parseNickname(const Request& request)
+{
+    return requireField(request, Field::NICKNAME);
+}
+
+std::string_view parseFullName(const Request& request)
+{
+    return requireField(request, Field::FULLNAME);
+}
+
+std::string_view parseMessageText(const Request& request)
+{
+    return requireField(request, Field::TEXT);
+}
+
+std::string_view parseRecipient(const Request& request)
+{
+    return requireField(request, Field::TO);
+}
+
+} // namespace Protocol
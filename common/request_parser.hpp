@@ -0,0 +1,92 @@
+#pragma once
+
+#include "protocol.hpp"
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string_view>
+#include <vector>
+
+/**
+ * Parser de requisições
+ * ---------------------
+ * Parser especializado nos formatos de requisição do protocolo
+ * (REGISTER, LOGIN, LOGOUT, SEND_MSG, LIST_USERS, DELETE_USER):
+ *
+ *   {"type":"...","payload":{"nickname":"...","fullname":"...","to":"...","text":"..."}}
+ *
+ * Uma única passada pelo frame localiza "type" e os campos do payload e
+ * devolve string_views para dentro do próprio frame, sem montar o DOM do
+ * nlohmann e sem alocar. As chaves podem vir em qualquer ordem e chaves
+ * desconhecidas com valor string são ignoradas.
+ *
+ * Qualquer coisa fora desse caminho comum (sequências de escape, valores que
+ * não são string, aninhamento extra, UTF-8 inválido, JSON malformado) cai no
+ * json::parse, com o mesmo resultado de antes: os erros de sintaxe continuam
+ * saindo como json::parse_error e os de protocolo como ParseException.
+ * O BATCH segue o mesmo caminho: "requests" é um array de requisições no
+ * formato acima (sem BATCH aninhado), cada uma interpretada para um Request
+ * com views para o mesmo frame.
+ *
+ * Frames MessagePack/CBOR (reconhecidos pelo primeiro byte, ver
+ * detectEncoding) seguem o mesmo caminho pelo decodificador binário; os do
+ * protocolo compacto vão para parseCompactRequest.
+ */
+
+namespace Protocol
+{
+
+/**
+ * Campo string do payload
+ */
+struct RequestField
+{
+    enum class State : uint8_t
+    {
+        ABSENT,     // Payload sem a chave
+        STRING,     // 'value' é o conteúdo (já sem escapes)
+        NOT_STRING  // Chave presente com valor de outro tipo (só no fallback)
+    };
+
+    std::string_view value;
+    State state = State::ABSENT;
+};
+
+/**
+ * Requisição já interpretada. As views apontam para o frame (caminho rápido)
+ * ou para 'document' (fallback) e valem enquanto ambos existirem.
+ */
+struct Request
+{
+    MessageType type = MessageType::UNKNOWN;
+    RequestField nickname;
+    RequestField fullname;
+    RequestField to;
+    RequestField text;
+    std::vector<Request> batch; // BATCH: as requisições do envelope, em ordem
+    bool fallback = false;      // Interpretada pelo json::parse
+    nlohmann::json document;    // Só preenchido no fallback (no BATCH, só no envelope)
+};
+
+/**
+ * Interpreta uma requisição do cliente.
+ * @throws nlohmann::json::parse_error se o frame não é JSON válido
+ * @throws ParseException se falta "type" ou ele não é string (ou o frame
+ *         compacto é malformado, ou o BATCH tem um item inválido ou mais de
+ *         MAX_BATCH_SIZE requisições)
+ */
+Request parseRequest(std::string_view frame);
+
+/**
+ * Caminho rápido isolado (sem fallback), exposto para o benchmark.
+ * @return false se o frame precisa do json::parse
+ */
+bool parseRequestFast(std::string_view frame, Request& request);
+
+// ==================== CAMPOS VALIDADOS ====================
+// Mesmas mensagens e regras das versões sobre nlohmann::json
+std::string_view parseNickname(const Request& request);
+std::string_view parseFullName(const Request& request);
+std::string_view parseMessageText(const Request& request);
+std::string_view parseRecipient(const Request& request);
+
+} // namespace Protocol
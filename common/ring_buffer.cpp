@@ -0,0 +1,202 @@
+#include "ring_buffer.hpp"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <utility>
+
+namespace
+{
+    struct RingCache
+    {
+        std::mutex mutex;
+        char* bases[RingBuffer::CACHED_RINGS];
+        size_t capacities[RingBuffer::CACHED_RINGS];
+        size_t count = 0;
+        std::atomic<uint64_t> mapped{0};
+        std::atomic<uint64_t> reused{0};
+    };
+
+    // Nunca destruída: anéis de objetos estáticos podem voltar até o fim
+    RingCache& ringCache()
+    {
+        static RingCache* instance = new RingCache;
+        return *instance;
+    }
+
+    /**
+     * Retira da cache um anel com exatamente 'size' bytes.
+     */
+    char* takeCached(size_t size)
+    {
+        RingCache& cache = ringCache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        for (size_t i = cache.count; i-- > 0;)
+        {
+            if (cache.capacities[i] != size)
+                continue;
+
+            char* base = cache.bases[i];
+            --cache.count;
+            cache.bases[i] = cache.bases[cache.count];
+            cache.capacities[i] = cache.capacities[cache.count];
+            cache.reused.fetch_add(1, std::memory_order_relaxed);
+            return base;
+        }
+        return nullptr;
+    }
+
+    /**
+     * Guarda o anel para reuso.
+     * @return false se a cache está cheia ou o anel é grande demais
+     */
+    bool putCached(char* base, size_t size)
+    {
+        if (size > RingBuffer::MAX_CACHED_CAPACITY)
+            return false;
+
+        RingCache& cache = ringCache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (cache.count == RingBuffer::CACHED_RINGS)
+            return false;
+
+        cache.bases[cache.count] = base;
+        cache.capacities[cache.count] = size;
+        ++cache.count;
+        return true;
+    }
+}
+
+// ==================== CONSTRUÇÃO/DESTRUIÇÃO ====================
+
+RingBuffer::~RingBuffer()
+{
+    release();
+}
+
+RingBuffer::RingBuffer(RingBuffer&& other) noexcept
+    : base(std::exchange(other.base, nullptr)), cap(std::exchange(other.cap, 0)),
+      head(std::exchange(other.head, 0)), count(std::exchange(other.count, 0)) {}
+
+RingBuffer& RingBuffer::operator=(RingBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        base = std::exchange(other.base, nullptr);
+        cap = std::exchange(other.cap, 0);
+        head = std::exchange(other.head, 0);
+        count = std::exchange(other.count, 0);
+    }
+    return *this;
+}
+
+// ==================== MAPEAMENTO ====================
+
+bool RingBuffer::allocate(size_t min_capacity)
+{
+    release();
+
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = (min_capacity + page - 1) / page * page;
+    if (size == 0)
+        size = page;
+
+    if (char* cached = takeCached(size))
+    {
+        base = cached;
+        cap = size;
+        head = count = 0;
+        return true;
+    }
+
+    int fd = memfd_create("chat-ring", MFD_CLOEXEC);
+    if (fd < 0)
+    {
+        std::cerr << "[RingBuffer] Erro em memfd_create: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(size)) < 0)
+    {
+        std::cerr << "[RingBuffer] Erro em ftruncate: " << strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+
+    // Reserva 2x o tamanho e sobrepõe as duas cópias do memfd
+    void* area = mmap(nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (area == MAP_FAILED)
+    {
+        std::cerr << "[RingBuffer] Erro ao reservar memória: " << strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+
+    char* first = static_cast<char*>(area);
+    bool mapped =
+        mmap(first, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED &&
+        mmap(first + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+    int saved_errno = errno;
+    close(fd);
+
+    if (!mapped)
+    {
+        std::cerr << "[RingBuffer] Erro ao espelhar o anel: " << strerror(saved_errno) << std::endl;
+        munmap(area, 2 * size);
+        return false;
+    }
+
+    base = first;
+    cap = size;
+    head = count = 0;
+    ringCache().mapped.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void RingBuffer::release()
+{
+    if (base && !putCached(base, cap))
+        munmap(base, 2 * cap);
+    base = nullptr;
+    cap = head = count = 0;
+}
+
+RingBuffer::CacheStats RingBuffer::cacheStats()
+{
+    RingCache& cache = ringCache();
+    CacheStats stats;
+    stats.mapped = cache.mapped.load(std::memory_order_relaxed);
+    stats.reused = cache.reused.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    stats.cached = cache.count;
+    return stats;
+}
+
+// ==================== LEITURA/ESCRITA ====================
+
+void RingBuffer::consume(size_t len)
+{
+    count -= len;
+    head += len;
+    if (head >= cap)
+        head -= cap;
+
+    // Vazio: recomeça do início (mantém as páginas mais usadas quentes)
+    if (count == 0)
+        head = 0;
+}
+
+bool RingBuffer::write(const char* data, size_t len)
+{
+    if (len > writable())
+        return false;
+
+    memcpy(writePtr(), data, len);
+    count += len;
+    return true;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Classe RingBuffer
+ * -----------------
+ * Buffer circular de capacidade fixa com espelhamento: as páginas de um
+ * memfd são mapeadas duas vezes, lado a lado, de modo que qualquer trecho de
+ * até capacity() bytes é contíguo na memória a partir de qualquer posição.
+ * Um frame que cruza o fim do anel continua sendo um único bloco para
+ * recv/memchr/string_view/send, sem cópia nem realocação.
+ *
+ * A capacidade é arredondada para múltiplo do tamanho de página. O memfd é
+ * fechado logo após o mapeamento: o anel não ocupa um descritor por conexão.
+ * Anéis liberados (até MAX_CACHED_CAPACITY) ficam numa cache global e são
+ * reaproveitados pelo próximo allocate() de mesma capacidade: abrir e fechar
+ * conexões não repete memfd_create/mmap.
+ *
+ * Não é thread-safe.
+ */
+class RingBuffer
+{
+public:
+    static constexpr size_t CACHED_RINGS = 64;
+    static constexpr size_t MAX_CACHED_CAPACITY = 256 * 1024;
+
+    /**
+     * Contadores da cache de anéis (para /metrics)
+     */
+    struct CacheStats
+    {
+        uint64_t mapped = 0;    // Anéis mapeados do zero
+        uint64_t reused = 0;    // Anéis retirados da cache
+        size_t cached = 0;      // Anéis parados na cache agora
+    };
+
+    RingBuffer() = default;
+    ~RingBuffer();
+
+    RingBuffer(RingBuffer&& other) noexcept;
+    RingBuffer& operator=(RingBuffer&& other) noexcept;
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    /**
+     * Mapeia um anel de pelo menos min_capacity bytes (descarta o anterior).
+     * @return false se o mapeamento falhar
+     */
+    bool allocate(size_t min_capacity);
+
+    /**
+     * Desfaz o mapeamento (ou devolve o anel à cache).
+     */
+    void release();
+
+    static CacheStats cacheStats();
+
+    bool allocated() const { return base != nullptr; }
+    size_t capacity() const { return cap; }
+
+    /**
+     * Bytes armazenados, contíguos a partir de readPtr().
+     */
+    const char* readPtr() const { return base + head; }
+    size_t readable() const { return count; }
+
+    /**
+     * Espaço livre, contíguo a partir de writePtr().
+     */
+    char* writePtr() const { return base + head + count; }
+    size_t writable() const { return cap - count; }
+
+    /**
+     * Confirma 'len' bytes escritos em writePtr().
+     */
+    void commit(size_t len) { count += len; }
+
+    /**
+     * Descarta 'len' bytes do início.
+     */
+    void consume(size_t len);
+
+    /**
+     * Copia 'len' bytes para o fim do anel.
+     * @return false se não houver espaço
+     */
+    bool write(const char* data, size_t len);
+
+    void clear() { head = count = 0; }
+
+private:
+    char* base = nullptr;   // Início da primeira cópia (a segunda segue em base + cap)
+    size_t cap = 0;
+    size_t head = 0;        // Posição do primeiro byte, sempre < cap
+    size_t count = 0;
+};
@@ -1,86 +1,211 @@
 #include "socket_utils.hpp"
+#include "frame_reader.hpp"
+#include "protocol.hpp"
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 
 namespace SocketUtils
 {
 
-bool sendMessage(int sockfd, const std::string& json_message)
+namespace
+{
+    /**
+     * Envia todo o conteúdo de iov (avança as entradas em envios parciais).
+     */
+    bool sendAll(int sockfd, iovec* iov, size_t count)
+    {
+        while (count > 0)
+        {
+            msghdr msg{};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = count;
+            ssize_t sent = sendmsg(sockfd, &msg, MSG_NOSIGNAL);
+
+            if (sent < 0)
+            {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    // Socket não-bloqueante: espera espaço
+                    pollfd pfd{sockfd, POLLOUT, 0};
+                    if (poll(&pfd, 1, SEND_TIMEOUT_MS) > 0)
+                        continue;
+                    std::cerr << "[SocketUtils] Tempo esgotado ao enviar" << std::endl;
+                    return false;
+                }
+                std::cerr << "[SocketUtils] Erro ao enviar: " << strerror(errno) << std::endl;
+                return false;
+            }
+
+            // Descarta as entradas concluídas e avança na primeira parcial
+            size_t done = static_cast<size_t>(sent);
+            while (count > 0 && done >= iov->iov_len)
+            {
+                done -= iov->iov_len;
+                ++iov;
+                --count;
+            }
+            if (count > 0)
+            {
+                iov->iov_base = static_cast<char*>(iov->iov_base) + done;
+                iov->iov_len -= done;
+            }
+        }
+        return true;
+    }
+}
+
+bool sendMessage(int sockfd, std::string_view json_message, Framing framing)
 {
     if (sockfd < 0) return false;
-    
-    std::string message = json_message + "\n";
-    const char* buffer = message.c_str();
-    size_t total_sent = 0;
-    size_t len = message.size();
+    return sendBatch(sockfd, {json_message}, framing);
+}
+
+bool sendBatch(int sockfd, const std::vector<std::string_view>& payloads, Framing framing)
+{
+    if (sockfd < 0) return false;
+
+    constexpr size_t FRAMES_PER_CALL = MAX_BATCH_IOVECS / 2;
+    static const char newline = '\n';
+    iovec iov[MAX_BATCH_IOVECS];
+    char headers[FRAMES_PER_CALL][FRAME_HEADER_SIZE];
 
-    while (total_sent < len)
+    for (size_t first = 0; first < payloads.size(); first += FRAMES_PER_CALL)
     {
-        ssize_t bytes = send(sockfd, buffer + total_sent, len - total_sent, 0);
-        
-        if (bytes < 0)
+        size_t frames = std::min(FRAMES_PER_CALL, payloads.size() - first);
+        size_t count = 0;
+
+        for (size_t i = 0; i < frames; ++i)
         {
-            if (errno == EINTR) continue; // Interrompido, tentar novamente
-            std::cerr << "[SocketUtils] Erro ao enviar: " << strerror(errno) << std::endl;
-            return false;
+            std::string_view payload = payloads[first + i];
+            iovec body{const_cast<char*>(payload.data()), payload.size()};
+
+            if (framing == Framing::LENGTH)
+            {
+                writeFrameHeader(headers[i], payload.size(),
+                                 static_cast<uint8_t>(Protocol::peekMessageType(payload)));
+                iov[count++] = {headers[i], FRAME_HEADER_SIZE};
+                iov[count++] = body;
+            }
+            else
+            {
+                iov[count++] = body;
+                iov[count++] = {const_cast<char*>(&newline), 1};
+            }
         }
-        
-        total_sent += bytes;
+
+        if (!sendAll(sockfd, iov, count))
+            return false;
     }
-    
+
     return true;
 }
 
-std::optional<std::string> receiveMessage(int sockfd, std::string& buffer)
+const char* framingName(Framing framing)
+{
+    return framing == Framing::LENGTH ? "length" : "line";
+}
+
+std::optional<Framing> parseFraming(std::string_view name)
+{
+    if (name == "line") return Framing::LINE;
+    if (name == "length") return Framing::LENGTH;
+    return std::nullopt;
+}
+
+const char* encodingName(Encoding encoding)
+{
+    switch (encoding)
+    {
+        case Encoding::MSGPACK: return "msgpack";
+        case Encoding::CBOR: return "cbor";
+        case Encoding::COMPACT: return "compact";
+        default: return "json";
+    }
+}
+
+std::optional<Encoding> parseEncoding(std::string_view name)
+{
+    if (name == "json") return Encoding::JSON;
+    if (name == "msgpack") return Encoding::MSGPACK;
+    if (name == "cbor") return Encoding::CBOR;
+    if (name == "compact") return Encoding::COMPACT;
+    return std::nullopt;
+}
+
+const char* compressionName(Compression compression)
+{
+    return compression == Compression::DEFLATE ? "deflate" : "none";
+}
+
+std::optional<Compression> parseCompression(std::string_view name)
+{
+    if (name == "none") return Compression::NONE;
+    if (name == "deflate") return Compression::DEFLATE;
+    return std::nullopt;
+}
+
+void writeFrameHeader(char* out, size_t length, uint8_t type)
+{
+    out[0] = static_cast<char>(length >> 24);
+    out[1] = static_cast<char>(length >> 16);
+    out[2] = static_cast<char>(length >> 8);
+    out[3] = static_cast<char>(length);
+    out[4] = static_cast<char>(type);
+}
+
+void appendFrame(std::string& out, Framing framing, std::string_view payload, uint8_t type)
+{
+    if (framing == Framing::LINE)
+    {
+        out.reserve(out.size() + payload.size() + 1);
+        out.append(payload);
+        out.push_back('\n');
+        return;
+    }
+
+    char header[FRAME_HEADER_SIZE];
+    writeFrameHeader(header, payload.size(), type);
+
+    out.reserve(out.size() + FRAME_HEADER_SIZE + payload.size());
+    out.append(header, FRAME_HEADER_SIZE);
+    out.append(payload);
+}
+
+std::optional<std::string_view> receiveMessage(int sockfd, FrameReader& reader)
 {
     if (sockfd < 0) return std::nullopt;
-    
-    char ch;
-    
+
     while (true)
     {
-        ssize_t bytes = recv(sockfd, &ch, 1, 0);
-        
+        if (auto frame = reader.next())
+            return frame;
+
+        ssize_t bytes = reader.fill(sockfd);
+
         if (bytes < 0)
         {
             // Não-bloqueante: sem dados disponíveis
             if (errno == EWOULDBLOCK || errno == EAGAIN)
                 return std::nullopt;
-            
-            // Interrompido: continuar
-            if (errno == EINTR)
-                continue;
-            
+
             // Erro real
             std::cerr << "[SocketUtils] Erro ao receber: " << strerror(errno) << std::endl;
             return std::nullopt;
         }
-        
+
         if (bytes == 0)
             // Conexão fechada pelo peer
             return std::nullopt;
-        
-        // Encontrou fim de linha
-        if (ch == '\n')
-        {
-            std::string message = buffer;
-            buffer.clear();
-            return message;
-        }
-        
-        buffer += ch;
-        
-        // Proteção contra mensagens gigantescas
-        if (buffer.size() > 16384)
-        { // 16KB limite
-            std::cerr << "[SocketUtils] Mensagem muito longa, descartando" << std::endl;
-            buffer.clear();
-            return std::nullopt;
-        }
     }
 }
 
@@ -124,6 +249,120 @@ bool setBlocking(int sockfd)
     return true;
 }
 
+bool enableKeepAlive(int sockfd, int idle_seconds, int interval_seconds, int count)
+{
+    if (sockfd < 0) return false;
+
+    int on = 1;
+    if (setsockopt(sockfd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on)) < 0 ||
+        setsockopt(sockfd, IPPROTO_TCP, TCP_KEEPIDLE, &idle_seconds, sizeof(idle_seconds)) < 0 ||
+        setsockopt(sockfd, IPPROTO_TCP, TCP_KEEPINTVL, &interval_seconds, sizeof(interval_seconds)) < 0 ||
+        setsockopt(sockfd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count)) < 0)
+    {
+        std::cerr << "[SocketUtils] Erro ao habilitar keepalive: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+namespace
+{
+    // Abaixo do limite do kernel (SCM_MAX_FD = 253) por mensagem
+    constexpr size_t FDS_PER_MESSAGE = 250;
+}
+
+bool sendFileDescriptors(int sockfd, const std::vector<int>& fds)
+{
+    if (sockfd < 0) return false;
+
+    for (size_t offset = 0; offset < fds.size(); offset += FDS_PER_MESSAGE)
+    {
+        size_t batch = std::min(FDS_PER_MESSAGE, fds.size() - offset);
+
+        // Cada lote leva um byte de dados (o kernel não envia mensagens vazias)
+        char marker = 'F';
+        iovec iov{&marker, 1};
+        std::vector<char> control(CMSG_SPACE(batch * sizeof(int)), 0);
+
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(batch * sizeof(int));
+        memcpy(CMSG_DATA(cmsg), fds.data() + offset, batch * sizeof(int));
+
+        ssize_t bytes;
+        do
+            bytes = sendmsg(sockfd, &msg, MSG_NOSIGNAL);
+        while (bytes < 0 && errno == EINTR);
+
+        if (bytes < 0)
+        {
+            std::cerr << "[SocketUtils] Erro ao enviar descritores: " << strerror(errno) << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool receiveFileDescriptors(int sockfd, std::vector<int>& fds, size_t count)
+{
+    if (sockfd < 0) return false;
+
+    while (fds.size() < count)
+    {
+        char marker;
+        iovec iov{&marker, 1};
+        std::vector<char> control(CMSG_SPACE(FDS_PER_MESSAGE * sizeof(int)), 0);
+
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+
+        ssize_t bytes = recvmsg(sockfd, &msg, MSG_CMSG_CLOEXEC);
+        if (bytes < 0 && errno == EINTR)
+            continue;
+        if (bytes <= 0)
+        {
+            std::cerr << "[SocketUtils] Erro ao receber descritores: "
+                      << (bytes == 0 ? "conexão fechada" : strerror(errno)) << std::endl;
+            return false;
+        }
+
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+                continue;
+
+            size_t n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const unsigned char* data = CMSG_DATA(cmsg);
+            for (size_t i = 0; i < n; ++i)
+            {
+                int fd;
+                memcpy(&fd, data + i * sizeof(int), sizeof(int));
+                fds.push_back(fd);
+            }
+        }
+
+        if (msg.msg_flags & MSG_CTRUNC)
+        {
+            std::cerr << "[SocketUtils] Descritores truncados na recepção" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void closeSocket(int& sockfd)
 {
     if (sockfd >= 0)
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <optional>
+#include <string_view>
+#include <vector>
+
+class FrameReader;
 
 /**
  * Módulo SocketUtils
@@ -13,22 +19,129 @@
 namespace SocketUtils
 {
 
+/**
+ * Tamanho máximo de um frame (linha JSON) aceito na recepção.
+ */
+constexpr size_t MAX_FRAME_SIZE = 16384;
+
+/**
+ * Framing de uma conexão.
+ * LINE (padrão): JSON seguido de '\n'.
+ * LENGTH: cabeçalho fixo de FRAME_HEADER_SIZE bytes (tamanho do payload em
+ * uint32 big-endian + código do Protocol::MessageType) seguido do JSON. O
+ * receptor sabe o tamanho do frame antes de lê-lo e não varre o payload.
+ * Negociado com HELLO/HELLO_OK no primeiro frame da conexão.
+ */
+enum class Framing : uint8_t
+{
+    LINE,
+    LENGTH
+};
+
+constexpr size_t FRAME_HEADER_SIZE = 5;
+
+/**
+ * Tamanho máximo do payload de um frame LENGTH aceito na recepção.
+ */
+constexpr size_t MAX_LENGTH_FRAME_SIZE = 1024 * 1024;
+
+/**
+ * Nome do framing no HELLO ("line"/"length") e o inverso.
+ */
+const char* framingName(Framing framing);
+std::optional<Framing> parseFraming(std::string_view name);
+
+/**
+ * Codificação das mensagens de uma conexão.
+ * JSON (padrão): texto. MSGPACK/CBOR: o mesmo documento em binário
+ * (conversão do nlohmann). COMPACT: protocolo v2, com códigos numéricos e
+ * campos em ordem fixa (ver compact_codec.hpp). As binárias usam sempre
+ * framing LENGTH, já que o binário pode conter '\n'. Negociada no mesmo
+ * HELLO do framing.
+ */
+enum class Encoding : uint8_t
+{
+    JSON,
+    MSGPACK,
+    CBOR,
+    COMPACT
+};
+
+/**
+ * Nome da codificação no HELLO ("json"/"msgpack"/"cbor"/"compact") e o inverso.
+ */
+const char* encodingName(Encoding encoding);
+std::optional<Encoding> parseEncoding(std::string_view name);
+
+/**
+ * Compressão de fluxo de uma conexão (ver compression.hpp).
+ * NONE (padrão): payloads como estão. DEFLATE: contexto deflate por conexão
+ * e sentido; payloads a partir de MIN_COMPRESSED_SIZE bytes vão comprimidos,
+ * marcados com COMPRESSED_FRAME_FLAG no byte de tipo do cabeçalho. Os
+ * menores seguem crus (sem custo de CPU nem de latência). Implica framing
+ * LENGTH. Negociada no mesmo HELLO do framing.
+ */
+enum class Compression : uint8_t
+{
+    NONE,
+    DEFLATE
+};
+
+constexpr uint8_t COMPRESSED_FRAME_FLAG = 0x80;
+constexpr size_t MIN_COMPRESSED_SIZE = 128;
+
+/**
+ * Nome da compressão no HELLO ("none"/"deflate") e o inverso.
+ */
+const char* compressionName(Compression compression);
+std::optional<Compression> parseCompression(std::string_view name);
+
+/**
+ * Escreve em 'out' (FRAME_HEADER_SIZE bytes) o cabeçalho LENGTH:
+ * tamanho do payload em big-endian + código do tipo.
+ */
+void writeFrameHeader(char* out, size_t length, uint8_t type);
+
+/**
+ * Acrescenta a 'out' o payload com o framing dado.
+ * 'type' só é usado no cabeçalho do framing LENGTH.
+ */
+void appendFrame(std::string& out, Framing framing, std::string_view payload, uint8_t type);
+
+/**
+ * Entradas de iovec por sendmsg (IOV_MAX no Linux).
+ */
+constexpr size_t MAX_BATCH_IOVECS = 1024;
+
 /**
  * Envia uma mensagem JSON com framing (adiciona \n no final).
  * Retorna true se sucesso, false caso contrário.
  */
-bool sendMessage(int sockfd, const std::string& json_message);
+bool sendMessage(int sockfd, std::string_view json_message, Framing framing = Framing::LINE);
+
+/**
+ * Envia vários payloads com framing usando um sendmsg para cada
+ * MAX_BATCH_IOVECS / 2 frames: o '\n' (ou o cabeçalho LENGTH) entra como
+ * iovec próprio, sem concatenar. Envios parciais são retomados; num socket
+ * não-bloqueante espera espaço com poll (até SEND_TIMEOUT_MS sem progresso).
+ * @return false em erro ou timeout (parte dos frames pode ter sido enviada)
+ */
+bool sendBatch(int sockfd, const std::vector<std::string_view>& payloads,
+               Framing framing = Framing::LINE);
+
+constexpr int SEND_TIMEOUT_MS = 5000;
 
 /**
  * Recebe uma mensagem JSON completa (até encontrar \n).
+ * Frames já no buffer são devolvidos sem syscall; senão lê um bloco do socket.
  * Em modo bloqueante: bloqueia até receber a linha completa.
  * Em modo não-bloqueante: retorna nullopt se não há dados disponíveis.
  * 
  * @param sockfd Socket file descriptor
- * @param buffer Buffer interno para acumular bytes (deve ser persistente entre chamadas)
- * @return Mensagem JSON (sem o \n), ou nullopt se não disponível/erro
+ * @param reader Buffer de leitura da conexão (deve ser persistente entre chamadas)
+ * @return View da mensagem (sem o \n), válida até a próxima leitura, ou nullopt se não disponível/erro
  */
-std::optional<std::string> receiveMessage(int sockfd, std::string& buffer);
+std::optional<std::string_view> receiveMessage(int sockfd, FrameReader& reader);
 
 /**
  * Define um socket como não-bloqueante.
@@ -40,6 +153,25 @@ bool setNonBlocking(int sockfd);
  */
 bool setBlocking(int sockfd);
 
+/**
+ * Habilita TCP keepalive: o kernel sonda o peer após idle_seconds sem
+ * tráfego e derruba a conexão após 'count' sondas sem resposta, espaçadas
+ * de interval_seconds. Detecta peers mortos em conexões TCP meio-abertas.
+ */
+bool enableKeepAlive(int sockfd, int idle_seconds, int interval_seconds, int count);
+
+/**
+ * Envia descritores de arquivo por um socket Unix (SCM_RIGHTS), em lotes.
+ * O processo receptor passa a ter cópias próprias dos descritores.
+ */
+bool sendFileDescriptors(int sockfd, const std::vector<int>& fds);
+
+/**
+ * Recebe exatamente 'count' descritores enviados por sendFileDescriptors
+ * (marcados como close-on-exec). Bloqueia até recebê-los.
+ */
+bool receiveFileDescriptors(int sockfd, std::vector<int>& fds, size_t count);
+
 /**
  * Fecha um socket de forma segura.
  */
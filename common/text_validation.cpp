@@ -0,0 +1,371 @@
+#include "text_validation.hpp"
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define TEXT_VALIDATION_X86 1
+#endif
+
+namespace TextValidation
+{
+
+namespace
+{
+
+// ==================== ESCALAR ====================
+
+bool scalarUtf8(std::string_view text)
+{
+    auto continuation = [&](size_t i, unsigned char low = 0x80, unsigned char high = 0xBF)
+    {
+        if (i >= text.size())
+            return false;
+        auto c = static_cast<unsigned char>(text[i]);
+        return c >= low && c <= high;
+    };
+
+    size_t i = 0;
+    while (i < text.size())
+    {
+        auto lead = static_cast<unsigned char>(text[i]);
+        if (lead < 0x80)
+        {
+            ++i;
+            continue;
+        }
+
+        size_t length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : 2;
+        bool ok;
+        if (lead >= 0xC2 && lead <= 0xDF)
+            ok = continuation(i + 1);
+        else if (lead == 0xE0)
+            ok = continuation(i + 1, 0xA0) && continuation(i + 2);
+        else if (lead == 0xED)
+            ok = continuation(i + 1, 0x80, 0x9F) && continuation(i + 2);
+        else if (lead >= 0xE1 && lead <= 0xEF)
+            ok = continuation(i + 1) && continuation(i + 2);
+        else if (lead == 0xF0)
+            ok = continuation(i + 1, 0x90) && continuation(i + 2) && continuation(i + 3);
+        else if (lead >= 0xF1 && lead <= 0xF3)
+            ok = continuation(i + 1) && continuation(i + 2) && continuation(i + 3);
+        else if (lead == 0xF4)
+            ok = continuation(i + 1, 0x80, 0x8F) && continuation(i + 2) && continuation(i + 3);
+        else
+            return false;
+
+        if (!ok)
+            return false;
+        i += length;
+    }
+    return true;
+}
+
+constexpr std::array<bool, 256> NICKNAME_CHARS = []
+{
+    std::array<bool, 256> table{};
+    for (int c = '0'; c <= '9'; ++c) table[c] = true;
+    for (int c = 'A'; c <= 'Z'; ++c) table[c] = true;
+    for (int c = 'a'; c <= 'z'; ++c) table[c] = true;
+    table['_'] = true;
+    return table;
+}();
+
+bool scalarNickname(std::string_view text)
+{
+    for (char c : text)
+        if (!NICKNAME_CHARS[static_cast<unsigned char>(c)])
+            return false;
+    return true;
+}
+
+#ifdef TEXT_VALIDATION_X86
+
+// ==================== UTF-8: TABELAS ====================
+
+// Bits de erro de um par (byte anterior, byte atual). Cada tabela dá, para
+// um nibble, os erros possíveis; o par tem erro se os três concordam.
+constexpr uint8_t TOO_SHORT = 1 << 0;       // 11______ seguido de 0_______ ou 11______
+constexpr uint8_t TOO_LONG = 1 << 1;        // 0_______ seguido de 10______
+constexpr uint8_t OVERLONG_3 = 1 << 2;      // 11100000 100_____
+constexpr uint8_t TOO_LARGE = 1 << 3;       // 11110100 1001____, 11110100 101_____, 11110101+ 10______
+constexpr uint8_t SURROGATE = 1 << 4;       // 11101101 101_____
+constexpr uint8_t OVERLONG_2 = 1 << 5;      // 1100000_ 10______
+constexpr uint8_t TOO_LARGE_1000 = 1 << 6;  // 11110101+ 1000____
+constexpr uint8_t OVERLONG_4 = 1 << 6;      // 11110000 1000____
+constexpr uint8_t TWO_CONTS = 1 << 7;       // 10______ 10______ (conferido à parte: 3º/4º byte)
+constexpr uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+// Nibble alto do byte anterior
+alignas(16) constexpr uint8_t BYTE_1_HIGH[16] = {
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    TOO_SHORT | OVERLONG_2,
+    TOO_SHORT,
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+};
+
+// Nibble baixo do byte anterior
+alignas(16) constexpr uint8_t BYTE_1_LOW[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    CARRY | OVERLONG_2,
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+};
+
+// Nibble alto do byte atual
+alignas(16) constexpr uint8_t BYTE_2_HIGH[16] = {
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+};
+
+// Maior byte aceitável nas 3 últimas posições de um bloco sem a sequência
+// continuar no próximo (lead de 4, de 3 e de 2 bytes, respectivamente)
+constexpr char MAX_3_FROM_END = static_cast<char>(0xEF);
+constexpr char MAX_2_FROM_END = static_cast<char>(0xDF);
+constexpr char MAX_1_FROM_END = static_cast<char>(0xBF);
+
+// ==================== UTF-8: SSSE3 ====================
+
+__attribute__((target("ssse3")))
+inline __m128i ssse3Table(const uint8_t (&table)[16])
+{
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(table));
+}
+
+__attribute__((target("ssse3")))
+inline __m128i ssse3HighNibble(__m128i v)
+{
+    return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+}
+
+/**
+ * Erros do bloco 'input' (com os 3 últimos bytes de 'prev' como contexto).
+ * 'incomplete' entra com a sequência cortada no fim do bloco anterior e sai
+ * com a deste.
+ */
+__attribute__((target("ssse3")))
+inline __m128i ssse3Block(__m128i input, __m128i prev, __m128i& incomplete)
+{
+    // Só ASCII: erro apenas se o bloco anterior terminou no meio de uma sequência
+    if (_mm_movemask_epi8(input) == 0)
+    {
+        __m128i error = incomplete;
+        incomplete = _mm_setzero_si128();
+        return error;
+    }
+
+    __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+    __m128i special = _mm_and_si128(
+        _mm_and_si128(_mm_shuffle_epi8(ssse3Table(BYTE_1_HIGH), ssse3HighNibble(prev1)),
+                      _mm_shuffle_epi8(ssse3Table(BYTE_1_LOW), _mm_and_si128(prev1, _mm_set1_epi8(0x0F)))),
+        _mm_shuffle_epi8(ssse3Table(BYTE_2_HIGH), ssse3HighNibble(input)));
+
+    // 3º e 4º bytes de sequências longas têm de ser continuações (bit TWO_CONTS)
+    __m128i third = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 14), _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 13), _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    __m128i must_continue = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+
+    incomplete = _mm_subs_epu8(input, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                    MAX_3_FROM_END, MAX_2_FROM_END, MAX_1_FROM_END));
+    return _mm_xor_si128(must_continue, special);
+}
+
+__attribute__((target("ssse3")))
+bool ssse3Utf8(std::string_view text)
+{
+    const char* data = text.data();
+    size_t size = text.size();
+
+    __m128i error = _mm_setzero_si128();
+    __m128i prev = _mm_setzero_si128();
+    __m128i incomplete = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        error = _mm_or_si128(error, ssse3Block(input, prev, incomplete));
+        prev = input;
+    }
+
+    // Resto completado com zeros (ASCII): sequência cortada no fim vira erro
+    alignas(16) char tail[16] = {};
+    std::memcpy(tail, data + i, size - i);
+    error = _mm_or_si128(error, ssse3Block(_mm_load_si128(reinterpret_cast<const __m128i*>(tail)), prev, incomplete));
+
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+// ==================== UTF-8: AVX2 ====================
+
+__attribute__((target("avx2")))
+inline __m256i avx2Table(const uint8_t (&table)[16])
+{
+    return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+__attribute__((target("avx2")))
+inline __m256i avx2HighNibble(__m256i v)
+{
+    return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+}
+
+/**
+ * Mesmo que ssse3Block, em 32 bytes. O alignr do AVX2 é por metade de 128
+ * bits: 'shifted' junta o fim de 'prev' com o começo de 'input'.
+ */
+__attribute__((target("avx2")))
+inline __m256i avx2Block(__m256i input, __m256i prev, __m256i& incomplete)
+{
+    if (_mm256_movemask_epi8(input) == 0)
+    {
+        __m256i error = incomplete;
+        incomplete = _mm256_setzero_si256();
+        return error;
+    }
+
+    __m256i shifted = _mm256_permute2x128_si256(prev, input, 0x21);
+    __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+    __m256i special = _mm256_and_si256(
+        _mm256_and_si256(_mm256_shuffle_epi8(avx2Table(BYTE_1_HIGH), avx2HighNibble(prev1)),
+                         _mm256_shuffle_epi8(avx2Table(BYTE_1_LOW), _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)))),
+        _mm256_shuffle_epi8(avx2Table(BYTE_2_HIGH), avx2HighNibble(input)));
+
+    __m256i third = _mm256_subs_epu8(_mm256_alignr_epi8(input, shifted, 14),
+                                     _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    __m256i fourth = _mm256_subs_epu8(_mm256_alignr_epi8(input, shifted, 13),
+                                      _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    __m256i must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth),
+                                             _mm256_set1_epi8(static_cast<char>(0x80)));
+
+    incomplete = _mm256_subs_epu8(input, _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                          -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                          MAX_3_FROM_END, MAX_2_FROM_END, MAX_1_FROM_END));
+    return _mm256_xor_si256(must_continue, special);
+}
+
+__attribute__((target("avx2")))
+bool avx2Utf8(std::string_view text)
+{
+    const char* data = text.data();
+    size_t size = text.size();
+
+    __m256i error = _mm256_setzero_si256();
+    __m256i prev = _mm256_setzero_si256();
+    __m256i incomplete = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        error = _mm256_or_si256(error, avx2Block(input, prev, incomplete));
+        prev = input;
+    }
+
+    alignas(32) char tail[32] = {};
+    std::memcpy(tail, data + i, size - i);
+    error = _mm256_or_si256(error, avx2Block(_mm256_load_si256(reinterpret_cast<const __m256i*>(tail)), prev, incomplete));
+
+    return _mm256_testz_si256(error, error);
+}
+
+// ==================== APELIDO: SSE2 ====================
+
+/**
+ * c em [lo, hi] por byte: desloca a faixa para o começo dos inteiros com
+ * sinal e compara uma vez
+ */
+inline __m128i inRange(__m128i c, char lo, char hi)
+{
+    return _mm_cmplt_epi8(_mm_add_epi8(c, _mm_set1_epi8(static_cast<char>(0x80 - lo))),
+                          _mm_set1_epi8(static_cast<char>(0x80 + hi - lo + 1)));
+}
+
+inline bool nicknameBlock(__m128i c)
+{
+    // Letras: com o bit 0x20 ligado, maiúsculas caem na faixa das minúsculas
+    __m128i valid = _mm_or_si128(_mm_or_si128(inRange(c, '0', '9'),
+                                              inRange(_mm_or_si128(c, _mm_set1_epi8(0x20)), 'a', 'z')),
+                                 _mm_cmpeq_epi8(c, _mm_set1_epi8('_')));
+    return _mm_movemask_epi8(valid) == 0xFFFF;
+}
+
+bool sse2Nickname(std::string_view text)
+{
+    // Abaixo de um bloco a tabela ganha de montar um bloco com enchimento
+    if (text.size() < 16)
+        return scalarNickname(text);
+
+    const char* data = text.data();
+    for (size_t i = 0; i + 16 < text.size(); i += 16)
+        if (!nicknameBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))))
+            return false;
+
+    // Último bloco alinhado ao fim (sobrepõe o anterior, sem ler além do texto)
+    return nicknameBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + text.size() - 16)));
+}
+
+#endif // TEXT_VALIDATION_X86
+
+// ==================== DESPACHO ====================
+
+constexpr Kernel SCALAR{"escalar", scalarUtf8, scalarNickname};
+
+#ifdef TEXT_VALIDATION_X86
+constexpr Kernel SSSE3{"ssse3", ssse3Utf8, sse2Nickname};
+constexpr Kernel AVX2{"avx2", avx2Utf8, sse2Nickname};
+#endif
+
+const Kernel& selectKernel()
+{
+#ifdef TEXT_VALIDATION_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return AVX2;
+    if (__builtin_cpu_supports("ssse3"))
+        return SSSE3;
+#endif
+    return SCALAR;
+}
+
+} // namespace
+
+const Kernel& activeKernel()
+{
+    static const Kernel& kernel = selectKernel();
+    return kernel;
+}
+
+std::vector<Kernel> availableKernels()
+{
+    std::vector<Kernel> kernels{SCALAR};
+#ifdef TEXT_VALIDATION_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3"))
+        kernels.push_back(SSSE3);
+    if (__builtin_cpu_supports("avx2"))
+        kernels.push_back(AVX2);
+#endif
+    return kernels;
+}
+
+} // namespace TextValidation
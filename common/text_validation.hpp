@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+/**
+ * Módulo TextValidation
+ * ---------------------
+ * Núcleos de validação dos campos de texto do protocolo, com versões SIMD e
+ * a escalar de referência:
+ *
+ *   - UTF-8 (RFC 3629): algoritmo de consulta a tabelas de Keiser e Lemire
+ *     (o do simdjson), que classifica cada par de bytes vizinhos com três
+ *     pshufb e acumula os erros num registrador, sem desvio por byte. Blocos
+ *     só ASCII passam com um movemask. AVX2 (32 bytes por passo), SSSE3 (16)
+ *     ou escalar, escolhido uma vez pela CPU em tempo de execução
+ *   - apelido: todos os bytes em [A-Za-z0-9_], por comparações de faixa
+ *     (SSE2, presente em todo x86-64; escalar nas outras arquiteturas).
+ *     Independe de locale, ao contrário de std::isalnum
+ *
+ * As versões concordam byte a byte com a escalar (conferido pelo
+ * bench_validation antes de medir).
+ */
+
+namespace TextValidation
+{
+
+/**
+ * Um conjunto de núcleos (nome para logs/benchmark)
+ */
+struct Kernel
+{
+    const char* name;
+    bool (*utf8)(std::string_view text);
+    bool (*nickname)(std::string_view text);
+};
+
+/**
+ * Núcleo escolhido para esta CPU (o melhor disponível)
+ */
+const Kernel& activeKernel();
+
+/**
+ * Núcleos que esta CPU executa, do escalar ao mais largo (benchmark)
+ */
+std::vector<Kernel> availableKernels();
+
+/**
+ * UTF-8 válido: sem formas longas, sem surrogates, até U+10FFFF e sem
+ * sequência cortada no fim
+ */
+inline bool isValidUtf8(std::string_view text)
+{
+    return activeKernel().utf8(text);
+}
+
+/**
+ * Só [A-Za-z0-9_] (não verifica o tamanho; vazio é válido)
+ */
+inline bool isNicknameCharset(std::string_view text)
+{
+    return activeKernel().nickname(text);
+}
+
+} // namespace TextValidation
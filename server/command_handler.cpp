@@ -1,5 +1,6 @@
 #include "command_handler.hpp"
 #include "protocol.hpp"
+#include "request_parser.hpp"
 #include <ctime>
 #include <iostream>
 
@@ -7,224 +8,324 @@ using json = nlohmann::json;
 using namespace Protocol;
 using namespace std;
 
-string CommandHandler::processCommand(const string& raw_message, int client_sockfd)
+constexpr array<CommandHandler::Handler, MESSAGE_TYPE_COUNT> CommandHandler::dispatchTable()
+{
+    struct Route
+    {
+        MessageType type;
+        Handler handler;
+    };
+
+    constexpr Route ROUTES[] = {
+        {MessageType::REGISTER,    &CommandHandler::handleRegister},
+        {MessageType::LOGIN,       &CommandHandler::handleLogin},
+        {MessageType::LOGOUT,      &CommandHandler::handleLogout},
+        {MessageType::SEND_MSG,    &CommandHandler::handleSendMessage},
+        {MessageType::LIST_USERS,  &CommandHandler::handleListUsers},
+        {MessageType::DELETE_USER, &CommandHandler::handleDeleteUser},
+        {MessageType::HELLO,       &CommandHandler::handleHello},
+        {MessageType::BATCH,       &CommandHandler::handleBatch},
+    };
+
+    array<Handler, MESSAGE_TYPE_COUNT> table{};
+    for (const auto& route : ROUTES)
+        table[static_cast<size_t>(route.type)] = route.handler;
+    return table;
+}
+
+string CommandHandler::processCommand(string_view raw_message, int client_sockfd, SocketUtils::Encoding encoding)
 {
     try
     {
-        json request = json::parse(raw_message);
-        MessageType type = parseMessageType(request);
+        Request request = parseRequest(raw_message);
 
-        switch (type)
-        {
-            case MessageType::REGISTER    : return handleRegister(request);
-            case MessageType::LOGIN       : return handleLogin(request, client_sockfd);
-            case MessageType::LOGOUT      : return handleLogout(client_sockfd);
-            case MessageType::SEND_MSG    : return handleSendMessage(request, client_sockfd);
-            case MessageType::LIST_USERS  : return handleListUsers();
-            case MessageType::DELETE_USER : return handleDeleteUser(request, client_sockfd);
-            
-            default:
-                return buildErrorResponse(ErrorType::UNKNOWN_COMMAND).dump();
-        }
+        // Uma aquisição do estado por frame (o BATCH inteiro roda sob ela)
+        lock_guard<mutex> lock(server.getStateMutex());
+        return dispatch(request, client_sockfd, encoding);
     }
     catch (const json::parse_error& e)
     {
         cerr << "[CommandHandler] Erro de parsing JSON: " << e.what() << endl;
-        return buildErrorResponse(ErrorType::BAD_FORMAT).dump();
+        return string(errorResponse(ErrorType::BAD_FORMAT, encoding));
     }
     catch (const ParseException& e)
     {
         cerr << "[CommandHandler] Erro de protocolo: " << e.what() << endl;
-        return buildErrorResponse(ErrorType::BAD_FORMAT).dump();
+        return string(errorResponse(ErrorType::BAD_FORMAT, encoding));
     }
     catch (const exception& e)
     {
         cerr << "[CommandHandler] Erro interno: " << e.what() << endl;
-        return buildErrorResponse(ErrorType::INTERNAL_SERVER_ERROR).dump();
+        return string(errorResponse(ErrorType::INTERNAL_SERVER_ERROR, encoding));
     }
 }
 
+bool CommandHandler::negotiateFraming(string_view frame, int client_sockfd, string& response,
+                                      SocketUtils::Framing& framing, SocketUtils::Encoding& encoding,
+                                      SocketUtils::Compression& compression)
+{
+    auto requested = parseHello(frame);
+    if (!requested)
+        return false;
+
+    framing = SocketUtils::parseFraming(requested->framing).value_or(SocketUtils::Framing::LINE);
+    encoding = SocketUtils::parseEncoding(requested->encoding).value_or(SocketUtils::Encoding::JSON);
+    compression = SocketUtils::parseCompression(requested->compression).value_or(SocketUtils::Compression::NONE);
+
+    // Binário pode conter '\n': só com prefixo de tamanho
+    if (encoding != SocketUtils::Encoding::JSON || compression != SocketUtils::Compression::NONE)
+        framing = SocketUtils::Framing::LENGTH;
+
+    response = encodeHelloOk(SocketUtils::framingName(framing), SocketUtils::encodingName(encoding),
+                             SocketUtils::compressionName(compression));
+
+    cout << "[Server] Framing negociado (FD: " << client_sockfd << "): "
+         << SocketUtils::framingName(framing) << ", " << SocketUtils::encodingName(encoding) << ", "
+         << SocketUtils::compressionName(compression) << endl;
+    return true;
+}
+
+string CommandHandler::dispatch(const Request& request, int client_sockfd, SocketUtils::Encoding encoding)
+{
+    static constexpr auto DISPATCH = dispatchTable();
+    static_assert([]
+    {
+        for (size_t i = 0; i < MESSAGE_TYPE_COUNT; ++i)
+            if (MESSAGES[i].isRequest() != (DISPATCH[i] != nullptr))
+                return false;
+        return true;
+    }(), "handlers e requisições do registro não batem");
+
+    auto code = static_cast<size_t>(request.type);
+    if (code >= MESSAGE_TYPE_COUNT || !DISPATCH[code])
+        return string(errorResponse(ErrorType::UNKNOWN_COMMAND, encoding));
+
+    return (this->*DISPATCH[code])(request, client_sockfd, encoding);
+}
+
 // ==================== HANDLERS INDIVIDUAIS ====================
 
-string CommandHandler::handleRegister(const json& request)
+string CommandHandler::handleRegister(const Request& request, int, SocketUtils::Encoding encoding)
 {
-    lock_guard<mutex> lock(server.getStateMutex());
-    
     try
     {
-        string nickname = parseNickname(request);
-        string fullName = parseFullName(request);
+        string_view nickname = parseNickname(request);
+        string_view fullName = parseFullName(request);
         
         // Verifica se apelido já existe
-        if (server.getUsers().count(nickname))
-            return buildErrorResponse(ErrorType::NICK_TAKEN).dump();
+        if (server.getNicknames().find(nickname) != NO_USER)
+            return string(errorResponse(ErrorType::NICK_TAKEN, encoding));
         
         // Registra usuário
-        server.getUsers()[nickname] = {fullName, false};
+        server.addUser(nickname, fullName);
         
         cout << "[Server] Usuário registrado: " << nickname << endl;
-        return buildOkResponse().dump();
+        return string(okResponse(encoding));
     }
     catch (const ParseException& e)
     {
-        return buildErrorResponse(ErrorType::BAD_FORMAT).dump();
+        return string(errorResponse(ErrorType::BAD_FORMAT, encoding));
     }
 }
 
-string CommandHandler::handleLogin(const json& request, int client_sockfd)
+string CommandHandler::handleLogin(const Request& request, int client_sockfd, SocketUtils::Encoding encoding)
 {
-    lock_guard<mutex> lock(server.getStateMutex());
-    
     try
     {
-        string nickname = parseNickname(request);
+        string_view nickname = parseNickname(request);
         
         // Verifica se usuário existe
-        if (server.getUsers().find(nickname) == server.getUsers().end())
-            return buildErrorResponse(ErrorType::NO_SUCH_USER).dump();
+        UserId id = server.getNicknames().find(nickname);
+        if (id == NO_USER)
+            return string(errorResponse(ErrorType::NO_SUCH_USER, encoding));
         
         // Verifica se já está online
-        if (server.getSessions().count(nickname))
-            return buildErrorResponse(ErrorType::ALREADY_ONLINE).dump();
+        if (server.getSessions().count(id))
+            return string(errorResponse(ErrorType::ALREADY_ONLINE, encoding));
         
         // Verifica se este socket já tem uma sessão
-        if (server.getFdToNickname().count(client_sockfd))
-            return buildErrorResponse(ErrorType::BAD_STATE).dump();
+        if (server.getFdToUser().count(client_sockfd))
+            return string(errorResponse(ErrorType::BAD_STATE, encoding));
         
         // Cria sessão
-        server.getSessions()[nickname] = client_sockfd;
-        server.getFdToNickname()[client_sockfd] = nickname;
-        server.getUsers()[nickname].isLogged = true;
+        server.getSessions()[id] = client_sockfd;
+        server.getFdToUser()[client_sockfd] = id;
+        server.getUsers()[id].isLogged = true;
         
         cout << "[Server] Login: " << nickname << " (FD: " << client_sockfd << ")" << endl;
         
         // Entrega mensagens pendentes (fora do lock para evitar deadlock)
-        server.deliverPendingMessages(client_sockfd, nickname);
+        server.deliverPendingMessages(client_sockfd, id);
         
-        return buildLoginOkResponse(nickname).dump();
+        return encodeLoginOk(nickname, encoding);
     }
     catch (const ParseException& e)
     {
-        return buildErrorResponse(ErrorType::BAD_FORMAT).dump();
+        return string(errorResponse(ErrorType::BAD_FORMAT, encoding));
     }
 }
 
-string CommandHandler::handleLogout(int client_sockfd)
+string CommandHandler::handleLogout(const Request&, int client_sockfd, SocketUtils::Encoding encoding)
 {
-    lock_guard<mutex> lock(server.getStateMutex());
-    
     // Verifica se tem sessão
-    auto it = server.getFdToNickname().find(client_sockfd);
-    if (it == server.getFdToNickname().end())
-        return buildErrorResponse(ErrorType::BAD_STATE).dump();
+    auto it = server.getFdToUser().find(client_sockfd);
+    if (it == server.getFdToUser().end())
+        return string(errorResponse(ErrorType::BAD_STATE, encoding));
     
-    string nickname = it->second;
+    UserId id = it->second;
     
     // Remove sessão
-    server.getUsers()[nickname].isLogged = false;
-    server.getSessions().erase(nickname);
-    server.getFdToNickname().erase(client_sockfd);
+    server.getUsers()[id].isLogged = false;
+    server.getSessions().erase(id);
+    server.getFdToUser().erase(it);
     
-    cout << "[Server] Logout: " << nickname << endl;
-    return buildOkResponse().dump();
+    cout << "[Server] Logout: " << server.getNicknames().name(id) << endl;
+    return string(okResponse(encoding));
 }
 
-string CommandHandler::handleSendMessage(const json& request, int client_sockfd)
+string CommandHandler::handleSendMessage(const Request& request, int client_sockfd, SocketUtils::Encoding encoding)
 {
-    lock_guard<mutex> lock(server.getStateMutex());
-    
     // Verifica autenticação
-    auto it = server.getFdToNickname().find(client_sockfd);
-    if (it == server.getFdToNickname().end())
-        return buildErrorResponse(ErrorType::UNAUTHORIZED).dump();
+    auto it = server.getFdToUser().find(client_sockfd);
+    if (it == server.getFdToUser().end())
+        return string(errorResponse(ErrorType::UNAUTHORIZED, encoding));
     
-    string from = it->second;
+    string_view from = server.getNicknames().name(it->second);
     
     try
     {
-        string to = parseRecipient(request);
-        string text = parseMessageText(request);
+        string_view to_name = parseRecipient(request);
+        string_view text = parseMessageText(request);
         
         // Verifica se destinatário existe
-        if (server.getUsers().find(to) == server.getUsers().end())
-            return buildErrorResponse(ErrorType::NO_SUCH_USER).dump();
+        UserId to = server.getNicknames().find(to_name);
+        if (to == NO_USER)
+            return string(errorResponse(ErrorType::NO_SUCH_USER, encoding));
         
         // Cria mensagem de entrega
         time_t now = time(nullptr);
-        json deliver_msg = buildDeliverMessage(from, text, now);
         
         // Entrega imediata ou store-and-forward
-        if (server.getSessions().count(to))
+        auto session = server.getSessions().find(to);
+        if (session != server.getSessions().end() && server.shouldDivert(session->second, to))
+        {
+            // Saída do destinatário congestionada: entregue quando drenar
+            server.getMessageQueues()[to].push(encodeDeliverMessage(from, text, now));
+            cout << "[Server] Mensagem desviada: " << from << " -> " << to_name
+                 << " (consumidor lento)" << endl;
+        }
+        else if (session != server.getSessions().end())
         {
-            // Online: entrega imediata
-            server.sendToClient(server.getSessions().at(to), deliver_msg.dump());
-            cout << "[Server] Mensagem entregue: " << from << " -> " << to << endl;
+            // Online: entrega imediata, já na codificação do destinatário
+            server.sendToClient(session->second,
+                                encodeDeliverMessage(from, text, now, server.clientEncoding(session->second)));
+            cout << "[Server] Mensagem entregue: " << from << " -> " << to_name << endl;
         }
         else
         {
             // Offline: armazena na fila
-            server.getMessageQueues()[to].push(deliver_msg.dump());
-            cout << "[Server] Mensagem armazenada: " << from << " -> " << to 
+            server.getMessageQueues()[to].push(encodeDeliverMessage(from, text, now));
+            cout << "[Server] Mensagem armazenada: " << from << " -> " << to_name 
                  << " (offline)" << endl;
         }
         
-        return buildOkResponse().dump();
+        return string(okResponse(encoding));
     }
     catch (const ParseException& e)
     {
-        return buildErrorResponse(ErrorType::BAD_FORMAT).dump();
+        return string(errorResponse(ErrorType::BAD_FORMAT, encoding));
     }
 }
 
-string CommandHandler::handleListUsers()
+string CommandHandler::handleListUsers(const Request&, int, SocketUtils::Encoding encoding)
 {
-    lock_guard<mutex> lock(server.getStateMutex());
-    
+    // Ordem dos ids (ids livres de usuários removidos ficam de fora)
+    const NicknameTable& nicknames = server.getNicknames();
     vector<UserInfo> user_list;
-    for (const auto& [nickname, data] : server.getUsers())
-        user_list.push_back({nickname, data.fullName, data.isLogged});
+    user_list.reserve(nicknames.size());
+    for (UserId id = 0; id < nicknames.idLimit(); ++id)
+    {
+        if (!nicknames.contains(id))
+            continue;
+        const UserData& data = server.getUsers()[id];
+        user_list.push_back({string(nicknames.name(id)), data.fullName, data.isLogged});
+    }
     
-    return buildUsersListResponse(user_list).dump();
+    return encodeUsersList(user_list, encoding);
 }
 
-string CommandHandler::handleDeleteUser(const json& request, int client_sockfd)
+string CommandHandler::handleDeleteUser(const Request& request, int client_sockfd, SocketUtils::Encoding encoding)
 {
-    lock_guard<mutex> lock(server.getStateMutex());
-    
     try
     {
-        string nickname = parseNickname(request);
+        string_view nickname = parseNickname(request);
         
         // Verifica se usuário existe
-        if (server.getUsers().find(nickname) == server.getUsers().end())
-            return buildErrorResponse(ErrorType::NO_SUCH_USER).dump();
+        UserId id = server.getNicknames().find(nickname);
+        if (id == NO_USER)
+            return string(errorResponse(ErrorType::NO_SUCH_USER, encoding));
         
         // Verifica se é o próprio usuário
-        auto it = server.getFdToNickname().find(client_sockfd);
-        if (it == server.getFdToNickname().end() || it->second != nickname)
-            return buildErrorResponse(ErrorType::UNAUTHORIZED).dump();
+        auto it = server.getFdToUser().find(client_sockfd);
+        if (it == server.getFdToUser().end() || it->second != id)
+            return string(errorResponse(ErrorType::UNAUTHORIZED, encoding));
         
         // Verifica se está online
-        if (server.getUsers().at(nickname).isLogged)
+        if (server.getUsers()[id].isLogged)
         {
-            server.getUsers()[nickname].isLogged = false;
-            server.getSessions().erase(nickname);
-            server.getFdToNickname().erase(client_sockfd);
+            server.getUsers()[id].isLogged = false;
+            server.getSessions().erase(id);
+            server.getFdToUser().erase(it);
             cout << "[Server] Sessão encerrada para deleção: " << nickname << endl;
         }
         else
-            return buildErrorResponse(ErrorType::BAD_STATE).dump();
+            return string(errorResponse(ErrorType::BAD_STATE, encoding));
         
         // Remove usuário e dados associados
-        server.getUsers().erase(nickname);
-        server.getMessageQueues().erase(nickname);
-        server.getSessions().erase(nickname);
+        server.removeUser(id);
         
         cout << "[Server] Usuário deletado: " << nickname << endl;
-        return buildOkResponse().dump();
+        return string(okResponse(encoding));
     }
     catch (const ParseException& e)
     {
-        return buildErrorResponse(ErrorType::BAD_FORMAT).dump();
+        return string(errorResponse(ErrorType::BAD_FORMAT, encoding));
+    }
+}
+
+string CommandHandler::handleHello(const Request&, int, SocketUtils::Encoding encoding)
+{
+    // Framing só é negociado no primeiro frame (ver negotiateFraming)
+    return string(errorResponse(ErrorType::BAD_STATE, encoding));
+}
+
+string CommandHandler::handleBatch(const Request& request, int client_sockfd, SocketUtils::Encoding encoding)
+{
+    if (request.batch.size() > MAX_BATCH_SIZE)
+        return string(errorResponse(ErrorType::BAD_FORMAT, encoding));
+
+    vector<string> responses;
+    responses.reserve(request.batch.size());
+    for (const Request& item : request.batch)
+    {
+        // Envelope dentro de envelope: só um nível
+        if (item.type == MessageType::BATCH)
+        {
+            responses.emplace_back(errorResponse(ErrorType::BAD_FORMAT, encoding));
+            continue;
+        }
+
+        // Falha de um item não derruba os outros
+        try
+        {
+            responses.push_back(dispatch(item, client_sockfd, encoding));
+        }
+        catch (const exception& e)
+        {
+            cerr << "[CommandHandler] Erro interno no BATCH: " << e.what() << endl;
+            responses.emplace_back(errorResponse(ErrorType::INTERNAL_SERVER_ERROR, encoding));
+        }
     }
+
+    return encodeBatchOk(responses, encoding);
 }
\ No newline at end of file
@@ -1,8 +1,12 @@
 #pragma once
 
+#include "protocol_registry.hpp"
+#include "request_parser.hpp"
 #include "server.hpp"
-#include <nlohmann/json.hpp>
+#include "socket_utils.hpp"
+#include <array>
 #include <string>
+#include <string_view>
 
 /**
  * Classe CommandHandler
@@ -19,21 +23,58 @@ public:
 
     /**
      * Lógica de processamento de um comando do protocolo.
-     * Processa um comando JSON e retorna a resposta.
+     * Processa um comando JSON e retorna a resposta. O estado do servidor é
+     * adquirido uma vez por frame: os handlers (e todos os itens de um
+     * BATCH) rodam sob o mesmo lock. A resposta já sai na codificação
+     * negociada da conexão ('encoding'), montada dos campos.
      * @param raw_message 
      * @param client_sockfd 
      * @return 
      */
-    std::string processCommand(const std::string& raw_message, int client_sockfd);
+    std::string processCommand(std::string_view raw_message, int client_sockfd,
+                               SocketUtils::Encoding encoding);
+
+    /**
+     * Negociação de framing, codificação e compressão. Os backends chamam só
+     * para o primeiro frame da conexão: se for um HELLO, 'response' recebe o
+     * HELLO_OK (enviado ainda em linha, em JSON e sem compressão) e
+     * 'framing'/'encoding'/'compression' o que vale depois dele. Valores
+     * desconhecidos mantêm LINE, JSON e NONE; as codificações binárias e a
+     * compressão forçam LENGTH.
+     * @return false se o frame não é um HELLO (segue para processCommand)
+     */
+    bool negotiateFraming(std::string_view frame, int client_sockfd, std::string& response,
+                          SocketUtils::Framing& framing, SocketUtils::Encoding& encoding,
+                          SocketUtils::Compression& compression);
 
 private:
     Server& server;
 
+    /**
+     * Tabela de despacho indexada pelo código do MessageType, montada em tempo
+     * de compilação; toda requisição do registro (Protocol::MESSAGES) precisa
+     * de um handler. Respostas ficam vazias (UNKNOWN_COMMAND).
+     */
+    using Handler = std::string (CommandHandler::*)(const Protocol::Request&, int, SocketUtils::Encoding);
+    static constexpr std::array<Handler, Protocol::MESSAGE_TYPE_COUNT> dispatchTable();
+
+    /**
+     * Resposta de uma requisição já interpretada (chamado com stateMutex adquirido)
+     */
+    std::string dispatch(const Protocol::Request& request, int client_sockfd, SocketUtils::Encoding encoding);
+
     // ==================== Handlers Individuais ====================
-    std::string handleRegister(const nlohmann::json& request);
-    std::string handleLogin(const nlohmann::json& request, int client_sockfd);
-    std::string handleLogout(int client_sockfd);
-    std::string handleSendMessage(const nlohmann::json& request, int client_sockfd);
-    std::string handleListUsers();
-    std::string handleDeleteUser(const nlohmann::json& request, int client_sockfd);
+    std::string handleRegister(const Protocol::Request& request, int client_sockfd, SocketUtils::Encoding encoding);
+    std::string handleLogin(const Protocol::Request& request, int client_sockfd, SocketUtils::Encoding encoding);
+    std::string handleLogout(const Protocol::Request& request, int client_sockfd, SocketUtils::Encoding encoding);
+    std::string handleSendMessage(const Protocol::Request& request, int client_sockfd, SocketUtils::Encoding encoding);
+    std::string handleListUsers(const Protocol::Request& request, int client_sockfd, SocketUtils::Encoding encoding);
+    std::string handleDeleteUser(const Protocol::Request& request, int client_sockfd, SocketUtils::Encoding encoding);
+    std::string handleHello(const Protocol::Request& request, int client_sockfd, SocketUtils::Encoding encoding);
+
+    /**
+     * Cada item do envelope pelo seu handler, em ordem; as respostas voltam
+     * num único BATCH_OK (as entregas a terceiros saem como sempre)
+     */
+    std::string handleBatch(const Protocol::Request& request, int client_sockfd, SocketUtils::Encoding encoding);
 };
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "coro_reactor.hpp"
+#include "protocol.hpp"
+#include "server.hpp"
+#include <utility>
+
+using namespace std;
+
+// ==================== CONSTRUTOR ====================
+
+CoroReactor::CoroReactor(Server& server, int listen_fd)
+    : Reactor(server, listen_fd), handler(server) {}
+
+// ==================== SESSÃO ====================
+
+CoroTask CoroReactor::runSession(int sockfd, Session& session)
+{
+    while (auto frame = co_await readFrame(sockfd, session))
+    {
+        string response = handler.processCommand(*frame, sockfd, encodingOf(sockfd));
+        if (!response.empty())
+            co_await write(sockfd, session, response);
+    }
+}
+
+optional<string> CoroReactor::FrameAwaiter::await_resume()
+{
+    if (session.frames.empty())
+        return nullopt;
+
+    string frame = std::move(session.frames.front());
+    session.frames.pop_front();
+
+    // Consumidor alcançou a entrada: volta a ler o socket
+    if (session.frames.size() < MAX_PENDING_FRAMES / 2)
+        reactor.setReadPaused(sockfd, false);
+
+    return frame;
+}
+
+CoroReactor::WriteAwaiter CoroReactor::write(int sockfd, Session& session, const string& json_message)
+{
+    send(sockfd, json_message);
+    return {*this, sockfd, session};
+}
+
+bool CoroReactor::WriteAwaiter::await_ready() const
+{
+    return session.closed || reactor.pendingWriteBytes(sockfd) <= WRITE_HIGH_WATERMARK;
+}
+
+void CoroReactor::resume(coroutine_handle<>& h)
+{
+    if (h)
+        std::exchange(h, {}).resume();
+}
+
+// ==================== EVENTOS DO REACTOR ====================
+
+void CoroReactor::onConnectionOpened(int sockfd)
+{
+    auto session = make_unique<Session>();
+    Session& ref = *session;
+    sessions[sockfd] = std::move(session);
+
+    // Executa até o primeiro readFrame
+    ref.task = runSession(sockfd, ref);
+}
+
+void CoroReactor::dispatchFrame(int sockfd, string_view message)
+{
+    auto it = sessions.find(sockfd);
+    if (it == sessions.end())
+        return;
+
+    Session& session = *it->second;
+    session.frames.emplace_back(message);
+
+    // Sessão parada em write: segura a leitura até ela consumir a fila
+    if (session.frames.size() >= MAX_PENDING_FRAMES)
+        setReadPaused(sockfd, true);
+
+    resume(session.reader);
+}
+
+void CoroReactor::onWritable(int sockfd)
+{
+    auto it = sessions.find(sockfd);
+    if (it == sessions.end())
+        return;
+
+    if (pendingWriteBytes(sockfd) <= WRITE_LOW_WATERMARK)
+        resume(it->second->writer);
+}
+
+void CoroReactor::onConnectionClosed(int sockfd)
+{
+    auto it = sessions.find(sockfd);
+    if (it != sessions.end())
+    {
+        // Acorda a corrotina: ela consome os frames que chegaram antes do
+        // fechamento e termina quando readFrame devolver nullopt
+        Session& session = *it->second;
+        session.closed = true;
+        resume(session.writer);
+        resume(session.reader);
+        sessions.erase(it);
+    }
+
+    Reactor::onConnectionClosed(sockfd);
+}
+
+// ==================== ATUALIZAÇÃO A QUENTE ====================
+
+void CoroReactor::exportConnections(vector<HandoffConnection>& out)
+{
+    size_t first = out.size();
+    Reactor::exportConnections(out);
+
+    for (size_t i = first; i < out.size(); ++i)
+    {
+        auto it = sessions.find(out[i].fd);
+        if (it == sessions.end())
+            continue;
+
+        // Frames já entregues à sessão precedem o que sobrou no buffer
+        string frames;
+        for (auto& frame : it->second->frames)
+            SocketUtils::appendFrame(frames, out[i].framing, frame,
+                                     static_cast<uint8_t>(Protocol::peekMessageType(frame)));
+        out[i].readBuffer.insert(0, frames);
+    }
+
+    // As corrotinas suspensas são destruídas junto com as sessões
+    sessions.clear();
+}
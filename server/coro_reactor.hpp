@@ -0,0 +1,112 @@
+#pragma once
+
+#include "command_handler.hpp"
+#include "coro_task.hpp"
+#include "reactor.hpp"
+#include <coroutine>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Server;
+
+/**
+ * Classe CoroReactor
+ * ------------------
+ * Reactor epoll em que cada conexão é uma corrotina C++20 escrita de forma
+ * sequencial:
+ *
+ *     while (auto frame = co_await readFrame(fd))
+ *         co_await write(fd, handler.processCommand(*frame, fd));
+ *
+ * O reactor continua dono do socket (leitura edge-triggered, buffer de
+ * escrita, EPOLLOUT); as corrotinas só consomem frames e produzem respostas.
+ *
+ * Backpressure: write() suspende a sessão enquanto o buffer de saída estiver
+ * acima de WRITE_HIGH_WATERMARK, retomando abaixo de WRITE_LOW_WATERMARK. Com
+ * a sessão suspensa, frames novos se acumulam até MAX_PENDING_FRAMES e então
+ * a leitura do socket é pausada, empurrando a pressão de volta ao cliente.
+ */
+class CoroReactor : public Reactor
+{
+public:
+    CoroReactor(Server& server, int listen_fd);
+
+    const char* name() const override { return "epoll + corrotinas C++20"; }
+
+    /**
+     * Devolve ao buffer de leitura os frames que as sessões ainda não consumiram.
+     */
+    void exportConnections(std::vector<HandoffConnection>& out) override;
+
+    static constexpr size_t WRITE_HIGH_WATERMARK = OutboundQueue::HIGH_WATERMARK;
+    static constexpr size_t WRITE_LOW_WATERMARK = OutboundQueue::LOW_WATERMARK;
+    static constexpr size_t MAX_PENDING_FRAMES = 64;
+
+protected:
+    void dispatchFrame(int sockfd, std::string_view message) override;
+    void onConnectionOpened(int sockfd) override;
+    void onConnectionClosed(int sockfd) override;
+    void onWritable(int sockfd) override;
+
+private:
+    /**
+     * Estado compartilhado entre o reactor e a corrotina de uma conexão
+     */
+    struct Session
+    {
+        CoroTask task;
+        std::deque<std::string> frames;     // Frames recebidos ainda não consumidos
+        std::coroutine_handle<> reader;     // Suspensa em readFrame
+        std::coroutine_handle<> writer;     // Suspensa em write (acima do high watermark)
+        bool closed = false;
+    };
+
+    /**
+     * Awaitable de readFrame: pronto se houver frame (ou a conexão fechou).
+     */
+    struct FrameAwaiter
+    {
+        CoroReactor& reactor;
+        int sockfd;
+        Session& session;
+
+        bool await_ready() const { return !session.frames.empty() || session.closed; }
+        void await_suspend(std::coroutine_handle<> h) { session.reader = h; }
+        std::optional<std::string> await_resume();
+    };
+
+    /**
+     * Awaitable de write: a mensagem já foi enfileirada; suspende apenas se o
+     * buffer de saída passou do high watermark.
+     */
+    struct WriteAwaiter
+    {
+        CoroReactor& reactor;
+        int sockfd;
+        Session& session;
+
+        bool await_ready() const;
+        void await_suspend(std::coroutine_handle<> h) { session.writer = h; }
+        void await_resume() const {}
+    };
+
+    CommandHandler handler;
+    std::unordered_map<int, std::unique_ptr<Session>> sessions;
+
+    /**
+     * Lógica de uma conexão (uma corrotina por cliente).
+     */
+    CoroTask runSession(int sockfd, Session& session);
+
+    FrameAwaiter readFrame(int sockfd, Session& session) { return {*this, sockfd, session}; }
+    WriteAwaiter write(int sockfd, Session& session, const std::string& json_message);
+
+    /**
+     * Retoma a corrotina suspensa (se houver) e zera o handle antes.
+     */
+    static void resume(std::coroutine_handle<>& h);
+};
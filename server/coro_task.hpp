@@ -0,0 +1,69 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+/**
+ * Classe CoroTask
+ * ---------------
+ * Corrotina de sessão (C++20) iniciada imediatamente e retomada pelo loop de
+ * eventos. O frame da corrotina (alocado no heap, algumas centenas de bytes)
+ * substitui a pilha de uma thread por cliente. Ao terminar, a corrotina fica
+ * suspensa no ponto final até o dono destruir o CoroTask.
+ */
+class CoroTask
+{
+public:
+    struct promise_type
+    {
+        CoroTask get_return_object()
+        {
+            return CoroTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+
+        void unhandled_exception()
+        {
+            try
+            {
+                std::rethrow_exception(std::current_exception());
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "[Session] Erro na corrotina: " << e.what() << std::endl;
+            }
+        }
+    };
+
+    CoroTask() = default;
+    explicit CoroTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+    CoroTask(CoroTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+
+    CoroTask& operator=(CoroTask&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+
+    CoroTask(const CoroTask&) = delete;
+    CoroTask& operator=(const CoroTask&) = delete;
+
+    ~CoroTask()
+    {
+        if (handle) handle.destroy();
+    }
+
+    bool done() const { return !handle || handle.done(); }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "buffer_pool.hpp"
+#include "socket_utils.hpp"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Estrutura HandoffConnection
+ * ---------------------------
+ * Conexão transferida entre processos na atualização a quente: o socket
+ * (passado por SCM_RIGHTS) e os bytes ainda não processados/enviados.
+ */
+struct HandoffConnection
+{
+    int fd = -1;
+    std::string ip;
+    std::string readBuffer;     // Frames recebidos e ainda não executados + frame parcial
+    std::string writeBuffer;    // Bytes ainda não aceitos pelo socket
+    SocketUtils::Framing framing = SocketUtils::Framing::LINE;  // Vale para os dois buffers
+    SocketUtils::Encoding encoding = SocketUtils::Encoding::JSON;
+    SocketUtils::Compression compression = SocketUtils::Compression::NONE;
+    std::string deflateWindow;  // Histórico dos contextos de compressão (saída e entrada)
+    std::string inflateWindow;
+    bool greeted = false;       // Já passou do primeiro frame (HELLO não é mais aceito)
+};
+
+/**
+ * Interface IoBackend
+ * -------------------
+ * Contrato comum dos loops de I/O orientados a eventos do servidor
+ * (epoll, io_uring). O Server cria o backend escolhido na inicialização
+ * e encaminha para ele todas as escritas destinadas a clientes.
+ */
+class IoBackend
+{
+public:
+    /**
+     * Frames de uma conexão executados por vez antes de enviar as respostas
+     * (passada do modo threads, job do pool de comandos)
+     */
+    static constexpr size_t MAX_PIPELINE_DEPTH = 64;
+
+    /**
+     * Frames de uma conexão aguardando o pool antes de a leitura ser suspensa
+     * (retomada quando a fila cai à metade)
+     */
+    static constexpr size_t MAX_QUEUED_FRAMES = 4 * MAX_PIPELINE_DEPTH;
+
+    virtual ~IoBackend() = default;
+
+    /**
+     * Prepara os recursos do backend (epoll, anéis, buffers...).
+     * @return false se o backend não puder ser usado neste sistema
+     */
+    virtual bool init() = 0;
+
+    /**
+     * Executa o loop de eventos até stop() ser chamado.
+     */
+    virtual void run() = 0;
+
+    /**
+     * Sinaliza o encerramento do loop (seguro de qualquer thread).
+     */
+    virtual void stop() = 0;
+
+    /**
+     * Enfileira uma mensagem JSON (com framing) para o cliente.
+     * Seguro de qualquer thread: chamadas de fora do loop passam pela
+     * caixa de entrada (Mailbox) e são aplicadas pela thread do loop.
+     * @param conn_id Id da conexão registrado no servidor: se o fd já foi
+     *                fechado e reaproveitado por outro cliente, a mensagem é
+     *                descartada em vez de ir para a conexão nova
+     * @return false se o socket não pertence ao backend ou falhou
+     */
+    virtual bool send(int sockfd, uint64_t conn_id, std::string_view json_message) = 0;
+
+    /**
+     * Enfileira várias mensagens de uma vez (ex: fila offline entregue no
+     * login): uma única passagem pela caixa de entrada, uma verificação de
+     * limites e um flush para o lote inteiro.
+     */
+    virtual bool sendBatch(int sockfd, uint64_t conn_id, const std::vector<std::string_view>& messages)
+    {
+        for (std::string_view message : messages)
+            if (!send(sockfd, conn_id, message))
+                return false;
+        return true;
+    }
+
+    /**
+     * Nome do backend (para log).
+     */
+    virtual const char* name() const = 0;
+
+    // ==================== Atualização a quente ====================
+
+    /**
+     * Indica se o backend sabe exportar/adotar conexões (handoff).
+     */
+    virtual bool supportsHandoff() const { return false; }
+
+    /**
+     * Retira todas as conexões do backend sem fechá-las (após run() retornar).
+     * Os sockets continuam abertos e passam a pertencer ao chamador.
+     */
+    virtual void exportConnections(std::vector<HandoffConnection>& out) { (void)out; }
+
+    /**
+     * Assume uma conexão exportada por outro processo (antes de run()).
+     * @return false se a conexão não pôde ser registrada (o socket é fechado)
+     */
+    virtual bool adoptConnection(HandoffConnection&& conn) { (void)conn; return false; }
+};
+
+/**
+ * Classe Mailbox
+ * --------------
+ * Fila de escritas destinadas a conexões de um backend, postadas por outras
+ * threads (ex: um reactor roteando mensagem para cliente de outro reactor,
+ * ou um worker do pool devolvendo a resposta de um comando).
+ * O backend drena a fila na sua própria thread após ser acordado; a ordem
+ * de postagem é preservada. As mensagens são copiadas para blocos do
+ * BufferPool (liberados pela thread do loop, voltam pela reserva global).
+ *
+ * Cada item leva o id da conexão de destino além do fd: o backend descarta
+ * itens cujo id não é o da conexão que ocupa o fd ao drenar (fd fechado e
+ * reaproveitado pelo accept entre a postagem e a drenagem).
+ */
+class Mailbox
+{
+public:
+    struct Item
+    {
+        int sockfd;
+        uint64_t connId;
+        PooledString message;
+        bool completed;     // Fim do job do pool desta conexão (message = resposta, pode ser vazia)
+    };
+
+    void post(int sockfd, uint64_t conn_id, std::string_view json_message)
+    {
+        PooledString message(json_message);
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back({sockfd, conn_id, std::move(message), false});
+    }
+
+    void postBatch(int sockfd, uint64_t conn_id, const std::vector<std::string_view>& messages)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (std::string_view message : messages)
+            pending.push_back({sockfd, conn_id, PooledString(message), false});
+    }
+
+    /**
+     * Devolve a resposta de um comando executado no pool e libera a conexão
+     * para o próximo frame.
+     */
+    void complete(int sockfd, uint64_t conn_id, std::string_view response)
+    {
+        PooledString message(response);
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back({sockfd, conn_id, std::move(message), true});
+    }
+
+    std::vector<Item, PoolAllocator<Item>> take()
+    {
+        std::vector<Item, PoolAllocator<Item>> items;
+        std::lock_guard<std::mutex> lock(mutex);
+        items.swap(pending);
+        return items;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<Item, PoolAllocator<Item>> pending;
+};
@@ -0,0 +1,208 @@
+#include "io_uring.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <csignal>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// ==================== SYSCALLS ====================
+
+namespace
+{
+    int sysSetup(unsigned entries, io_uring_params* params)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int sysEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+                 const void* arg, size_t arg_size)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                                        flags, arg, arg_size));
+    }
+
+    int sysRegister(int fd, unsigned opcode, void* arg, unsigned nr_args)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+    }
+}
+
+// ==================== CICLO DE VIDA ====================
+
+IoUring::~IoUring()
+{
+    if (sqes) munmap(sqes, sqesSize);
+    if (cqRingPtr && cqRingPtr != sqRingPtr) munmap(cqRingPtr, cqRingSize);
+    if (sqRingPtr) munmap(sqRingPtr, sqRingSize);
+    if (ringFd >= 0) close(ringFd);
+}
+
+bool IoUring::init(unsigned entries)
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    ringFd = sysSetup(entries, &params);
+    if (ringFd < 0)
+    {
+        perror("[IoUring] Erro em io_uring_setup");
+        return false;
+    }
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap)
+    {
+        if (cqRingSize > sqRingSize) sqRingSize = cqRingSize;
+        cqRingSize = sqRingSize;
+    }
+
+    sqRingPtr = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (sqRingPtr == MAP_FAILED)
+    {
+        sqRingPtr = nullptr;
+        perror("[IoUring] Erro ao mapear SQ");
+        return false;
+    }
+
+    if (single_mmap)
+        cqRingPtr = sqRingPtr;
+    else
+    {
+        cqRingPtr = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        if (cqRingPtr == MAP_FAILED)
+        {
+            cqRingPtr = nullptr;
+            perror("[IoUring] Erro ao mapear CQ");
+            return false;
+        }
+    }
+
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes_ptr = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (sqes_ptr == MAP_FAILED)
+    {
+        perror("[IoUring] Erro ao mapear SQEs");
+        return false;
+    }
+    sqes = static_cast<io_uring_sqe*>(sqes_ptr);
+
+    char* sq = static_cast<char*>(sqRingPtr);
+    sqHead  = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail  = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask  = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sqEntries = params.sq_entries;
+
+    char* cq = static_cast<char*>(cqRingPtr);
+    cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes   = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    sqeTail = sqeFlushed = *sqTail;
+    return true;
+}
+
+// ==================== SUBMISSÃO ====================
+
+io_uring_sqe* IoUring::getSqe()
+{
+    unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+    if (sqeTail - head >= sqEntries)
+        return nullptr;
+
+    io_uring_sqe* sqe = &sqes[sqeTail & *sqMask];
+    memset(sqe, 0, sizeof(*sqe));
+    ++sqeTail;
+    return sqe;
+}
+
+unsigned IoUring::flushSq()
+{
+    unsigned tail = *sqTail;
+    unsigned to_submit = sqeTail - sqeFlushed;
+
+    for (unsigned i = 0; i < to_submit; ++i)
+    {
+        sqArray[tail & *sqMask] = sqeFlushed & *sqMask;
+        ++tail;
+        ++sqeFlushed;
+    }
+
+    __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+    return to_submit;
+}
+
+int IoUring::submit(unsigned wait_nr, int timeout_ms)
+{
+    unsigned to_submit = flushSq();
+    unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+
+    if (to_submit == 0 && wait_nr == 0)
+        return 0;
+
+    // Espera com prazo: o timespec segue no argumento estendido
+    __kernel_timespec ts{timeout_ms / 1000, (timeout_ms % 1000) * 1000000LL};
+    io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+    bool timed = wait_nr > 0 && timeout_ms >= 0;
+    if (timed)
+        flags |= IORING_ENTER_EXT_ARG;
+
+    while (true)
+    {
+        int ret = timed ? sysEnter(ringFd, to_submit, wait_nr, flags, &arg, sizeof(arg))
+                        : sysEnter(ringFd, to_submit, wait_nr, flags, nullptr, 0);
+        if (ret < 0 && errno == EINTR)
+        {
+            // Sinal recebido: reenvia apenas o que o kernel ainda não consumiu
+            to_submit = sqeFlushed - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+            continue;
+        }
+        return ret < 0 ? -errno : ret;
+    }
+}
+
+// ==================== CONCLUSÃO ====================
+
+io_uring_cqe* IoUring::peekCqe()
+{
+    unsigned head = *cqHead;
+    unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+    if (head == tail)
+        return nullptr;
+    return &cqes[head & *cqMask];
+}
+
+void IoUring::cqeSeen()
+{
+    __atomic_store_n(cqHead, *cqHead + 1, __ATOMIC_RELEASE);
+}
+
+// ==================== BUFFERS FORNECIDOS ====================
+
+bool IoUring::registerBufferRing(io_uring_buf_ring* ring, unsigned ring_entries, uint16_t bgid)
+{
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+    reg.ring_entries = ring_entries;
+    reg.bgid = bgid;
+
+    if (sysRegister(ringFd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    {
+        perror("[IoUring] Erro ao registrar anel de buffers");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <linux/io_uring.h>
+
+/**
+ * Classe IoUring
+ * --------------
+ * Invólucro mínimo sobre as syscalls do io_uring (sem depender da liburing):
+ * criação do anel, obtenção de SQEs, submissão em lote e leitura de CQEs,
+ * além do registro de anéis de buffers fornecidos (provided buffer rings).
+ */
+class IoUring
+{
+public:
+    IoUring() = default;
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    /**
+     * Cria o anel com o número de entradas indicado.
+     * @return false se o kernel não suportar io_uring (ou estiver bloqueado)
+     */
+    bool init(unsigned entries);
+
+    /**
+     * Obtém uma SQE livre (zerada). Retorna nullptr se a fila estiver cheia;
+     * nesse caso chame submit() e tente novamente.
+     */
+    io_uring_sqe* getSqe();
+
+    /**
+     * Submete todas as SQEs pendentes numa única chamada io_uring_enter,
+     * aguardando ao menos wait_nr conclusões.
+     * @param timeout_ms Espera máxima pelas conclusões (-1 = sem limite), via
+     *                   IORING_ENTER_EXT_ARG (5.11+, anterior aos anéis de
+     *                   buffers fornecidos que o backend já exige)
+     * @return número de SQEs consumidas pelo kernel, ou -errno (-ETIME se o
+     *         prazo venceu)
+     */
+    int submit(unsigned wait_nr = 0, int timeout_ms = -1);
+
+    /**
+     * Retorna a próxima CQE disponível (sem bloquear) ou nullptr.
+     * Após processá-la, chame cqeSeen().
+     */
+    io_uring_cqe* peekCqe();
+    void cqeSeen();
+
+    /**
+     * Registra um anel de buffers fornecidos no grupo bgid.
+     * @param ring Memória alinhada a página com ring_entries entradas
+     */
+    bool registerBufferRing(io_uring_buf_ring* ring, unsigned ring_entries, uint16_t bgid);
+
+    int fd() const { return ringFd; }
+
+private:
+    int ringFd = -1;
+
+    // Fila de submissão
+    void* sqRingPtr = nullptr;
+    size_t sqRingSize = 0;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqEntries = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+    unsigned sqeTail = 0;      // Próxima SQE a entregar ao chamador
+    unsigned sqeFlushed = 0;   // SQEs já publicadas no tail do kernel
+
+    // Fila de conclusão
+    void* cqRingPtr = nullptr;
+    size_t cqRingSize = 0;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    /**
+     * Publica as SQEs preparadas no tail do kernel.
+     * @return quantidade publicada
+     */
+    unsigned flushSq();
+};
@@ -1,21 +1,87 @@
 #include "server.hpp"
 #include <cstring>
 #include <iostream>
+#include <stdexcept>
+#include <string>
 
 const int DEFAULT_PORT = 12345;
 
+/**
+ * Converte o nome do modo de I/O informado na linha de comando.
+ */
+static IoMode parseIoMode(const std::string& name)
+{
+    if (name == "epoll") return IoMode::EPOLL;
+    if (name == "uring") return IoMode::URING;
+    if (name == "threads") return IoMode::THREADS;
+    if (name == "sharded") return IoMode::SHARDED;
+    if (name == "coro") return IoMode::COROUTINES;
+    throw std::invalid_argument("Modo de I/O desconhecido: " + name + " (use epoll, uring, sharded, coro ou threads)");
+}
+
+/**
+ * Converte a política de consumidor lento informada na linha de comando.
+ */
+static SlowConsumerPolicy parseSlowConsumerPolicy(const std::string& name)
+{
+    if (name == "disconnect") return SlowConsumerPolicy::DISCONNECT;
+    if (name == "offline") return SlowConsumerPolicy::OFFLINE;
+    if (name == "drop-oldest") return SlowConsumerPolicy::DROP_OLDEST;
+    throw std::invalid_argument("Política desconhecida: " + name + " (use disconnect, offline ou drop-oldest)");
+}
+
 int main(int argc, char* argv[])
 {
     try
     {
-        int port = DEFAULT_PORT;
-        
-        // Argumento: ./server [porta]
-        if (argc > 1)
-            port = std::stoi(argv[1]);
-        
-        std::cout << "Iniciando SERVIDOR na porta TCP: " << port << std::endl;
-        Server server(port);
+        ServerConfig config;
+        config.port = DEFAULT_PORT;
+
+        // Argumentos: ./server [porta] [--mode epoll|uring|sharded|coro|threads] [--reactors N] [--pin-cpus]
+        //             [--workers N] [--worker-queue N] [--metrics-interval S]
+        //             [--idle-timeout S] [--login-timeout S] [--write-timeout S] [--keepalive S]
+        //             [--slow-consumer disconnect|offline|drop-oldest] [--outbound-limit BYTES]
+        //             [--outbound-max-age S] [--upgrade-socket PATH] [--takeover PATH]
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+
+            if (arg == "--mode" && i + 1 < argc)
+                config.ioMode = parseIoMode(argv[++i]);
+            else if (arg == "--reactors" && i + 1 < argc)
+                config.reactors = std::stoi(argv[++i]);
+            else if (arg == "--pin-cpus")
+                config.pinCpus = true;
+            else if (arg == "--workers" && i + 1 < argc)
+                config.workers = std::stoi(argv[++i]);
+            else if (arg == "--worker-queue" && i + 1 < argc)
+                config.workerQueue = std::stoi(argv[++i]);
+            else if (arg == "--metrics-interval" && i + 1 < argc)
+                config.metricsInterval = std::stoi(argv[++i]);
+            else if (arg == "--idle-timeout" && i + 1 < argc)
+                config.timeouts.idleSeconds = std::stoi(argv[++i]);
+            else if (arg == "--login-timeout" && i + 1 < argc)
+                config.timeouts.loginSeconds = std::stoi(argv[++i]);
+            else if (arg == "--write-timeout" && i + 1 < argc)
+                config.timeouts.writeStallSeconds = std::stoi(argv[++i]);
+            else if (arg == "--keepalive" && i + 1 < argc)
+                config.timeouts.keepAliveSeconds = std::stoi(argv[++i]);
+            else if (arg == "--slow-consumer" && i + 1 < argc)
+                config.slowConsumer.policy = parseSlowConsumerPolicy(argv[++i]);
+            else if (arg == "--outbound-limit" && i + 1 < argc)
+                config.slowConsumer.maxBytes = std::stoul(argv[++i]);
+            else if (arg == "--outbound-max-age" && i + 1 < argc)
+                config.slowConsumer.maxAgeSeconds = std::stoi(argv[++i]);
+            else if (arg == "--upgrade-socket" && i + 1 < argc)
+                config.upgradeSocket = argv[++i];
+            else if (arg == "--takeover" && i + 1 < argc)
+                config.takeoverSocket = argv[++i];
+            else
+                config.port = std::stoi(arg);
+        }
+
+        std::cout << "Iniciando SERVIDOR na porta TCP: " << config.port << std::endl;
+        Server server(config);
         server.run(); // Bloqueia aqui
     }
     catch (const std::exception& e)
@@ -24,4 +90,4 @@ int main(int argc, char* argv[])
         return 1;
     }
     return 0;
-}
\ No newline at end of file
+}
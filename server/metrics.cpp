@@ -0,0 +1,47 @@
+#include "metrics.hpp"
+#include <sstream>
+
+using namespace std;
+
+atomic<uint64_t>& Metrics::counter(const string& name, const string& help)
+{
+    lock_guard<mutex> lock(registryMutex);
+
+    auto it = entries.find(name);
+    if (it == entries.end())
+    {
+        Entry entry{help, true, make_unique<atomic<uint64_t>>(0), nullptr};
+        it = entries.emplace(name, std::move(entry)).first;
+    }
+    return *it->second.value;
+}
+
+void Metrics::counter(const string& name, const string& help, function<double()> read)
+{
+    lock_guard<mutex> lock(registryMutex);
+    entries[name] = Entry{help, true, nullptr, std::move(read)};
+}
+
+void Metrics::gauge(const string& name, const string& help, function<double()> read)
+{
+    lock_guard<mutex> lock(registryMutex);
+    entries[name] = Entry{help, false, nullptr, std::move(read)};
+}
+
+string Metrics::render() const
+{
+    lock_guard<mutex> lock(registryMutex);
+    ostringstream out;
+
+    for (const auto& [name, entry] : entries)
+    {
+        out << "# HELP " << name << " " << entry.help << "\n";
+        out << "# TYPE " << name << (entry.isCounter ? " counter" : " gauge") << "\n";
+        if (entry.value)
+            out << name << " " << entry.value->load(memory_order_relaxed) << "\n";
+        else
+            out << name << " " << entry.read() << "\n";
+    }
+
+    return out.str();
+}
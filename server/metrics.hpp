@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * Classe Metrics
+ * --------------
+ * Registro de métricas do servidor, exportado no formato de texto do
+ * Prometheus. Contadores são atômicos (incremento barato em qualquer thread);
+ * gauges são lidos por callback no momento da exportação.
+ */
+class Metrics
+{
+public:
+    /**
+     * Obtém (ou cria) um contador monotônico. A referência é estável.
+     */
+    std::atomic<uint64_t>& counter(const std::string& name, const std::string& help);
+
+    /**
+     * Registra um contador mantido por outro componente, lido sob demanda.
+     * O callback deve permanecer válido enquanto o registro existir.
+     */
+    void counter(const std::string& name, const std::string& help, std::function<double()> read);
+
+    /**
+     * Registra um gauge lido sob demanda.
+     * O callback deve permanecer válido enquanto o registro existir.
+     */
+    void gauge(const std::string& name, const std::string& help, std::function<double()> read);
+
+    /**
+     * Exporta todas as métricas (formato de exposição em texto do Prometheus).
+     */
+    std::string render() const;
+
+private:
+    struct Entry
+    {
+        std::string help;
+        bool isCounter;
+        std::unique_ptr<std::atomic<uint64_t>> value;
+        std::function<double()> read;
+    };
+
+    mutable std::mutex registryMutex;
+    std::map<std::string, Entry> entries;
+};
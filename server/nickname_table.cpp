@@ -0,0 +1,40 @@
+#include "nickname_table.hpp"
+
+UserId NicknameTable::find(std::string_view nickname) const
+{
+    auto it = ids.find(nickname);
+    return it != ids.end() ? it->second : NO_USER;
+}
+
+UserId NicknameTable::intern(std::string_view nickname)
+{
+    UserId id = find(nickname);
+    if (id != NO_USER)
+        return id;
+
+    if (!freeIds.empty())
+    {
+        id = freeIds.back();
+        freeIds.pop_back();
+        names[id] = nickname;
+    }
+    else
+    {
+        id = static_cast<UserId>(names.size());
+        names.emplace_back(nickname);
+    }
+
+    // A chave aponta para a cópia guardada, não para o buffer da requisição
+    ids.emplace(names[id], id);
+    return id;
+}
+
+void NicknameTable::release(UserId id)
+{
+    if (!contains(id))
+        return;
+
+    ids.erase(names[id]);
+    std::string().swap(names[id]);
+    freeIds.push_back(id);
+}
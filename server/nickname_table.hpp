@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Identificador denso de um usuário registrado: índice do estado indexado
+ * por usuário (cadastro, sessões, filas offline)
+ */
+using UserId = uint32_t;
+
+constexpr UserId NO_USER = UINT32_MAX;
+
+/**
+ * Classe NicknameTable
+ * --------------------
+ * Internação dos apelidos registrados: cada apelido é guardado uma única vez
+ * e ganha um UserId denso (0, 1, 2, ...). O estado do servidor é indexado
+ * pelo id, então as rotas comparam e copiam inteiros em vez de strings; o
+ * apelido só volta a ser string nas bordas do protocolo (name() devolve uma
+ * view para montar DELIVER_MSG, LOGIN_OK e USERS).
+ *
+ * find() consulta direto com a view da requisição, sem montar std::string.
+ * Ids de usuários removidos são reaproveitados pelo próximo registro (quem
+ * indexa estado pelo id limpa a vaga antes de chamar release()).
+ *
+ * Não é thread-safe: protegida pelo mesmo lock do estado que indexa.
+ */
+class NicknameTable
+{
+public:
+    /**
+     * Id do apelido, ou NO_USER se ele não está registrado
+     */
+    UserId find(std::string_view nickname) const;
+
+    /**
+     * Id do apelido, registrando-o se ainda não existe
+     */
+    UserId intern(std::string_view nickname);
+
+    /**
+     * Libera o apelido e o id (o id passa a valer para o próximo registro)
+     */
+    void release(UserId id);
+
+    bool contains(UserId id) const { return id < names.size() && !names[id].empty(); }
+    std::string_view name(UserId id) const { return names[id]; }
+
+    /**
+     * Apelidos registrados e limite dos ids (maior id já usado + 1)
+     */
+    size_t size() const { return ids.size(); }
+    UserId idLimit() const { return static_cast<UserId>(names.size()); }
+
+private:
+    std::unordered_map<std::string_view, UserId> ids;   // Views para 'names'
+    std::deque<std::string> names;                      // Id -> apelido (vazio = id livre); deque: endereços estáveis
+    std::vector<UserId> freeIds;
+};
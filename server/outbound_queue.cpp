@@ -0,0 +1,265 @@
+#include "outbound_queue.hpp"
+#include "protocol.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sys/socket.h>
+
+using namespace std;
+
+namespace
+{
+    // Frames por writev: uma rajada (ex: fila offline na entrega do login) sai em poucas syscalls
+    constexpr size_t MAX_IOVECS = SocketUtils::MAX_BATCH_IOVECS;
+
+    uint64_t monotonicMs()
+    {
+        return chrono::duration_cast<chrono::milliseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+// ==================== CONSTRUTOR ====================
+
+OutboundQueue::OutboundQueue(size_t high, size_t low)
+    : framing(SocketUtils::Framing::LINE), encoding(SocketUtils::Encoding::JSON), headOffset(0), totalBytes(0),
+      highWatermark(high), lowWatermark(low), isCongested(false) {}
+
+// ==================== ENFILEIRAMENTO ====================
+
+void OutboundQueue::push(string_view message)
+{
+    PooledString frame;
+    if (framing == SocketUtils::Framing::LENGTH)
+    {
+        // Mensagem montada na codificação da conexão (encode* com a codificação)
+        // segue como está; JSON de quem não a conhece (ex: fila offline) é convertido
+        string binary;
+        string_view payload = message;
+        uint8_t type;
+        if (encoding != SocketUtils::Encoding::JSON && Protocol::detectEncoding(message) == encoding)
+            type = static_cast<uint8_t>(Protocol::peekMessageType(message, encoding));
+        else
+        {
+            if (encoding != SocketUtils::Encoding::JSON)
+                payload = binary = Protocol::toWire(message, encoding);
+            type = static_cast<uint8_t>(Protocol::peekMessageType(message));
+        }
+
+        // Mensagens pequenas seguem cruas: sem CPU e sem latência a mais. Se o
+        // zlib falhar também (frames crus não passam pelo contexto do peer)
+        string compressed;
+        if (deflater && payload.size() >= SocketUtils::MIN_COMPRESSED_SIZE &&
+            deflater->compress(payload, compressed))
+        {
+            payload = compressed;
+            type |= SocketUtils::COMPRESSED_FRAME_FLAG;
+        }
+
+        char header[SocketUtils::FRAME_HEADER_SIZE];
+        SocketUtils::writeFrameHeader(header, payload.size(), type);
+        frame.reserve(sizeof(header) + payload.size());
+        frame.append(header, sizeof(header));
+        frame.append(payload);
+    }
+    else
+    {
+        frame.reserve(message.size() + 1);
+        frame.append(message);
+        frame.push_back('\n');
+    }
+
+    totalBytes += frame.size();
+    queue.push_back({std::move(frame), monotonicMs()});
+    updateWatermark();
+}
+
+void OutboundQueue::pushBytes(string_view bytes)
+{
+    if (bytes.empty())
+        return;
+
+    totalBytes += bytes.size();
+    queue.push_back({PooledString(bytes), monotonicMs()});
+    updateWatermark();
+}
+
+// ==================== COMPRESSÃO ====================
+
+void OutboundQueue::setCompression(SocketUtils::Compression mode)
+{
+    if (mode == SocketUtils::Compression::NONE)
+        deflater.reset();
+    else if (!deflater)
+        deflater = make_unique<DeflateStream>();
+}
+
+string OutboundQueue::compressionWindow() const
+{
+    return deflater ? deflater->window() : string();
+}
+
+bool OutboundQueue::setCompressionWindow(string_view window)
+{
+    return deflater && deflater->setWindow(window);
+}
+
+// ==================== ENVIO ====================
+
+size_t OutboundQueue::gather(iovec* iov, size_t max_iov) const
+{
+    size_t count = 0;
+    for (auto it = queue.begin(); it != queue.end() && count < max_iov; ++it, ++count)
+    {
+        size_t skip = count == 0 ? headOffset : 0;
+        iov[count].iov_base = const_cast<char*>(it->data.data()) + skip;
+        iov[count].iov_len = it->data.size() - skip;
+    }
+    return count;
+}
+
+void OutboundQueue::consume(size_t bytes, FlushResult& result)
+{
+    result.bytes += bytes;
+    totalBytes -= bytes;
+
+    // Descarta os frames concluídos e avança no primeiro parcial
+    while (bytes > 0)
+    {
+        size_t left = queue.front().data.size() - headOffset;
+        if (bytes < left)
+        {
+            headOffset += bytes;
+            break;
+        }
+
+        bytes -= left;
+        queue.pop_front();
+        headOffset = 0;
+        ++result.frames;
+    }
+
+    updateWatermark();
+}
+
+OutboundQueue::FlushResult OutboundQueue::flush(int sockfd)
+{
+    FlushResult result;
+    iovec iov[MAX_IOVECS];
+
+    while (!queue.empty())
+    {
+        // Agrupa os frames da frente num único writev
+        size_t count = gather(iov, MAX_IOVECS);
+        size_t batch = 0;
+        for (size_t i = 0; i < count; ++i)
+            batch += iov[i].iov_len;
+
+        // sendmsg em vez de writev: MSG_NOSIGNAL evita SIGPIPE com o peer fechado
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        ssize_t sent = sendmsg(sockfd, &msg, MSG_NOSIGNAL);
+
+        if (sent < 0)
+        {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+
+            cerr << "[SocketUtils] Erro ao enviar: " << strerror(errno) << endl;
+            result.ok = false;
+            break;
+        }
+
+        ++result.syscalls;
+        consume(static_cast<size_t>(sent), result);
+
+        // Envio parcial: o socket encheu
+        if (static_cast<size_t>(sent) < batch)
+            break;
+    }
+
+    return result;
+}
+
+// ==================== LIMITES ====================
+
+bool OutboundQueue::tooOld(uint64_t max_age_ms, uint64_t now_ms) const
+{
+    return max_age_ms > 0 && !queue.empty() && now_ms - queue.front().enqueuedMs > max_age_ms;
+}
+
+bool OutboundQueue::exceeds(size_t max_bytes, uint64_t max_age_ms) const
+{
+    return (max_bytes > 0 && totalBytes > max_bytes) || tooOld(max_age_ms, monotonicMs());
+}
+
+size_t OutboundQueue::dropOldest(size_t max_bytes, uint64_t max_age_ms, size_t keep_front)
+{
+    // O frame parcialmente enviado não pode sair: o peer já recebeu o começo dele
+    size_t keep = max(keep_front, static_cast<size_t>(headOffset > 0 ? 1 : 0));
+    uint64_t now = monotonicMs();
+
+    // Conta os descartes antes de mexer na fila: cada frame sai uma vez só
+    size_t end = keep;
+    while (end < queue.size())
+    {
+        const Frame& oldest = queue[end];
+        bool over_bytes = max_bytes > 0 && totalBytes > max_bytes;
+        bool over_age = max_age_ms > 0 && now - oldest.enqueuedMs > max_age_ms;
+        if (!over_bytes && !over_age)
+            break;
+
+        totalBytes -= oldest.data.size();
+        ++end;
+    }
+    size_t dropped = end - keep;
+
+    if (keep == 0)
+    {
+        for (size_t i = 0; i < dropped; ++i)
+            queue.pop_front();
+    }
+    else if (dropped > 0)
+    {
+        // Desloca só os de trás: os frames da frente podem estar apontados
+        // por um envio em andamento (deque::erase no meio poderia movê-los)
+        std::move(queue.begin() + end, queue.end(), queue.begin() + keep);
+        queue.erase(queue.end() - dropped, queue.end());
+    }
+
+    updateWatermark();
+    return dropped;
+}
+
+// ==================== ESVAZIAMENTO ====================
+
+string OutboundQueue::take()
+{
+    string bytes;
+    bytes.reserve(totalBytes);
+    for (size_t i = 0; i < queue.size(); ++i)
+        bytes.append(string_view(queue[i].data).substr(i == 0 ? headOffset : 0));
+    clear();
+    return bytes;
+}
+
+void OutboundQueue::clear()
+{
+    queue.clear();
+    headOffset = 0;
+    totalBytes = 0;
+    updateWatermark();
+}
+
+// ==================== WATERMARKS ====================
+
+void OutboundQueue::updateWatermark()
+{
+    if (!isCongested && totalBytes > highWatermark)
+        isCongested = true;
+    else if (isCongested && totalBytes <= lowWatermark)
+        isCongested = false;
+}
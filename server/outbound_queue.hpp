@@ -0,0 +1,158 @@
+#pragma once
+
+#include "buffer_pool.hpp"
+#include "compression.hpp"
+#include "socket_utils.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <sys/uio.h>
+
+/**
+ * Classe OutboundQueue
+ * --------------------
+ * Fila de saída de uma conexão: frames prontos (com framing) aguardando
+ * espaço no socket. flush() envia vários frames por syscall com writev,
+ * de modo que uma rajada de DELIVER_MSG pequenos vira uma única escrita.
+ *
+ * A fila acompanha os watermarks com histerese: fica congestionada ao
+ * passar de 'high' bytes e só deixa de estar abaixo de 'low'. Quem roteia
+ * mensagens consulta esse estado (Server::isCongested) para não empilhar
+ * mais dados num cliente que não está lendo.
+ *
+ * Cada frame guarda o instante em que entrou, para os limites de consumidor
+ * lento (bytes e idade do frame mais antigo, ver Server::enforceOutboundLimits).
+ * Os frames e os blocos da fila saem do BufferPool.
+ *
+ * Com compressão DEFLATE, push() comprime o payload no contexto da conexão
+ * (ver compression.hpp): os frames enfileirados fazem parte do histórico do
+ * peer e não podem mais ser descartados.
+ *
+ * Não é thread-safe: pertence à thread dona da conexão.
+ */
+class OutboundQueue
+{
+public:
+    static constexpr size_t HIGH_WATERMARK = 64 * 1024;
+    static constexpr size_t LOW_WATERMARK = 16 * 1024;
+
+    /**
+     * Resultado de um flush()
+     */
+    struct FlushResult
+    {
+        bool ok = true;         // false em erro fatal no socket
+        size_t bytes = 0;       // Bytes aceitos pelo kernel
+        size_t frames = 0;      // Frames concluídos
+        size_t syscalls = 0;    // Chamadas writev realizadas
+    };
+
+    explicit OutboundQueue(size_t high = HIGH_WATERMARK, size_t low = LOW_WATERMARK);
+
+    /**
+     * Enfileira uma mensagem no framing da conexão ('\n' ou cabeçalho): JSON
+     * ou já na codificação da conexão.
+     */
+    void push(std::string_view message);
+
+    /**
+     * Framing das próximas mensagens (as já enfileiradas não mudam).
+     */
+    void setFraming(SocketUtils::Framing mode) { framing = mode; }
+    SocketUtils::Framing getFraming() const { return framing; }
+
+    /**
+     * Codificação das próximas mensagens: push() converte o JSON antes de
+     * enquadrar; mensagens que já chegam nesta codificação seguem como estão.
+     */
+    void setEncoding(SocketUtils::Encoding mode) { encoding = mode; }
+    SocketUtils::Encoding getEncoding() const { return encoding; }
+
+    /**
+     * Compressão das próximas mensagens (cria o contexto deflate vazio).
+     */
+    void setCompression(SocketUtils::Compression mode);
+    SocketUtils::Compression getCompression() const
+    {
+        return deflater ? SocketUtils::Compression::DEFLATE : SocketUtils::Compression::NONE;
+    }
+
+    /**
+     * Histórico do contexto de compressão (vazio sem compressão), para o handoff.
+     */
+    std::string compressionWindow() const;
+    bool setCompressionWindow(std::string_view window);
+
+    /**
+     * Enfileira bytes já com framing (ex: saída herdada no handoff).
+     */
+    void pushBytes(std::string_view bytes);
+
+    /**
+     * Envia o máximo possível sem bloquear (até esvaziar ou EAGAIN).
+     */
+    FlushResult flush(int sockfd);
+
+    /**
+     * Preenche iov com os frames da frente (para um envio assíncrono).
+     * Os frames apontados não mudam até consume().
+     * @return Número de entradas preenchidas
+     */
+    size_t gather(iovec* iov, size_t max_iov) const;
+
+    /**
+     * Descarta da frente os bytes confirmados pelo kernel.
+     */
+    void consume(size_t bytes, FlushResult& result);
+
+    /**
+     * Indica se a fila passou de max_bytes ou se o frame mais antigo
+     * espera há mais de max_age_ms (0 = sem limite).
+     */
+    bool exceeds(size_t max_bytes, uint64_t max_age_ms) const;
+
+    /**
+     * Descarta frames inteiros a partir da frente até voltar aos limites,
+     * preservando os 'keep_front' primeiros (em envio) e um frame parcial.
+     * @return Frames descartados
+     */
+    size_t dropOldest(size_t max_bytes, uint64_t max_age_ms, size_t keep_front);
+
+    /**
+     * Remove e devolve todos os bytes ainda não enviados.
+     */
+    std::string take();
+
+    void clear();
+
+    size_t bytes() const { return totalBytes; }
+    size_t frames() const { return queue.size(); }
+    bool empty() const { return queue.empty(); }
+
+    /**
+     * Acima do high watermark (até voltar abaixo do low).
+     */
+    bool congested() const { return isCongested; }
+
+private:
+    struct Frame
+    {
+        PooledString data;
+        uint64_t enqueuedMs;    // Relógio monotônico
+    };
+
+    PooledDeque<Frame> queue;
+    SocketUtils::Framing framing;
+    SocketUtils::Encoding encoding;
+    std::unique_ptr<DeflateStream> deflater;
+    size_t headOffset;      // Bytes do primeiro frame já enviados
+    size_t totalBytes;      // Bytes pendentes (descontado headOffset)
+    size_t highWatermark;
+    size_t lowWatermark;
+    bool isCongested;
+
+    void updateWatermark();
+    bool tooOld(uint64_t max_age_ms, uint64_t now_ms) const;
+};
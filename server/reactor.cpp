@@ -0,0 +1,750 @@
+#include "reactor.hpp"
+#include "protocol.hpp"
+#include "server.hpp"
+#include "socket_utils.hpp"
+#include "worker_pool.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <utility>
+#include <iostream>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace
+{
+    constexpr int MAX_EVENTS = 256;
+}
+
+// ==================== CONSTRUTOR/DESTRUTOR ====================
+
+Reactor::Reactor(Server& server, int listen_fd)
+    : server(server), handler(server), listenFd(listen_fd), epollFd(-1), wakeFd(-1), running(false),
+      pool(nullptr), nextConnId(1),
+      writevCalls(server.getMetrics().counter("chat_outbound_writev_total",
+                                              "Chamadas writev nas filas de saida")),
+      framesFlushed(server.getMetrics().counter("chat_outbound_frames_total",
+                                                "Frames enviados pelas filas de saida")) {}
+
+Reactor::~Reactor()
+{
+    for (auto& [fd, conn] : connections)
+    {
+        int sockfd = fd;
+        SocketUtils::closeSocket(sockfd);
+    }
+    connections.clear();
+
+    if (wakeFd >= 0) close(wakeFd);
+    if (epollFd >= 0) close(epollFd);
+}
+
+// ==================== INICIALIZAÇÃO ====================
+
+bool Reactor::init()
+{
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0)
+    {
+        perror("[Reactor] Erro ao criar epoll");
+        return false;
+    }
+
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0)
+    {
+        perror("[Reactor] Erro ao criar eventfd");
+        return false;
+    }
+
+    if (!SocketUtils::setNonBlocking(listenFd))
+        return false;
+
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = listenFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev) < 0)
+    {
+        perror("[Reactor] Erro ao registrar socket de escuta");
+        return false;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev) < 0)
+    {
+        perror("[Reactor] Erro ao registrar eventfd");
+        return false;
+    }
+
+    return true;
+}
+
+// ==================== LOOP DE EVENTOS ====================
+
+void Reactor::run()
+{
+    running = true;
+    loopThread = this_thread::get_id();
+    epoll_event events[MAX_EVENTS];
+
+    while (running)
+    {
+        // Flushes agendados durante o próprio flush (entrega de desviadas) não esperam eventos
+        int timeout = pendingFlushes.empty() ? timers.nextTimeoutMs() : 0;
+        int n = epoll_wait(epollFd, events, MAX_EVENTS, timeout);
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            perror("[Reactor] Erro em epoll_wait");
+            break;
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            int fd = events[i].data.fd;
+            uint32_t mask = events[i].events;
+
+            if (fd == listenFd)
+            {
+                acceptConnections();
+                continue;
+            }
+
+            if (fd == wakeFd)
+            {
+                uint64_t value;
+                while (read(wakeFd, &value, sizeof(value)) > 0) {}
+                drainMailbox();
+                onWake();
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end())
+                continue;
+            Connection& conn = *it->second;
+            if (conn.detached)
+                continue;
+
+            if (mask & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                handleReadable(conn);
+
+            if (!conn.closing && (mask & EPOLLOUT) && !conn.outbound.empty())
+            {
+                if (!flush(conn))
+                {
+                    closeConnection(fd, "Erro ao enviar");
+                    continue;
+                }
+                onWritable(fd);
+            }
+
+            if (conn.closing)
+                closeAfterFlush(conn, "Conexão encerrada");
+        }
+
+        // Leituras retomadas: edge-triggered não sinaliza de novo o que já chegou
+        for (int fd : std::exchange(resumedReads, {}))
+        {
+            auto it = connections.find(fd);
+            if (it == connections.end() || it->second->detached)
+                continue;
+
+            handleReadable(*it->second);
+            if (it->second->closing)
+                closeAfterFlush(*it->second, "Conexão encerrada");
+        }
+
+        flushPending();
+
+        timers.advance([this](TimerNode& timer) { onTimer(timer); });
+
+        afterEvents();
+    }
+}
+
+void Reactor::stop()
+{
+    running = false;
+    wake();
+}
+
+void Reactor::wake()
+{
+    if (wakeFd >= 0)
+    {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+void Reactor::drainMailbox()
+{
+    for (auto& item : mailbox.take())
+    {
+        // Conexão fechada depois da postagem (o fd pode já ser de outro cliente)
+        auto it = connections.find(item.sockfd);
+        if (it == connections.end() || it->second->id != item.connId)
+            continue;
+
+        Connection& conn = *it->second;
+        if (conn.closing)
+        {
+            // Fora do epoll: as respostas dos frames recebidos antes do EOF
+            // ficam na fila e saem no fechamento
+            if (!item.message.empty() && !conn.evicted)
+                conn.outbound.push(item.message);
+        }
+        else if (!item.message.empty())
+            send(item.sockfd, item.connId, item.message);
+
+        if (!item.completed)
+            continue;
+
+        // Fim do job: os frames recebidos antes do EOF ainda são executados
+        conn.busy = false;
+        scheduleFrames(conn);
+        if (conn.closing && !conn.busy)
+            closeAfterFlush(conn, "Conexão encerrada");
+        else if (conn.readPaused && conn.pendingFrames.size() < MAX_QUEUED_FRAMES / 2)
+            setReadPaused(conn.fd, false);
+    }
+}
+
+void Reactor::scheduleFrames(Connection& conn)
+{
+    if (conn.busy || conn.pendingFrames.empty())
+        return;
+
+    // Pipelining: um job leva até MAX_PIPELINE_DEPTH frames, executados em ordem
+    size_t depth = std::min(conn.pendingFrames.size(), MAX_PIPELINE_DEPTH);
+    PooledDeque<PooledString> frames(std::make_move_iterator(conn.pendingFrames.begin()),
+                                     std::make_move_iterator(conn.pendingFrames.begin() + depth));
+    conn.pendingFrames.erase(conn.pendingFrames.begin(), conn.pendingFrames.begin() + depth);
+    conn.busy = true;
+
+    // As respostas voltam pela caixa de entrada, na ordem das escritas do handler,
+    // e saem no mesmo flush (um único wake por job)
+    int sockfd = conn.fd;
+    uint64_t conn_id = conn.id;
+    SocketUtils::Encoding encoding = conn.outbound.getEncoding();
+    pool->submit([this, sockfd, conn_id, encoding, frames = std::move(frames)]
+    {
+        for (size_t i = 0; i + 1 < frames.size(); ++i)
+        {
+            string response = handler.processCommand(frames[i], sockfd, encoding);
+            if (!response.empty())
+                mailbox.post(sockfd, conn_id, response);
+        }
+        mailbox.complete(sockfd, conn_id, handler.processCommand(frames.back(), sockfd, encoding));
+        wake();
+    });
+}
+
+// ==================== TIMERS ====================
+
+void Reactor::armTimer(TimerNode& timer, int seconds)
+{
+    if (seconds > 0)
+        timers.schedule(timer, static_cast<uint64_t>(seconds) * 1000);
+}
+
+void Reactor::onTimer(TimerNode& timer)
+{
+    auto it = connections.find(timer.data);
+    if (it == connections.end() || it->second->detached)
+        return;
+
+    switch (timer.kind)
+    {
+        case IDLE_TIMER:
+            closeConnection(timer.data, "Timeout de inatividade");
+            break;
+
+        case LOGIN_TIMER:
+            if (!isAuthenticated(timer.data))
+                closeConnection(timer.data, "Login não realizado no prazo");
+            break;
+
+        case WRITE_STALL_TIMER:
+            closeConnection(timer.data, "Escrita travada (cliente não lê)");
+            break;
+    }
+}
+
+bool Reactor::isAuthenticated(int sockfd)
+{
+    lock_guard<mutex> lock(server.getStateMutex());
+    return server.getFdToUser().count(sockfd) > 0;
+}
+
+// ==================== ACEITAÇÃO ====================
+
+Reactor::Connection* Reactor::addConnection(int sockfd, const string& ip)
+{
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.fd = sockfd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, sockfd, &ev) < 0)
+    {
+        perror("[Reactor] Erro ao registrar cliente");
+        return nullptr;
+    }
+
+    auto conn = make_unique<Connection>();
+    conn->id = nextConnId++;
+    conn->fd = sockfd;
+    conn->ip = ip;
+    conn->idleTimer.data = conn->loginTimer.data = conn->writeTimer.data = sockfd;
+    conn->idleTimer.kind = IDLE_TIMER;
+    conn->loginTimer.kind = LOGIN_TIMER;
+    conn->writeTimer.kind = WRITE_STALL_TIMER;
+    armTimer(conn->idleTimer, server.getTimeouts().idleSeconds);
+    armTimer(conn->loginTimer, server.getTimeouts().loginSeconds);
+
+    Connection* ref = conn.get();
+    connections[sockfd] = std::move(conn);
+    server.registerConnection(sockfd, this, ref->id);
+    return ref;
+}
+
+void Reactor::acceptConnections()
+{
+    while (true)
+    {
+        sockaddr_in client_addr;
+        socklen_t client_len = sizeof(client_addr);
+        int client_sockfd = accept4(listenFd, (sockaddr*)&client_addr, &client_len,
+                                    SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (client_sockfd < 0)
+        {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK && running)
+                perror("[Reactor] Erro em accept");
+            return;
+        }
+
+        // Obtém IP do cliente
+        char client_ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
+
+        if (!addConnection(client_sockfd, client_ip))
+        {
+            close(client_sockfd);
+            continue;
+        }
+
+        server.prepareClientSocket(client_sockfd);
+        onConnectionOpened(client_sockfd);
+
+        cout << "[Server] Nova conexão aceita (FD: " << client_sockfd
+             << ") de: " << client_ip << endl;
+    }
+}
+
+// ==================== LEITURA ====================
+
+void Reactor::handleReadable(Connection& conn)
+{
+    bool received = false;
+
+    // Edge-triggered: drena o socket até EAGAIN. Os frames de cada bloco são
+    // despachados antes do próximo recv (as views apontam para o buffer)
+    while (!conn.readPaused)
+    {
+        while (!conn.readPaused)
+        {
+            auto frame = conn.reader.next();
+            if (!frame)
+                break;
+            if (!conn.greeted && negotiateFraming(conn, *frame))
+                continue;
+            dispatchFrame(conn.fd, *frame);
+        }
+
+        // Leitura suspensa: os dados ficam no socket até setReadPaused(false)
+        if (conn.readPaused || conn.closing)
+            break;
+
+        ssize_t bytes = conn.reader.fill(conn.fd);
+
+        if (bytes > 0)
+        {
+            received = true;
+            continue;
+        }
+
+        if (bytes == 0)
+        {
+            // Conexão fechada pelo peer (o que já chegou foi processado)
+            conn.closing = true;
+            break;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+
+        cerr << "[Reactor] Erro ao receber (FD: " << conn.fd << "): " << strerror(errno) << endl;
+        conn.closing = true;
+        break;
+    }
+
+    if (received)
+        armTimer(conn.idleTimer, server.getTimeouts().idleSeconds);
+}
+
+bool Reactor::negotiateFraming(Connection& conn, string_view frame)
+{
+    conn.greeted = true;
+
+    string response;
+    SocketUtils::Framing framing;
+    SocketUtils::Encoding encoding;
+    SocketUtils::Compression compression;
+    if (!handler.negotiateFraming(frame, conn.fd, response, framing, encoding, compression))
+        return false;
+
+    // O HELLO_OK entra na fila antes da troca: sai em linha, em JSON e sem compressão
+    send(conn.fd, response);
+    conn.outbound.setFraming(framing);
+    conn.outbound.setEncoding(encoding);
+    conn.outbound.setCompression(compression);
+    conn.reader.setFraming(framing);
+    server.setClientEncoding(conn.fd, encoding);
+    conn.reader.setCompression(compression);
+    return true;
+}
+
+void Reactor::dispatchFrame(int sockfd, string_view message)
+{
+    if (pool)
+    {
+        Connection& conn = *connections.at(sockfd);
+        conn.pendingFrames.emplace_back(message);
+        scheduleFrames(conn);
+
+        // Cliente mais rápido que o pool: o resto espera no socket
+        if (conn.pendingFrames.size() >= MAX_QUEUED_FRAMES)
+            setReadPaused(sockfd, true);
+        return;
+    }
+
+    string response = handler.processCommand(message, sockfd, encodingOf(sockfd));
+    if (!response.empty())
+        send(sockfd, response);
+}
+
+// ==================== ESCRITA ====================
+
+bool Reactor::send(int sockfd, uint64_t conn_id, string_view json_message)
+{
+    // Outra thread (ex: outro reactor roteando): entrega via caixa de entrada
+    if (this_thread::get_id() != loopThread)
+    {
+        mailbox.post(sockfd, conn_id, json_message);
+        wake();
+        return true;
+    }
+
+    Connection* conn = writableConnection(sockfd, conn_id);
+    if (!conn)
+        return false;
+
+    conn->outbound.push(json_message);
+    return afterEnqueue(*conn);
+}
+
+bool Reactor::sendBatch(int sockfd, uint64_t conn_id, const vector<string_view>& messages)
+{
+    if (this_thread::get_id() != loopThread)
+    {
+        mailbox.postBatch(sockfd, conn_id, messages);
+        wake();
+        return true;
+    }
+
+    Connection* conn = writableConnection(sockfd, conn_id);
+    if (!conn)
+        return false;
+
+    for (string_view message : messages)
+        conn->outbound.push(message);
+    return afterEnqueue(*conn);
+}
+
+bool Reactor::send(int sockfd, string_view json_message)
+{
+    auto it = connections.find(sockfd);
+    return it != connections.end() && send(sockfd, it->second->id, json_message);
+}
+
+bool Reactor::sendBatch(int sockfd, const vector<string_view>& messages)
+{
+    auto it = connections.find(sockfd);
+    return it != connections.end() && sendBatch(sockfd, it->second->id, messages);
+}
+
+Reactor::Connection* Reactor::writableConnection(int sockfd, uint64_t conn_id)
+{
+    auto it = connections.find(sockfd);
+    if (it == connections.end() || it->second->id != conn_id || it->second->evicted)
+        return nullptr;
+    return it->second.get();
+}
+
+bool Reactor::afterEnqueue(Connection& conn)
+{
+    if (!server.enforceOutboundLimits(conn.fd, conn.outbound, 0))
+    {
+        // Fecha no fim do lote: quem chamou pode estar processando esta conexão
+        conn.evicted = true;
+        conn.outbound.clear();
+    }
+
+    updateCongestion(conn);
+    scheduleFlush(conn);
+    return !conn.evicted;
+}
+
+size_t Reactor::pendingWriteBytes(int sockfd) const
+{
+    auto it = connections.find(sockfd);
+    return it == connections.end() ? 0 : it->second->outbound.bytes();
+}
+
+SocketUtils::Encoding Reactor::encodingOf(int sockfd) const
+{
+    auto it = connections.find(sockfd);
+    return it == connections.end() ? SocketUtils::Encoding::JSON : it->second->outbound.getEncoding();
+}
+
+void Reactor::setReadPaused(int sockfd, bool paused)
+{
+    auto it = connections.find(sockfd);
+    if (it == connections.end() || it->second->readPaused == paused)
+        return;
+
+    it->second->readPaused = paused;
+    if (!paused)
+    {
+        resumedReads.push_back(sockfd);
+        wake();
+    }
+}
+
+bool Reactor::flush(Connection& conn)
+{
+    OutboundQueue::FlushResult result = conn.outbound.flush(conn.fd);
+    writevCalls.fetch_add(result.syscalls, memory_order_relaxed);
+    framesFlushed.fetch_add(result.frames, memory_order_relaxed);
+    updateCongestion(conn);
+
+    if (!result.ok)
+        return false;
+
+    // Prazo de escrita travada: conta a partir do último progresso
+    if (conn.outbound.empty())
+        timers.cancel(conn.writeTimer);
+    else if (result.bytes > 0 || !conn.writeTimer.armed())
+        armTimer(conn.writeTimer, server.getTimeouts().writeStallSeconds);
+
+    return true;
+}
+
+void Reactor::scheduleFlush(Connection& conn)
+{
+    if (conn.flushScheduled)
+        return;
+
+    conn.flushScheduled = true;
+    pendingFlushes.push_back(conn.fd);
+}
+
+void Reactor::flushPending()
+{
+    for (int fd : std::exchange(pendingFlushes, {}))
+    {
+        auto it = connections.find(fd);
+        if (it == connections.end())
+            continue;
+
+        Connection& conn = *it->second;
+        conn.flushScheduled = false;
+        if (conn.detached || conn.closing)
+            continue;
+
+        if (conn.evicted)
+        {
+            closeConnection(fd, "Consumidor lento (limite da fila de saída)");
+            continue;
+        }
+
+        if (!flush(conn))
+            closeConnection(fd, "Erro ao enviar");
+        else
+            onWritable(fd);
+    }
+}
+
+void Reactor::closeAfterFlush(Connection& conn, const string& reason)
+{
+    // EOF do peer (half-close): as respostas dos últimos frames ainda saem,
+    // inclusive as dos jobs do pool concluídos depois de sair do epoll
+    if (!conn.evicted && !conn.outbound.empty())
+        flush(conn);
+    closeConnection(conn.fd, reason);
+}
+
+void Reactor::updateCongestion(Connection& conn)
+{
+    if (conn.outbound.congested() == conn.congested)
+        return;
+
+    conn.congested = conn.outbound.congested();
+    server.setCongested(conn.fd, conn.congested);
+
+    // Saída drenou: entrega as mensagens desviadas para a fila offline
+    if (!conn.congested && !conn.evicted)
+        server.deliverDiverted(conn.fd);
+}
+
+// ==================== ATUALIZAÇÃO A QUENTE ====================
+
+void Reactor::exportConnections(vector<HandoffConnection>& out)
+{
+    // O loop parou: a thread chamadora passa a ser a dona do reactor
+    loopThread = this_thread::get_id();
+
+    // Espera os jobs do pool: as respostas entram no buffer de escrita
+    while (true)
+    {
+        drainMailbox();
+
+        bool busy = false;
+        for (auto& [fd, conn] : connections)
+            busy = busy || conn->busy;
+        if (!busy)
+            break;
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    for (auto& [fd, conn] : connections)
+    {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        server.unregisterConnection(fd);
+        if (conn->detached)
+            continue;
+
+        HandoffConnection handoff;
+        handoff.fd = fd;
+        handoff.ip = conn->ip;
+        handoff.framing = conn->reader.getFraming();
+        handoff.encoding = conn->outbound.getEncoding();
+        handoff.compression = conn->outbound.getCompression();
+        handoff.deflateWindow = conn->outbound.compressionWindow();
+        handoff.inflateWindow = conn->reader.compressionWindow();
+        handoff.greeted = conn->greeted;
+        for (auto& frame : conn->pendingFrames)
+            SocketUtils::appendFrame(handoff.readBuffer, handoff.framing, frame,
+                                     static_cast<uint8_t>(Protocol::peekMessageType(frame)));
+        handoff.readBuffer.append(conn->reader.pending());
+        handoff.writeBuffer = conn->outbound.take();
+        out.push_back(std::move(handoff));
+    }
+
+    // Os nós de timer saem da roda nos destrutores das conexões
+    connections.clear();
+    resumedReads.clear();
+    pendingFlushes.clear();
+}
+
+bool Reactor::adoptConnection(HandoffConnection&& handoff)
+{
+    int sockfd = handoff.fd;
+    Connection* conn = SocketUtils::setNonBlocking(sockfd) ? addConnection(sockfd, handoff.ip) : nullptr;
+    if (!conn)
+    {
+        close(sockfd);
+        return false;
+    }
+
+    // Bytes pendentes já estão no framing negociado antes da atualização
+    conn->greeted = handoff.greeted;
+    conn->reader.setFraming(handoff.framing);
+    conn->outbound.setFraming(handoff.framing);
+    conn->outbound.setEncoding(handoff.encoding);
+    server.setClientEncoding(sockfd, handoff.encoding);
+    conn->outbound.setCompression(handoff.compression);
+    conn->reader.setCompression(handoff.compression);
+
+    // Contextos de compressão continuam de onde o processo anterior parou
+    if (handoff.compression != SocketUtils::Compression::NONE &&
+        (!conn->outbound.setCompressionWindow(handoff.deflateWindow) ||
+         !conn->reader.setCompressionWindow(handoff.inflateWindow)))
+    {
+        closeConnection(sockfd, "Erro ao restaurar o contexto de compressão");
+        return false;
+    }
+
+    if (!conn->reader.append(handoff.readBuffer.data(), handoff.readBuffer.size()))
+    {
+        closeConnection(sockfd, "Erro ao alocar buffer de leitura");
+        return false;
+    }
+    conn->outbound.pushBytes(handoff.writeBuffer);
+    updateCongestion(*conn);
+    scheduleFlush(*conn);
+
+    onConnectionOpened(sockfd);
+
+    // Frames herdados são executados na primeira volta do loop
+    resumedReads.push_back(sockfd);
+    return true;
+}
+
+// ==================== FECHAMENTO ====================
+
+void Reactor::closeConnection(int sockfd, const string& reason)
+{
+    auto it = connections.find(sockfd);
+    if (it == connections.end())
+        return;
+
+    Connection& conn = *it->second;
+    if (!conn.detached)
+    {
+        cerr << "[Server] Cliente (FD: " << sockfd << ", IP: " << conn.ip
+             << ") desconectado. Motivo: " << reason << endl;
+
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, sockfd, nullptr);
+        conn.closing = true;
+        conn.detached = true;
+        timers.cancel(conn.idleTimer);
+        timers.cancel(conn.loginTimer);
+        timers.cancel(conn.writeTimer);
+    }
+
+    // Job do pool ainda usa o fd: o fechamento termina na conclusão dele
+    if (conn.busy)
+        return;
+
+    connections.erase(it);
+    server.unregisterConnection(sockfd);
+
+    onConnectionClosed(sockfd);
+}
+
+void Reactor::onConnectionClosed(int sockfd)
+{
+    // Remove sessão e fecha o socket
+    server.cleanupSession(sockfd);
+}
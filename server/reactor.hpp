@@ -0,0 +1,305 @@
+#pragma once
+
+#include "command_handler.hpp"
+#include "frame_reader.hpp"
+#include "io_backend.hpp"
+#include "outbound_queue.hpp"
+#include "timer_wheel.hpp"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Server;
+class WorkerPool;
+
+/**
+ * Classe Reactor
+ * --------------
+ * Loop de eventos baseado em epoll (edge-triggered) que substitui o modelo
+ * de uma thread por cliente. A prontidão do socket dirige leituras e escritas:
+ * conexões ociosas não consomem CPU nem pilha de thread.
+ *
+ * Os comandos continuam sendo despachados por CommandHandler::processCommand,
+ * executado na própria thread do reactor ou, com um WorkerPool configurado,
+ * em um worker (um job por conexão por vez, preservando a ordem dos frames).
+ * Com MAX_QUEUED_FRAMES frames aguardando o pool, a leitura da conexão é
+ * suspensa até a fila cair à metade.
+ * Com vários reactors (SO_REUSEPORT), cada um tem seu socket de escuta, seu
+ * epoll e seu conjunto de conexões.
+ *
+ * Cada reactor mantém uma roda de timers (TimerWheel) com os prazos das suas
+ * conexões: inatividade, login e escrita travada. O timeout do epoll_wait é
+ * o próximo tick com timers vencendo.
+ */
+class Reactor : public IoBackend
+{
+public:
+    /**
+     * @param server Servidor dono do estado global
+     * @param listen_fd Socket de escuta já em listen (será definido como não-bloqueante)
+     */
+    Reactor(Server& server, int listen_fd);
+    ~Reactor() override;
+
+    /**
+     * Cria o epoll e registra o socket de escuta.
+     * @return true se a inicialização for bem-sucedida
+     */
+    bool init() override;
+
+    /**
+     * Executa o loop de eventos até stop() ser chamado.
+     */
+    void run() override;
+
+    /**
+     * Sinaliza o encerramento do loop (seguro de qualquer thread).
+     */
+    void stop() override;
+
+    /**
+     * Enfileira uma mensagem JSON (com framing) na fila de saída do cliente.
+     * As filas com frames novos são enviadas ao fim do lote de eventos, com
+     * um writev para vários frames; o que não couber no socket sai quando o
+     * epoll sinalizar EPOLLOUT. Chamadas de outras threads são postadas na
+     * caixa de entrada e aplicadas pelo loop.
+     * @return false se a conexão não pertence (mais) a este reactor
+     */
+    bool send(int sockfd, uint64_t conn_id, std::string_view json_message) override;
+
+    bool sendBatch(int sockfd, uint64_t conn_id, const std::vector<std::string_view>& messages) override;
+
+    const char* name() const override { return "epoll (edge-triggered)"; }
+
+    bool supportsHandoff() const override { return true; }
+
+    /**
+     * Conclui os jobs do pool em andamento e retira todas as conexões do
+     * epoll; frames ainda não executados voltam para o buffer de leitura.
+     */
+    void exportConnections(std::vector<HandoffConnection>& out) override;
+
+    /**
+     * Registra a conexão herdada; os frames do buffer são executados na
+     * primeira volta do loop e o buffer de escrita é enviado no EPOLLOUT.
+     */
+    bool adoptConnection(HandoffConnection&& conn) override;
+
+    /**
+     * Passa a executar os comandos no pool (deve ser chamado antes de run()).
+     */
+    void setWorkerPool(WorkerPool* worker_pool) { pool = worker_pool; }
+
+protected:
+    // ==================== Pontos de extensão (thread do loop) ====================
+
+    /**
+     * Processa um frame completo recebido do cliente. Padrão: despacha para
+     * CommandHandler::processCommand (no pool, se houver) e envia a resposta.
+     */
+    virtual void dispatchFrame(int sockfd, std::string_view message);
+
+    /**
+     * Chamado após uma conexão ser aceita e registrada.
+     */
+    virtual void onConnectionOpened(int sockfd) { (void)sockfd; }
+
+    /**
+     * Chamado após a conexão sair do epoll. Padrão: limpa a sessão global
+     * e fecha o socket.
+     */
+    virtual void onConnectionClosed(int sockfd);
+
+    /**
+     * Chamado quando o epoll sinaliza EPOLLOUT e o buffer de escrita diminuiu.
+     */
+    virtual void onWritable(int sockfd) { (void)sockfd; }
+
+    /**
+     * Indica se a conexão já autenticou (consultado quando o prazo de login vence).
+     * Padrão: sessão registrada no estado global do servidor.
+     */
+    virtual bool isAuthenticated(int sockfd);
+
+    /**
+     * Chamado quando o eventfd acorda o loop (após drenar a caixa de entrada).
+     */
+    virtual void onWake() {}
+
+    /**
+     * Chamado ao fim de cada lote de eventos devolvido pelo epoll_wait.
+     */
+    virtual void afterEvents() {}
+
+    /**
+     * Acorda o loop (eventfd) para processar stop() ou a caixa de entrada.
+     */
+    void wake();
+
+    /**
+     * Enfileira para a conexão que ocupa o socket agora (só na thread do loop).
+     */
+    bool send(int sockfd, std::string_view json_message);
+    bool sendBatch(int sockfd, const std::vector<std::string_view>& messages);
+
+    /**
+     * Bytes aguardando espaço no socket (0 se a conexão não existe).
+     */
+    size_t pendingWriteBytes(int sockfd) const;
+
+    /**
+     * Codificação negociada da conexão (JSON se ela não existe).
+     */
+    SocketUtils::Encoding encodingOf(int sockfd) const;
+
+    /**
+     * Suspende/retoma a leitura da conexão (backpressure na entrada).
+     * Ao retomar, os dados já sinalizados são lidos na próxima volta do loop.
+     */
+    void setReadPaused(int sockfd, bool paused);
+
+private:
+    /**
+     * Prazos por conexão (TimerNode::kind)
+     */
+    enum TimerKind
+    {
+        IDLE_TIMER,
+        LOGIN_TIMER,
+        WRITE_STALL_TIMER
+    };
+
+    /**
+     * Estado de uma conexão gerenciada pelo reactor
+     */
+    struct Connection : PoolAllocated
+    {
+        uint64_t id;              // Distingue conexões que reutilizam o mesmo fd
+        int fd;
+        std::string ip;
+        FrameReader reader;       // Bytes recebidos ainda não despachados
+        OutboundQueue outbound;   // Frames aguardando espaço no socket
+        bool flushScheduled = false;  // Em pendingFlushes
+        bool congested = false;   // Último estado de watermark informado ao servidor
+        bool evicted = false;     // Excedeu os limites da fila de saída (fecha no flush)
+        PooledDeque<PooledString> pendingFrames;  // Frames aguardando o pool
+        bool busy = false;        // Há um job desta conexão no pool
+        bool readPaused = false;  // Leitura suspensa pelo consumidor dos frames
+        bool greeted = false;     // Primeiro frame já visto (HELLO só vale nele)
+        bool closing = false;     // Erro/EOF detectado, fechar ao fim do evento
+        bool detached = false;    // Fora do epoll, aguardando o job terminar para fechar
+        TimerNode idleTimer;      // Rearmado a cada leitura
+        TimerNode loginTimer;     // Armado no accept
+        TimerNode writeTimer;     // Armado enquanto há bytes pendentes sem progresso
+    };
+
+    Server& server;
+    CommandHandler handler;
+    int listenFd;
+    int epollFd;
+    int wakeFd;
+    std::atomic<bool> running;
+    std::thread::id loopThread;
+    Mailbox mailbox;
+    WorkerPool* pool;
+    uint64_t nextConnId;
+    PooledMap<int, std::unique_ptr<Connection>> connections;
+    std::vector<int> resumedReads;  // Conexões com leitura retomada
+    std::vector<int> pendingFlushes;    // Conexões com frames novos na fila de saída
+    TimerWheel timers;
+    std::atomic<uint64_t>& writevCalls;
+    std::atomic<uint64_t>& framesFlushed;
+
+    /**
+     * Aplica as escritas e conclusões de jobs postadas por outras threads.
+     */
+    void drainMailbox();
+
+    /**
+     * Submete ao pool o próximo frame da conexão, se ela não tiver job em andamento.
+     */
+    void scheduleFrames(Connection& conn);
+
+    /**
+     * Arma o timer da conexão (prazo em segundos; 0 = desligado).
+     */
+    void armTimer(TimerNode& timer, int seconds);
+
+    /**
+     * Trata um prazo vencido (fecha a conexão conforme o tipo).
+     */
+    void onTimer(TimerNode& timer);
+
+    /**
+     * Registra o socket no epoll, cria o estado da conexão e arma os prazos.
+     * @return nullptr se o socket não pôde ser registrado
+     */
+    Connection* addConnection(int sockfd, const std::string& ip);
+
+    /**
+     * Aceita todas as conexões pendentes (edge-triggered: até EAGAIN).
+     */
+    void acceptConnections();
+
+    /**
+     * Lê todos os bytes disponíveis e processa cada frame completo.
+     */
+    void handleReadable(Connection& conn);
+
+    /**
+     * Primeiro frame da conexão: se for um HELLO, responde (ainda em linha)
+     * e troca o framing de leitura e escrita.
+     * @return true se o frame foi consumido pela negociação
+     */
+    bool negotiateFraming(Connection& conn, std::string_view frame);
+
+    /**
+     * Envia o máximo possível da fila de saída (writev).
+     * @return false em caso de erro fatal no socket
+     */
+    bool flush(Connection& conn);
+
+    /**
+     * Conexão do socket com o id dado que ainda aceita escritas (nullptr se
+     * o fd já é de outra conexão ou se ela excedeu os limites de saída).
+     */
+    Connection* writableConnection(int sockfd, uint64_t conn_id);
+
+    /**
+     * Aplica os limites de consumidor lento após enfileirar e agenda o envio.
+     * @return false se a conexão foi marcada para fechar
+     */
+    bool afterEnqueue(Connection& conn);
+
+    /**
+     * Agenda o envio da fila de saída para o fim do lote de eventos.
+     */
+    void scheduleFlush(Connection& conn);
+
+    /**
+     * Envia as filas agendadas (um writev cobre os frames de todo o lote).
+     */
+    void flushPending();
+
+    /**
+     * Tenta enviar o que resta na fila de saída e fecha a conexão.
+     */
+    void closeAfterFlush(Connection& conn, const std::string& reason);
+
+    /**
+     * Informa ao servidor a travessia dos watermarks da fila de saída.
+     */
+    void updateCongestion(Connection& conn);
+
+    /**
+     * Remove a conexão do epoll, limpa a sessão e fecha o socket. Com um job
+     * do pool em andamento, o fechamento é concluído quando ele terminar.
+     */
+    void closeConnection(int sockfd, const std::string& reason);
+};
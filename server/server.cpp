@@ -1,50 +1,216 @@
+#include "buffer_pool.hpp"
 #include "command_handler.hpp"
+#include "coro_reactor.hpp"
+#include "frame_reader.hpp"
+#include "reactor.hpp"
+#include "ring_buffer.hpp"
 #include "server.hpp"
+#include "shard.hpp"
 #include "socket_utils.hpp"
+#include "uring_backend.hpp"
+#include "worker_pool.hpp"
+#include <algorithm>
 #include <arpa/inet.h>
 #include <chrono>
 #include <cstring>
 #include <iostream>
 #include <netinet/in.h>
+#include <nlohmann/json.hpp>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <thread>
 #include <unistd.h>
 
 using namespace std;
+using json = nlohmann::json;
+
+namespace
+{
+    // Sondas do TCP keepalive após a ociosidade configurada
+    constexpr int KEEPALIVE_INTERVAL = 10;
+    constexpr int KEEPALIVE_PROBES = 5;
+
+    // Versão do estado serializado no handoff e prazo para o processo novo confirmar
+    constexpr int HANDOFF_VERSION = 1;
+    constexpr int HANDOFF_ACK_TIMEOUT = 10;
+    constexpr char HANDOFF_ACK = 'K';
+
+    bool writeAll(int fd, const void* data, size_t len)
+    {
+        const char* ptr = static_cast<const char*>(data);
+        while (len > 0)
+        {
+            ssize_t bytes = ::send(fd, ptr, len, MSG_NOSIGNAL);
+            if (bytes < 0 && errno == EINTR) continue;
+            if (bytes <= 0) return false;
+            ptr += bytes;
+            len -= bytes;
+        }
+        return true;
+    }
+
+    bool readAll(int fd, void* data, size_t len)
+    {
+        char* ptr = static_cast<char*>(data);
+        while (len > 0)
+        {
+            ssize_t bytes = recv(fd, ptr, len, 0);
+            if (bytes < 0 && errno == EINTR) continue;
+            if (bytes <= 0) return false;
+            ptr += bytes;
+            len -= bytes;
+        }
+        return true;
+    }
+
+    sockaddr_un unixAddress(const string& path)
+    {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        return addr;
+    }
+
+    json::binary_t toBinary(const string& bytes)
+    {
+        return json::binary_t(vector<uint8_t>(bytes.begin(), bytes.end()));
+    }
+
+    string fromBinary(const json& value)
+    {
+        const auto& bytes = value.get_binary();
+        return string(bytes.begin(), bytes.end());
+    }
+
+    /**
+     * Fixa uma thread em um núcleo (afinidade de CPU).
+     */
+    void pinThread(pthread_t handle, int cpu)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(handle, sizeof(set), &set) != 0)
+            cerr << "[Server] Não foi possível fixar reactor no núcleo " << cpu << endl;
+    }
+}
 
 // ==================== CONSTRUTOR/DESTRUTOR ====================
 
-Server::Server(int p) : port(p), server_sockfd(-1), isRunning(false) {}
+Server::Server(int p) : Server([p] { ServerConfig config; config.port = p; return config; }()) {}
+
+Server::Server(const ServerConfig& config)
+    : port(config.port), ioMode(config.ioMode), reactorCount(config.reactors),
+      pinCpus(config.pinCpus), workerCount(config.workers), workerQueue(config.workerQueue),
+      metricsInterval(config.metricsInterval), timeouts(config.timeouts),
+      slowConsumer(config.slowConsumer), server_sockfd(-1),
+      isRunning(false), upgradePath(config.upgradeSocket), takeoverPath(config.takeoverSocket),
+      upgradeListenFd(-1), takeoverFd(-1), upgradeClient(-1), upgradeWakeFd(-1),
+      writevCalls(metrics.counter("chat_outbound_writev_total", "Chamadas writev nas filas de saida")),
+      framesFlushed(metrics.counter("chat_outbound_frames_total", "Frames enviados pelas filas de saida")),
+      slowDisconnects(metrics.counter("chat_slow_consumer_disconnects_total",
+                                      "Conexoes derrubadas por exceder os limites da fila de saida")),
+      slowDroppedFrames(metrics.counter("chat_slow_consumer_dropped_frames_total",
+                                        "Frames descartados da fila de saida (drop-oldest)")),
+      slowDiverted(metrics.counter("chat_slow_consumer_diverted_total",
+                                   "Mensagens desviadas para a fila offline (saida congestionada)"))
+{
+    if (reactorCount <= 0)
+        reactorCount = static_cast<int>(max(1u, thread::hardware_concurrency()));
+
+    metrics.gauge("chat_outbound_congested", "Conexoes com a fila de saida acima do high watermark",
+                  [this]
+                  {
+                      lock_guard<mutex> lock(ownersMutex);
+                      return static_cast<double>(congestedConnections.size());
+                  });
+
+    // Pool de buffers e cache de anéis (globais do processo)
+    metrics.counter("chat_buffer_pool_allocations_total", "Blocos entregues pelo pool de buffers",
+                    [] { return static_cast<double>(BufferPool::stats().allocations); });
+    metrics.counter("chat_buffer_pool_local_hits_total", "Blocos atendidos pela cache da thread",
+                    [] { return static_cast<double>(BufferPool::stats().localHits); });
+    metrics.counter("chat_buffer_pool_refills_total", "Lotes buscados na reserva global",
+                    [] { return static_cast<double>(BufferPool::stats().refills); });
+    metrics.counter("chat_buffer_pool_slabs_total", "Slabs pedidos ao sistema",
+                    [] { return static_cast<double>(BufferPool::stats().slabs); });
+    metrics.counter("chat_buffer_pool_oversized_total", "Pedidos acima da maior classe (fora do pool)",
+                    [] { return static_cast<double>(BufferPool::stats().oversized); });
+    metrics.gauge("chat_buffer_pool_reserved_bytes", "Bytes reservados em slabs",
+                  [] { return static_cast<double>(BufferPool::stats().bytesReserved); });
+    metrics.gauge("chat_buffer_pool_blocks_in_use", "Blocos do pool em uso",
+                  [] { return static_cast<double>(BufferPool::stats().blocksInUse); });
+    metrics.counter("chat_ring_buffers_mapped_total", "Aneis de leitura mapeados do zero",
+                    [] { return static_cast<double>(RingBuffer::cacheStats().mapped); });
+    metrics.counter("chat_ring_buffers_reused_total", "Aneis de leitura reaproveitados da cache",
+                    [] { return static_cast<double>(RingBuffer::cacheStats().reused); });
+    metrics.gauge("chat_ring_buffers_cached", "Aneis parados na cache",
+                  [] { return static_cast<double>(RingBuffer::cacheStats().cached); });
+}
 
 Server::~Server()
 {
     if (isRunning)
     {
         isRunning = false;
-        if (server_sockfd >= 0)
+        wakeUpgradeLoop();
+        for (auto& backend : backends)
+            backend->stop();
+        {
+            // Threads de clientes (modo threads) dormem em poll até o próximo evento
+            lock_guard<mutex> lock(ownersMutex);
+            for (auto& [fd, outbound] : clientOutbound)
+                outbound->wake();
+        }
+        for (int fd : listenSockets)
         {
-            shutdown(server_sockfd, SHUT_RDWR);
-            close(server_sockfd);
+            shutdown(fd, SHUT_RDWR);
+            close(fd);
         }
         if (acceptorThread.joinable())
             acceptorThread.join();
+        for (auto& t : backendThreads)
+            if (t.joinable())
+                t.join();
     }
+    if (metricsThread.joinable())
+        metricsThread.join();
+    if (upgradeThread.joinable())
+        upgradeThread.join();
+    if (upgradeListenFd >= 0)
+        close(upgradeListenFd);
+    if (upgradeWakeFd >= 0)
+        close(upgradeWakeFd);
 }
 
 // ==================== INICIALIZAÇÃO ====================
 
-bool Server::start()
+int Server::createListener(bool reuse_port, int incoming_cpu)
 {
-    server_sockfd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_sockfd < 0)
+    int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (sockfd < 0)
     {
         perror("[Server] Erro ao criar socket");
-        return false;
+        return -1;
     }
 
     // Permite reutilizar porta
     int opt = 1;
-    setsockopt(server_sockfd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    // Vários listeners na mesma porta: o kernel distribui as conexões entre eles
+    if (reuse_port && setsockopt(sockfd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)
+        perror("[Server] Erro ao habilitar SO_REUSEPORT");
+
+    // Prefere entregar a este listener conexões cujo tráfego chega neste núcleo
+    if (incoming_cpu >= 0)
+        setsockopt(sockfd, SOL_SOCKET, SO_INCOMING_CPU, &incoming_cpu, sizeof(incoming_cpu));
 
     // Configura endereço
     sockaddr_in serv_addr;
@@ -53,20 +219,53 @@ bool Server::start()
     serv_addr.sin_addr.s_addr = INADDR_ANY;
     serv_addr.sin_port = htons(port);
 
-    if (bind(server_sockfd, (sockaddr*)&serv_addr, sizeof(serv_addr)) < 0)
+    if (bind(sockfd, (sockaddr*)&serv_addr, sizeof(serv_addr)) < 0)
     {
         perror("[Server] Erro ao fazer bind");
-        close(server_sockfd);
-        return false;
+        close(sockfd);
+        return -1;
     }
 
-    if (listen(server_sockfd, 10) < 0)
+    if (listen(sockfd, SOMAXCONN) < 0)
     {
         perror("[Server] Erro ao fazer listen");
-        close(server_sockfd);
-        return false;
+        close(sockfd);
+        return -1;
     }
 
+    return sockfd;
+}
+
+bool Server::start()
+{
+    int listeners = ioMode == IoMode::THREADS ? 1 : reactorCount;
+    bool reuse_port = listeners > 1;
+    int cpus = static_cast<int>(max(1u, thread::hardware_concurrency()));
+
+    // SO_REUSEPORT deixaria outra instância fazer bind na mesma porta:
+    // sonda antes com um bind exclusivo para manter a rejeição de porta em uso
+    if (reuse_port)
+    {
+        int probe = createListener(false, -1);
+        if (probe < 0)
+            return false;
+        close(probe);
+    }
+
+    for (int i = 0; i < listeners; ++i)
+    {
+        int fd = createListener(reuse_port, pinCpus ? i % cpus : -1);
+        if (fd < 0)
+        {
+            for (int opened : listenSockets)
+                close(opened);
+            listenSockets.clear();
+            return false;
+        }
+        listenSockets.push_back(fd);
+    }
+    server_sockfd = listenSockets.front();
+
     isRunning = true;
     cout << "[Server] Mensageiro iniciado na porta TCP: " << port << endl;
 
@@ -75,17 +274,456 @@ bool Server::start()
 
 void Server::run()
 {
-    if (!start())
+    vector<HandoffConnection> inherited;
+    if (!(takeoverPath.empty() ? start() : takeOver(inherited)))
     {
         cerr << "[Server] Falha ao iniciar servidor" << endl;
         return;
     }
 
+    if (metricsInterval > 0)
+        metricsThread = thread(&Server::metricsLoop, this);
+
+    if (ioMode != IoMode::THREADS)
+    {
+        // Pool de comandos compartilhado pelos reactors (o modo sharded não compartilha
+        // estado e nas corrotinas o comando executa dentro da sessão)
+        if (workerCount > 0 && ioMode != IoMode::SHARDED && ioMode != IoMode::COROUTINES)
+        {
+            pool = make_unique<WorkerPool>(workerCount, workerQueue);
+            pool->registerMetrics(metrics);
+            cout << "[Server] Pool de comandos: " << pool->threadCount() << " thread(s)" << endl;
+        }
+
+        // Um backend de eventos por listener
+        for (size_t i = 0; i < listenSockets.size(); ++i)
+        {
+            auto backend = createBackend(listenSockets[i], static_cast<int>(i));
+            if (!backend)
+            {
+                cerr << "[Server] Falha ao iniciar backend de I/O" << endl;
+                return;
+            }
+            backends.push_back(std::move(backend));
+        }
+
+        // Shared-nothing: filas SPSC entre todos os pares de shards
+        if (ioMode == IoMode::SHARDED)
+        {
+            vector<Shard*> shards;
+            for (auto& backend : backends)
+                shards.push_back(static_cast<Shard*>(backend.get()));
+            Shard::connect(shards);
+        }
+
+        cout << "[Server] Modo de I/O: " << backends.front()->name()
+             << " (" << backends.size() << " reactor(s))" << endl;
+
+        // Conexões herdadas do processo anterior, distribuídas entre os reactors
+        for (size_t i = 0; i < inherited.size(); ++i)
+            backends[i % backends.size()]->adoptConnection(std::move(inherited[i]));
+
+        if (!upgradePath.empty())
+        {
+            if (backends.front()->supportsHandoff())
+                openUpgradeSocket();
+            else
+                cerr << "[Server] Atualização a quente indisponível neste modo de I/O" << endl;
+        }
+
+        if (takeoverFd >= 0)
+            completeTakeover();
+
+        // Um pedido de atualização para os backends; sem confirmação do
+        // processo novo as conexões voltam e o servidor segue rodando
+        do
+            runBackends();
+        while (upgradeClient >= 0 && !handOff());
+        return;
+    }
+
+    if (!upgradePath.empty())
+        cerr << "[Server] Atualização a quente indisponível neste modo de I/O" << endl;
+
     // Thread acceptor
+    cout << "[Server] Modo de I/O: uma thread por cliente" << endl;
     acceptorThread = thread(&Server::acceptorLoop, this);
     acceptorThread.join();
 }
 
+void Server::runBackends()
+{
+    int cpus = static_cast<int>(max(1u, thread::hardware_concurrency()));
+    for (size_t i = 1; i < backends.size(); ++i)
+    {
+        backendThreads.emplace_back(&IoBackend::run, backends[i].get());
+        if (pinCpus)
+            pinThread(backendThreads.back().native_handle(), static_cast<int>(i) % cpus);
+    }
+
+    // O primeiro reactor roda na thread atual
+    if (pinCpus)
+        pinThread(pthread_self(), 0);
+    backends.front()->run();
+
+    for (auto& t : backendThreads)
+        if (t.joinable())
+            t.join();
+    backendThreads.clear();
+}
+
+unique_ptr<IoBackend> Server::createBackend(int listen_fd, int index)
+{
+    if (ioMode == IoMode::SHARDED)
+    {
+        auto shard = make_unique<Shard>(*this, listen_fd, index, static_cast<int>(listenSockets.size()));
+        if (shard->init())
+            return shard;
+        return nullptr;
+    }
+
+    if (ioMode == IoMode::COROUTINES)
+    {
+        auto coro = make_unique<CoroReactor>(*this, listen_fd);
+        if (coro->init())
+            return coro;
+        return nullptr;
+    }
+
+    if (ioMode == IoMode::URING)
+    {
+        auto uring = make_unique<UringBackend>(*this, listen_fd);
+        if (uring->init())
+        {
+            uring->setWorkerPool(pool.get());
+            return uring;
+        }
+        cerr << "[Server] io_uring indisponível, usando epoll" << endl;
+    }
+
+    auto reactor = make_unique<Reactor>(*this, listen_fd);
+    if (reactor->init())
+    {
+        reactor->setWorkerPool(pool.get());
+        return reactor;
+    }
+    return nullptr;
+}
+
+// ==================== ATUALIZAÇÃO A QUENTE ====================
+
+bool Server::openUpgradeSocket()
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        perror("[Server] Erro ao criar socket de atualização");
+        return false;
+    }
+
+    // O arquivo pode ser do processo anterior (que já entregou tudo) ou resto de uma execução
+    // Só o dono do processo pode conectar: permissões ajustadas antes do listen
+    sockaddr_un addr = unixAddress(upgradePath);
+    unlink(upgradePath.c_str());
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || chmod(upgradePath.c_str(), 0600) < 0 ||
+        listen(fd, 1) < 0)
+    {
+        perror("[Server] Erro ao abrir socket de atualização");
+        close(fd);
+        return false;
+    }
+
+    upgradeWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (upgradeWakeFd < 0)
+    {
+        perror("[Server] Erro ao criar eventfd de atualização");
+        close(fd);
+        return false;
+    }
+
+    upgradeListenFd = fd;
+    upgradeThread = thread(&Server::upgradeLoop, this);
+    cout << "[Server] Aguardando atualização a quente em " << upgradePath << endl;
+    return true;
+}
+
+void Server::upgradeLoop()
+{
+    while (isRunning)
+    {
+        // Handoff em andamento: o listener não é consultado (uma conexão
+        // pendente faria o poll retornar na hora a cada volta) e a thread
+        // dorme até o eventfd avisar o fim do handoff ou o encerramento
+        pollfd pfds[2] = {{upgradeWakeFd, POLLIN, 0}, {upgradeListenFd, POLLIN, 0}};
+        nfds_t count = upgradeClient >= 0 ? 1 : 2;
+        if (poll(pfds, count, -1) <= 0)
+            continue;
+
+        if (pfds[0].revents & POLLIN)
+        {
+            uint64_t value;
+            ssize_t ignored = read(upgradeWakeFd, &value, sizeof(value));
+            (void)ignored;
+            continue;
+        }
+        if (!(pfds[1].revents & POLLIN))
+            continue;
+
+        int peer = accept4(upgradeListenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (peer < 0)
+            continue;
+
+        // O pedido recebe todos os sockets e o estado: só do mesmo usuário
+        ucred cred{};
+        socklen_t cred_len = sizeof(cred);
+        if (getsockopt(peer, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) < 0 || cred.uid != geteuid())
+        {
+            cerr << "[Server] Pedido de atualização recusado (uid " << cred.uid << ")" << endl;
+            close(peer);
+            continue;
+        }
+
+        cout << "[Server] Atualização a quente solicitada: transferindo conexões" << endl;
+        upgradeClient = peer;
+        for (auto& backend : backends)
+            backend->stop();
+    }
+}
+
+void Server::wakeUpgradeLoop()
+{
+    if (upgradeWakeFd >= 0)
+    {
+        uint64_t one = 1;
+        ssize_t ignored = write(upgradeWakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+bool Server::handOff()
+{
+    int peer = upgradeClient;
+
+    // Loops parados: as conexões e o estado não mudam mais
+    vector<HandoffConnection> connections;
+    for (auto& backend : backends)
+        backend->exportConnections(connections);
+
+    json state;
+    state["version"] = HANDOFF_VERSION;
+    state["listeners"] = listenSockets.size();
+    {
+        lock_guard<mutex> lock(stateMutex);
+
+        json& users_json = state["users"] = json::object();
+        for (UserId id = 0; id < nicknames.idLimit(); ++id)
+            if (nicknames.contains(id))
+                users_json[string(nicknames.name(id))] = users[id].fullName;
+
+        // No estado transferido os usuários são apelidos: os ids são deste processo
+        json& queues_json = state["queues"] = json::object();
+        for (const auto& [id, queue] : messageQueues)
+        {
+            json messages = json::array();
+            for (MessageQueue copy = queue; !copy.empty(); copy.pop())
+                messages.push_back(copy.front());
+            queues_json[string(nicknames.name(id))] = std::move(messages);
+        }
+
+        json& conns_json = state["connections"] = json::array();
+        for (const auto& conn : connections)
+        {
+            auto it = fdToUser.find(conn.fd);
+            conns_json.push_back({
+                {"ip", conn.ip},
+                {"nickname", it != fdToUser.end() ? string(nicknames.name(it->second)) : ""},
+                {"read", toBinary(conn.readBuffer)},
+                {"write", toBinary(conn.writeBuffer)},
+                {"framing", SocketUtils::framingName(conn.framing)},
+                {"encoding", SocketUtils::encodingName(conn.encoding)},
+                {"compression", SocketUtils::compressionName(conn.compression)},
+                {"deflate_window", toBinary(conn.deflateWindow)},
+                {"inflate_window", toBinary(conn.inflateWindow)},
+                {"greeted", conn.greeted}
+            });
+        }
+    }
+
+    // Listeners primeiro, depois as conexões na ordem do estado
+    vector<int> fds = listenSockets;
+    for (const auto& conn : connections)
+        fds.push_back(conn.fd);
+
+    // Estado em CBOR (buffers binários) precedido do tamanho
+    vector<uint8_t> encoded = json::to_cbor(state);
+    uint64_t size = encoded.size();
+
+    timeval timeout{HANDOFF_ACK_TIMEOUT, 0};
+    setsockopt(peer, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char ack = 0;
+    bool ok = writeAll(peer, &size, sizeof(size)) && writeAll(peer, encoded.data(), encoded.size()) &&
+              SocketUtils::sendFileDescriptors(peer, fds) && readAll(peer, &ack, 1) && ack == HANDOFF_ACK;
+    close(peer);
+
+    if (!ok)
+    {
+        cerr << "[Server] Processo novo não assumiu as conexões; retomando" << endl;
+        for (size_t i = 0; i < connections.size(); ++i)
+            backends[i % backends.size()]->adoptConnection(std::move(connections[i]));
+        upgradeClient = -1;
+        wakeUpgradeLoop();
+        return false;
+    }
+
+    // O processo novo tem cópias dos sockets: fecha as daqui sem shutdown
+    for (const auto& conn : connections)
+        close(conn.fd);
+    for (int fd : listenSockets)
+        close(fd);
+    listenSockets.clear();
+    isRunning = false;
+    wakeUpgradeLoop();
+
+    cout << "[Server] Atualização concluída: " << connections.size()
+         << " conexão(ões) transferida(s)" << endl;
+    return true;
+}
+
+bool Server::takeOver(vector<HandoffConnection>& inherited)
+{
+    if (ioMode != IoMode::EPOLL && ioMode != IoMode::COROUTINES)
+    {
+        cerr << "[Server] --takeover requer o modo epoll ou coro" << endl;
+        return false;
+    }
+
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un addr = unixAddress(takeoverPath);
+    if (sock < 0 || connect(sock, (sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        perror("[Server] Erro ao conectar ao processo anterior");
+        if (sock >= 0) close(sock);
+        return false;
+    }
+
+    json state;
+    vector<int> fds;
+    try
+    {
+        uint64_t size = 0;
+        vector<uint8_t> encoded;
+        if (!readAll(sock, &size, sizeof(size)))
+            throw runtime_error("estado não recebido");
+        encoded.resize(size);
+        if (!readAll(sock, encoded.data(), encoded.size()))
+            throw runtime_error("estado incompleto");
+
+        state = json::from_cbor(encoded);
+        if (state.at("version").get<int>() != HANDOFF_VERSION)
+            throw runtime_error("versão de estado incompatível");
+
+        size_t total = state.at("listeners").get<size_t>() + state.at("connections").size();
+        if (!SocketUtils::receiveFileDescriptors(sock, fds, total))
+            throw runtime_error("descritores não recebidos");
+    }
+    catch (const exception& e)
+    {
+        cerr << "[Server] Falha no handoff: " << e.what() << endl;
+        for (int fd : fds)
+            close(fd);
+        close(sock);
+        return false;
+    }
+
+    size_t listeners = state["listeners"].get<size_t>();
+    listenSockets.assign(fds.begin(), fds.begin() + listeners);
+    server_sockfd = listenSockets.front();
+    if (reactorCount != static_cast<int>(listeners))
+        cout << "[Server] Usando os " << listeners << " listener(s) do processo anterior" << endl;
+    reactorCount = static_cast<int>(listeners);
+
+    {
+        lock_guard<mutex> lock(stateMutex);
+
+        for (const auto& [nickname, full_name] : state["users"].items())
+            addUser(nickname, full_name.get<string>());
+
+        for (const auto& [nickname, messages] : state["queues"].items())
+        {
+            UserId id = nicknames.find(nickname);
+            if (id == NO_USER)
+                continue;
+            for (const auto& message : messages)
+                messageQueues[id].push(message.get<string>());
+        }
+
+        const json& conns_json = state["connections"];
+        for (size_t i = 0; i < conns_json.size(); ++i)
+        {
+            HandoffConnection conn;
+            conn.fd = fds[listeners + i];
+            conn.ip = conns_json[i]["ip"].get<string>();
+            conn.readBuffer = fromBinary(conns_json[i]["read"]);
+            conn.writeBuffer = fromBinary(conns_json[i]["write"]);
+
+            // Estado de uma versão sem framing negociado: conexão em linha
+            conn.framing = SocketUtils::parseFraming(conns_json[i].value("framing", "line"))
+                               .value_or(SocketUtils::Framing::LINE);
+            conn.encoding = SocketUtils::parseEncoding(conns_json[i].value("encoding", "json"))
+                                .value_or(SocketUtils::Encoding::JSON);
+            conn.compression = SocketUtils::parseCompression(conns_json[i].value("compression", "none"))
+                                   .value_or(SocketUtils::Compression::NONE);
+            if (conns_json[i].contains("deflate_window"))
+            {
+                conn.deflateWindow = fromBinary(conns_json[i]["deflate_window"]);
+                conn.inflateWindow = fromBinary(conns_json[i]["inflate_window"]);
+            }
+            conn.greeted = conns_json[i].value("greeted", true);
+
+            UserId id = nicknames.find(conns_json[i]["nickname"].get<string>());
+            if (id != NO_USER)
+            {
+                sessions[id] = conn.fd;
+                fdToUser[conn.fd] = id;
+                users[id].isLogged = true;
+            }
+            inherited.push_back(std::move(conn));
+        }
+    }
+
+    takeoverFd = sock;
+    isRunning = true;
+    cout << "[Server] Assumiu " << inherited.size() << " conexão(ões) e "
+         << nicknames.size() << " usuário(s) do processo anterior" << endl;
+    return true;
+}
+
+void Server::completeTakeover()
+{
+    if (!writeAll(takeoverFd, &HANDOFF_ACK, 1))
+        cerr << "[Server] Erro ao confirmar o handoff ao processo anterior" << endl;
+    close(takeoverFd);
+    takeoverFd = -1;
+}
+
+// ==================== MÉTRICAS ====================
+
+void Server::metricsLoop()
+{
+    auto next = chrono::steady_clock::now() + chrono::seconds(metricsInterval);
+
+    while (isRunning)
+    {
+        this_thread::sleep_for(chrono::milliseconds(100));
+        if (chrono::steady_clock::now() < next)
+            continue;
+
+        cout << metrics.render() << flush;
+        next += chrono::seconds(metricsInterval);
+    }
+}
+
 // ==================== ACCEPTOR LOOP ====================
 
 void Server::acceptorLoop()
@@ -110,6 +748,7 @@ void Server::acceptorLoop()
         
         cout << "[Server] Nova conexão aceita (FD: " << client_sockfd 
              << ") de: " << client_ip << endl;
+        prepareClientSocket(client_sockfd);
 
         // Cria thread worker para este cliente
         thread worker(&Server::handleClient, this, client_sockfd, string(client_ip));
@@ -130,39 +769,163 @@ void Server::handleClient(int client_sockfd, const string& client_ip)
     }
 
     CommandHandler handler(*this);
-    string buffer;
+    FrameReader reader;
+    bool greeted = false;
+    SocketUtils::Encoding connection_encoding = SocketUtils::Encoding::JSON;
+
+    // Prazos da conexão: a thread atende só este cliente, então basta comparar
+    // o instante do último evento com o relógio a cada volta (sem roda de timers)
+    using Clock = chrono::steady_clock;
+    Clock::time_point connected_at = Clock::now();
+    Clock::time_point last_receive = connected_at;
+    Clock::time_point last_progress = connected_at;     // Da fila de saída
+    bool authenticated = false;
+    bool was_pending = false;
+    auto expired = [](int seconds, Clock::time_point since, Clock::time_point now)
+    {
+        return seconds > 0 && now - since >= chrono::seconds(seconds);
+    };
+
+    // Espera do poll até o prazo mais próximo (-1: nenhum prazo ligado)
+    auto poll_timeout = [](int seconds, Clock::time_point since, Clock::time_point now, int current)
+    {
+        if (seconds <= 0)
+            return current;
+        auto left = chrono::ceil<chrono::milliseconds>(since + chrono::seconds(seconds) - now).count();
+        int ms = static_cast<int>(max<decltype(left)>(left, 0));
+        return current < 0 ? ms : min(current, ms);
+    };
+
+    // Fila de saída: quem roteia só enfileira; esta thread envia o que sobrar
+    auto outbound = make_shared<ClientOutbound>();
+    outbound->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (outbound->wakeFd < 0)
+    {
+        perror("[Server] Erro ao criar eventfd do cliente");
+        close(client_sockfd);
+        return;
+    }
+    {
+        lock_guard<mutex> lock(ownersMutex);
+        clientOutbound[client_sockfd] = outbound;
+    }
 
     try {
         while (isRunning)
         {
-            // Tenta receber mensagem
-            auto msg_opt = SocketUtils::receiveMessage(client_sockfd, buffer);
-            
-            if (msg_opt)
+            bool drained = false;
+            bool pending = false;
             {
-                // Mensagem completa recebida
-                string response = handler.processCommand(*msg_opt, client_sockfd);
-                
-                if (!response.empty())
-                    if (!sendToClient(client_sockfd, response))
-                        throw runtime_error("Erro ao enviar resposta");
+                lock_guard<mutex> lock(outbound->mutex);
+                if (!outbound->queue.empty())
+                {
+                    bool congested = outbound->queue.congested();
+                    size_t before = outbound->queue.bytes();
+                    if (!flushClient(client_sockfd, *outbound))
+                        throw runtime_error("Erro ao enviar");
+                    drained = congested && !outbound->queue.congested();
+                    if (outbound->queue.bytes() < before || !was_pending)
+                        last_progress = Clock::now();
+                }
+                pending = !outbound->queue.empty();
             }
-            else {
-                // Sem dados ou erro
-                // Verifica se houve desconexão
-                char test;
-                ssize_t n = recv(client_sockfd, &test, 1, MSG_PEEK | MSG_DONTWAIT);
-                
-                if (n == 0)
-                    // Conexão fechada
-                    throw runtime_error("Conexão fechada pelo cliente");
-                else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
-                    // Erro real
-                    throw runtime_error(string("Erro de rede: ") + strerror(errno));
-                
-                // Sem dados disponíveis: aguarda
-                this_thread::sleep_for(chrono::milliseconds(10));
+            was_pending = pending;
+            if (drained)
+                deliverDiverted(client_sockfd);
+
+            // Pipelining: executa em ordem os frames completos já recebidos (até
+            // MAX_PIPELINE_DEPTH por passada). As respostas só entram na fila e
+            // saem juntas no flush do início da próxima passada.
+            size_t processed = 0;
+            while (processed < IoBackend::MAX_PIPELINE_DEPTH)
+            {
+                auto frame = reader.next();
+                if (!frame)
+                    break;
+                ++processed;
+
+                string response;
+                if (!greeted)
+                {
+                    greeted = true;
+
+                    // HELLO_OK sai em linha; os frames seguintes, no framing e codificação negociados
+                    SocketUtils::Framing framing;
+                    SocketUtils::Encoding encoding;
+                    SocketUtils::Compression compression;
+                    if (handler.negotiateFraming(*frame, client_sockfd, response, framing, encoding, compression))
+                    {
+                        string_view hello_ok = response;
+                        if (!queueForClient(client_sockfd, *outbound, &hello_ok, 1, false))
+                            throw runtime_error("Erro ao enviar resposta");
+                        {
+                            lock_guard<mutex> lock(outbound->mutex);
+                            outbound->queue.setFraming(framing);
+                            outbound->queue.setEncoding(encoding);
+                            outbound->queue.setCompression(compression);
+                        }
+                        setClientEncoding(client_sockfd, encoding);
+                        connection_encoding = encoding;
+                        reader.setFraming(framing);
+                        reader.setCompression(compression);
+                        continue;
+                    }
+                }
+
+                response = handler.processCommand(*frame, client_sockfd, connection_encoding);
+                string_view view = response;
+                if (!response.empty() && !queueForClient(client_sockfd, *outbound, &view, 1, false))
+                    throw runtime_error("Erro ao enviar resposta");
             }
+            if (processed > 0)
+                continue;
+
+            // Nenhum frame completo no buffer: lê mais
+            ssize_t bytes = reader.fill(client_sockfd);
+            if (bytes > 0)
+            {
+                last_receive = Clock::now();
+                continue;
+            }
+            if (bytes == 0)
+                throw runtime_error("Conexão fechada pelo cliente");
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                throw runtime_error(string("Erro de rede: ") + strerror(errno));
+
+            // Sem dados: dorme até chegar algo, a fila de saída ter espaço, outra
+            // thread enfileirar saída (eventfd) ou vencer o prazo mais próximo
+            Clock::time_point now = Clock::now();
+            int timeout_ms = poll_timeout(timeouts.idleSeconds, last_receive, now, -1);
+            if (!authenticated)
+                timeout_ms = poll_timeout(timeouts.loginSeconds, connected_at, now, timeout_ms);
+            if (pending)
+                timeout_ms = poll_timeout(timeouts.writeStallSeconds, last_progress, now, timeout_ms);
+
+            pollfd pfds[2] = {
+                {client_sockfd, static_cast<short>(POLLIN | (pending ? POLLOUT : 0)), 0},
+                {outbound->wakeFd, POLLIN, 0},
+            };
+            poll(pfds, 2, timeout_ms);
+            if (pfds[1].revents & POLLIN)
+            {
+                uint64_t value;
+                while (read(outbound->wakeFd, &value, sizeof(value)) > 0) {}
+            }
+
+            now = Clock::now();
+            if (expired(timeouts.idleSeconds, last_receive, now))
+                throw runtime_error("Timeout de inatividade");
+            if (!authenticated && expired(timeouts.loginSeconds, connected_at, now))
+            {
+                {
+                    lock_guard<mutex> lock(stateMutex);
+                    authenticated = fdToUser.count(client_sockfd) > 0;
+                }
+                if (!authenticated)
+                    throw runtime_error("Login não realizado no prazo");
+            }
+            if (pending && expired(timeouts.writeStallSeconds, last_progress, now))
+                throw runtime_error("Escrita travada (cliente não lê)");
         }
     }
     catch (const exception& e)
@@ -171,6 +934,8 @@ void Server::handleClient(int client_sockfd, const string& client_ip)
              << ") desconectado. Motivo: " << e.what() << endl;
     }
 
+    // Sai do roteamento antes de liberar o fd (pode ser reutilizado pelo kernel)
+    unregisterConnection(client_sockfd);
     cleanupSession(client_sockfd);
 }
 
@@ -180,20 +945,19 @@ void Server::cleanupSession(int client_sockfd)
 {
     lock_guard<mutex> lock(stateMutex);
 
-    auto it = fdToNickname.find(client_sockfd);
-    if (it != fdToNickname.end())
+    auto it = fdToUser.find(client_sockfd);
+    if (it != fdToUser.end())
     {
-        string nickname = it->second;
+        UserId id = it->second;
 
         // Remove sessão
-        sessions.erase(nickname);
-        fdToNickname.erase(it);
+        sessions.erase(id);
+        fdToUser.erase(it);
 
         // Marca usuário como offline
-        if (users.count(nickname))
-            users[nickname].isLogged = false;
+        users[id].isLogged = false;
 
-        cout << "[Server] Sessão limpa para: " << nickname << endl;
+        cout << "[Server] Sessão limpa para: " << nicknames.name(id) << endl;
     }
 
     // Fecha socket
@@ -204,22 +968,273 @@ void Server::cleanupSession(int client_sockfd)
 
 bool Server::sendToClient(int sockfd, const string& json_message)
 {
-    return SocketUtils::sendMessage(sockfd, json_message);
+    // Nos modos orientados a eventos a escrita passa pelo backend dono da conexão
+    if (!backends.empty())
+    {
+        ConnectionOwner owner{nullptr, 0};
+        {
+            lock_guard<mutex> lock(ownersMutex);
+            auto it = connectionOwners.find(sockfd);
+            if (it != connectionOwners.end())
+                owner = it->second;
+        }
+        return owner.backend ? owner.backend->send(sockfd, owner.connId, json_message) : false;
+    }
+
+    string_view message = json_message;
+    return enqueueToClient(sockfd, &message, 1);
 }
 
-void Server::deliverPendingMessages(int client_sockfd, const string& nickname)
+bool Server::sendBatchToClient(int sockfd, const vector<string_view>& messages)
 {
-    if (messageQueues.count(nickname))
-    {
-        MessageQueue& queue = messageQueues[nickname];
+    if (messages.empty())
+        return true;
 
-        while (!queue.empty())
+    if (!backends.empty())
+    {
+        ConnectionOwner owner{nullptr, 0};
         {
-            string msg = queue.front();
-            queue.pop();
-
-            sendToClient(client_sockfd, msg);
-            cout << "[Server] Mensagem pendente entregue a " << nickname << endl;
+            lock_guard<mutex> lock(ownersMutex);
+            auto it = connectionOwners.find(sockfd);
+            if (it != connectionOwners.end())
+                owner = it->second;
         }
+        return owner.backend ? owner.backend->sendBatch(sockfd, owner.connId, messages) : false;
+    }
+
+    return enqueueToClient(sockfd, messages.data(), messages.size());
+}
+
+bool Server::enqueueToClient(int sockfd, const string_view* messages, size_t count)
+{
+    shared_ptr<ClientOutbound> outbound;
+    {
+        lock_guard<mutex> lock(ownersMutex);
+        auto it = clientOutbound.find(sockfd);
+        if (it != clientOutbound.end())
+            outbound = it->second;
+    }
+    if (!outbound)
+        return false;
+
+    return queueForClient(sockfd, *outbound, messages, count, true);
+}
+
+bool Server::queueForClient(int sockfd, ClientOutbound& outbound, const string_view* messages,
+                            size_t count, bool flush_if_idle)
+{
+    // Fila vazia: tenta enviar já (sem bloquear); senão a thread do cliente envia
+    lock_guard<mutex> lock(outbound.mutex);
+    bool idle = outbound.queue.empty();
+    for (size_t i = 0; i < count; ++i)
+        outbound.queue.push(messages[i]);
+    if (idle && flush_if_idle)
+    {
+        if (!flushClient(sockfd, outbound))
+            return false;
+        if (outbound.queue.empty())
+            return true;
+
+        // Sobrou saída: a thread do cliente pode estar em poll sem POLLOUT
+        outbound.wake();
+    }
+
+    // Consumidor lento: a thread do cliente nota o shutdown e encerra a sessão
+    if (!enforceOutboundLimits(sockfd, outbound.queue, 0))
+    {
+        outbound.queue.clear();
+        shutdown(sockfd, SHUT_RDWR);
+        return false;
+    }
+
+    setCongested(sockfd, outbound.queue.congested());
+    return true;
+}
+
+bool Server::isCongested(int sockfd)
+{
+    lock_guard<mutex> lock(ownersMutex);
+    return congestedConnections.count(sockfd) > 0;
+}
+
+void Server::setCongested(int sockfd, bool congested)
+{
+    lock_guard<mutex> lock(ownersMutex);
+    if (congested)
+        congestedConnections.insert(sockfd);
+    else
+        congestedConnections.erase(sockfd);
+}
+
+SocketUtils::Encoding Server::clientEncoding(int sockfd)
+{
+    lock_guard<mutex> lock(ownersMutex);
+    auto it = connectionEncodings.find(sockfd);
+    return it != connectionEncodings.end() ? it->second : SocketUtils::Encoding::JSON;
+}
+
+void Server::setClientEncoding(int sockfd, SocketUtils::Encoding encoding)
+{
+    lock_guard<mutex> lock(ownersMutex);
+    if (encoding != SocketUtils::Encoding::JSON)
+        connectionEncodings[sockfd] = encoding;
+    else
+        connectionEncodings.erase(sockfd);
+}
+
+bool Server::enforceOutboundLimits(int sockfd, OutboundQueue& queue, size_t keep_front)
+{
+    uint64_t max_age_ms = static_cast<uint64_t>(slowConsumer.maxAgeSeconds) * 1000;
+    if (!queue.exceeds(slowConsumer.maxBytes, max_age_ms))
+        return true;
+
+    // Frames comprimidos fazem parte do histórico do peer: descartar um quebraria o fluxo
+    if (slowConsumer.policy == SlowConsumerPolicy::DROP_OLDEST &&
+        queue.getCompression() == SocketUtils::Compression::NONE)
+    {
+        size_t dropped = queue.dropOldest(slowConsumer.maxBytes, max_age_ms, keep_front);
+        slowDroppedFrames.fetch_add(dropped, memory_order_relaxed);
+        if (dropped > 0)
+            cerr << "[Server] Consumidor lento (FD: " << sockfd << "): "
+                 << dropped << " frame(s) antigo(s) descartado(s)" << endl;
+        return true;
+    }
+
+    // DISCONNECT, ou OFFLINE com a fila cheia mesmo com as mensagens desviadas
+    slowDisconnects.fetch_add(1, memory_order_relaxed);
+    cerr << "[Server] Consumidor lento (FD: " << sockfd << "): fila de saída com "
+         << queue.bytes() << " bytes, derrubando conexão" << endl;
+    return false;
+}
+
+bool Server::shouldDivert(int sockfd, UserId id)
+{
+    // No modo sharded as filas offline são particionadas entre os shards
+    if (slowConsumer.policy != SlowConsumerPolicy::OFFLINE || ioMode == IoMode::SHARDED)
+        return false;
+
+    auto queue = messageQueues.find(id);
+    if (!isCongested(sockfd) && (queue == messageQueues.end() || queue->second.empty()))
+        return false;
+
+    slowDiverted.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+
+void Server::deliverDiverted(int sockfd)
+{
+    if (slowConsumer.policy != SlowConsumerPolicy::OFFLINE || ioMode == IoMode::SHARDED)
+        return;
+
+    lock_guard<mutex> lock(stateMutex);
+
+    auto it = fdToUser.find(sockfd);
+    if (it == fdToUser.end())
+        return;
+
+    // Entrega enquanto a saída aguenta; o resto espera a próxima drenagem
+    auto queue = messageQueues.find(it->second);
+    if (queue == messageQueues.end())
+        return;
+
+    size_t delivered = 0;
+    while (!queue->second.empty() && !isCongested(sockfd))
+    {
+        if (!sendToClient(sockfd, queue->second.front()))
+            break;
+        queue->second.pop();
+        ++delivered;
+    }
+
+    if (delivered > 0)
+        cout << "[Server] " << delivered << " mensagem(ns) desviada(s) entregue(s) a "
+             << nicknames.name(it->second) << endl;
+}
+
+Server::ClientOutbound::~ClientOutbound()
+{
+    if (wakeFd >= 0)
+        close(wakeFd);
+}
+
+void Server::ClientOutbound::wake()
+{
+    if (wakeFd < 0)
+        return;
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+bool Server::flushClient(int sockfd, ClientOutbound& outbound)
+{
+    OutboundQueue::FlushResult result = outbound.queue.flush(sockfd);
+    writevCalls.fetch_add(result.syscalls, memory_order_relaxed);
+    framesFlushed.fetch_add(result.frames, memory_order_relaxed);
+    setCongested(sockfd, outbound.queue.congested());
+    return result.ok;
+}
+
+void Server::prepareClientSocket(int sockfd)
+{
+    if (timeouts.keepAliveSeconds > 0)
+        SocketUtils::enableKeepAlive(sockfd, timeouts.keepAliveSeconds,
+                                     KEEPALIVE_INTERVAL, KEEPALIVE_PROBES);
+}
+
+void Server::registerConnection(int sockfd, IoBackend* owner, uint64_t conn_id)
+{
+    lock_guard<mutex> lock(ownersMutex);
+    connectionOwners[sockfd] = {owner, conn_id};
+}
+
+void Server::unregisterConnection(int sockfd)
+{
+    lock_guard<mutex> lock(ownersMutex);
+    connectionOwners.erase(sockfd);
+    congestedConnections.erase(sockfd);
+    connectionEncodings.erase(sockfd);
+    clientOutbound.erase(sockfd);
+}
+
+void Server::deliverPendingMessages(int client_sockfd, UserId id)
+{
+    auto it = messageQueues.find(id);
+    if (it == messageQueues.end() || it->second.empty())
+        return;
+
+    // A fila inteira vai num lote: poucos writev em vez de um envio por mensagem
+    MessageQueue pending;
+    pending.swap(it->second);
+
+    vector<string> messages;
+    messages.reserve(pending.size());
+    for (; !pending.empty(); pending.pop())
+        messages.push_back(std::move(pending.front()));
+
+    sendBatchToClient(client_sockfd, vector<string_view>(messages.begin(), messages.end()));
+    cout << "[Server] " << messages.size() << " mensagem(ns) pendente(s) entregue(s) a "
+         << nicknames.name(id) << endl;
+}
+
+UserId Server::addUser(string_view nickname, string_view full_name)
+{
+    UserId id = nicknames.intern(nickname);
+    if (id >= users.size())
+        users.resize(id + 1);
+    users[id] = {string(full_name), false};
+    return id;
+}
+
+void Server::removeUser(UserId id)
+{
+    auto session = sessions.find(id);
+    if (session != sessions.end())
+    {
+        fdToUser.erase(session->second);
+        sessions.erase(session);
     }
+    messageQueues.erase(id);
+    users[id] = {};
+    nicknames.release(id);
 }
\ No newline at end of file
@@ -1,14 +1,23 @@
 #pragma once
 
+#include "metrics.hpp"
+#include "nickname_table.hpp"
+#include "outbound_queue.hpp"
 #include <atomic>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 class CommandHandler;
+class IoBackend;
+class WorkerPool;
+struct HandoffConnection;
 
 // ==================== ESTRUTURAS DE DADOS ====================
 
@@ -28,6 +37,76 @@ struct UserData
     bool isLogged = false;
 };
 
+/**
+ * Modelo de I/O do servidor
+ */
+enum class IoMode
+{
+    THREADS,    // 1 acceptor + 1 thread por cliente (modelo original)
+    EPOLL,      // Loop de eventos epoll edge-triggered (padrão)
+    URING,      // io_uring com accept/recv multishot (recai para epoll se indisponível)
+    SHARDED,    // Shared-nothing: um reactor epoll por núcleo, dono de uma partição dos usuários
+    COROUTINES  // Reactor epoll com uma corrotina C++20 por sessão
+};
+
+/**
+ * Estrutura TimeoutConfig
+ * -----------------------
+ * Prazos por conexão aplicados pelos backends (roda de timers nos reactors e
+ * no io_uring, relógio da thread no modo threads) e ociosidade antes das
+ * sondas do TCP keepalive. Valor 0 desliga o respectivo prazo. Inatividade e
+ * login vêm desligados: o cliente não envia nada enquanto o usuário só lê.
+ */
+struct TimeoutConfig
+{
+    int idleSeconds = 0;            // Sem receber dados do cliente (o protocolo não tem heartbeat)
+    int loginSeconds = 0;           // Conectado sem autenticar
+    int writeStallSeconds = 30;     // Buffer de saída sem progresso (cliente não lê)
+    int keepAliveSeconds = 60;      // Ociosidade antes das sondas TCP
+};
+
+/**
+ * Ação tomada quando a fila de saída de um cliente passa dos limites
+ */
+enum class SlowConsumerPolicy
+{
+    DISCONNECT,     // Derruba a conexão
+    OFFLINE,        // Desvia mensagens novas para a fila offline até a saída drenar
+    DROP_OLDEST     // Descarta os frames mais antigos ainda não enviados
+};
+
+/**
+ * Estrutura SlowConsumerConfig
+ * ----------------------------
+ * Limites da fila de saída por conexão e a política aplicada ao excedê-los.
+ */
+struct SlowConsumerConfig
+{
+    SlowConsumerPolicy policy = SlowConsumerPolicy::DISCONNECT;
+    size_t maxBytes = 4 * 1024 * 1024;  // Bytes aguardando envio (0 = sem limite)
+    int maxAgeSeconds = 30;             // Espera do frame mais antigo (0 = sem limite)
+};
+
+/**
+ * Estrutura ServerConfig
+ * ----------------------
+ * Parâmetros de inicialização do servidor (preenchidos a partir da linha de comando).
+ */
+struct ServerConfig
+{
+    int port = 12345;
+    IoMode ioMode = IoMode::EPOLL;
+    int reactors = 1;           // Loops de eventos, cada um com seu listener SO_REUSEPORT (0 = núcleos)
+    bool pinCpus = false;       // Fixa o reactor i no núcleo i e direciona conexões via SO_INCOMING_CPU
+    int workers = 0;            // Threads do pool de comandos (0 = executa no loop de I/O)
+    int workerQueue = 1024;     // Jobs aguardando no pool antes de executar na thread de I/O
+    int metricsInterval = 0;    // Segundos entre impressões das métricas (0 = desligado)
+    TimeoutConfig timeouts;
+    SlowConsumerConfig slowConsumer;
+    std::string upgradeSocket;  // Socket Unix onde um novo processo pede a atualização a quente
+    std::string takeoverSocket; // Socket Unix do processo antigo (assume as conexões dele)
+};
+
 // ==================== CLASSE SERVER ====================
 
 /**
@@ -45,6 +124,12 @@ public:
      * @param port Porta TCP onde o servidor irá escutar conexões
      */
     explicit Server(int port);
+
+    /**
+     * Construtor do servidor a partir de uma configuração completa.
+     * @param config Porta e modelo de I/O
+     */
+    explicit Server(const ServerConfig& config);
     ~Server();
 
     /**
@@ -56,34 +141,138 @@ public:
     
     /**
      * Executa o loop principal do servidor.
-     * Inicia a thread de aceitação (acceptor) e bloqueia até o encerramento.
+     * No modo THREADS inicia a thread de aceitação (acceptor); nos demais modos
+     * executa um backend de eventos por reactor configurado (o primeiro na
+     * thread atual). Bloqueia até o encerramento.
      */
     void run();
 
     // ==================== ACESSO A DADOS (Thread-Safe via Mutex) ====================
-    std::unordered_map<std::string, UserData>& getUsers()             { return users;         }
-    std::unordered_map<std::string, int>& getSessions()               { return sessions;      }
-    std::unordered_map<std::string, MessageQueue>& getMessageQueues() { return messageQueues; }
-    std::unordered_map<int, std::string>& getFdToNickname()           { return fdToNickname;  }
+    NicknameTable& getNicknames()                                { return nicknames;     }
+    std::vector<UserData>& getUsers()                            { return users;         }
+    std::unordered_map<UserId, int>& getSessions()               { return sessions;      }
+    std::unordered_map<UserId, MessageQueue>& getMessageQueues() { return messageQueues; }
+    std::unordered_map<int, UserId>& getFdToUser()               { return fdToUser;      }
     std::mutex& getStateMutex() { return stateMutex; }
+    Metrics& getMetrics()       { return metrics;    }
+    const TimeoutConfig& getTimeouts() const { return timeouts; }
 
     // ==================== OPERAÇÕES AUXILIARES ====================
+
+    /**
+     * Enfileira uma mensagem na fila de saída do cliente (qualquer thread).
+     * Nos modos de eventos a fila pertence ao backend dono do socket; no modo
+     * threads, à thread do cliente. Não bloqueia.
+     */
     bool sendToClient(int sockfd, const std::string& json_message);
-    void deliverPendingMessages(int client_sockfd, const std::string& nickname);
+
+    /**
+     * Enfileira várias mensagens para o cliente de uma vez (qualquer thread):
+     * um único acesso à fila de saída e um flush (writev) para o lote.
+     */
+    bool sendBatchToClient(int sockfd, const std::vector<std::string_view>& messages);
+
+    /**
+     * Indica se a fila de saída do cliente passou do high watermark (e ainda
+     * não voltou abaixo do low). Qualquer thread.
+     */
+    bool isCongested(int sockfd);
+
+    /**
+     * Codificação negociada no HELLO da conexão (JSON antes dele ou se o fd
+     * não é conhecido). Qualquer thread; quem entrega a terceiros monta a
+     * mensagem já nela.
+     */
+    SocketUtils::Encoding clientEncoding(int sockfd);
+    void deliverPendingMessages(int client_sockfd, UserId id);
+
+    /**
+     * Registra o usuário (interna o apelido) e remove um usuário com a
+     * sessão e a fila offline dele. Chamados com stateMutex adquirido.
+     */
+    UserId addUser(std::string_view nickname, std::string_view full_name);
+    void removeUser(UserId id);
 
 private:
     // Variáveis de sistema
     int port;
+    IoMode ioMode;
+    int reactorCount;
+    bool pinCpus;
+    int workerCount;
+    int workerQueue;
+    int metricsInterval;
+    TimeoutConfig timeouts;
+    SlowConsumerConfig slowConsumer;
     int server_sockfd;
     std::atomic<bool> isRunning;
     std::thread acceptorThread;
+    std::thread metricsThread;
+
+    // Atualização a quente (handoff por SCM_RIGHTS)
+    std::string upgradePath;
+    std::string takeoverPath;
+    int upgradeListenFd;
+    int takeoverFd;
+    std::atomic<int> upgradeClient;     // Novo processo aguardando o handoff (-1 = nenhum)
+    int upgradeWakeFd;                  // Acorda a thread de atualização (fim do handoff, encerramento)
+    std::thread upgradeThread;
+    Metrics metrics;
 
-    // Estruturas de estado (thread-safe via stateMutex)
+    // Backends de eventos (um por reactor) e dono de cada conexão
+    std::vector<int> listenSockets;
+    std::vector<std::unique_ptr<IoBackend>> backends;
+    std::vector<std::thread> backendThreads;
+    std::mutex ownersMutex;
+
+    /**
+     * Backend dono de uma conexão e o id que ele deu a ela (as escritas de
+     * outras threads levam o id: o fd pode ser reaproveitado antes da entrega)
+     */
+    struct ConnectionOwner
+    {
+        IoBackend* backend;
+        uint64_t connId;
+    };
+    std::unordered_map<int, ConnectionOwner> connectionOwners;
+    std::unordered_set<int> congestedConnections;
+    std::unordered_map<int, SocketUtils::Encoding> connectionEncodings;  // Só as que negociaram
+
+    /**
+     * Fila de saída de um cliente no modo threads (compartilhada entre a
+     * thread do cliente e quem roteia mensagens para ele). O eventfd acorda a
+     * thread do cliente, parada em poll, quando outra thread deixa saída
+     * pendente na fila ou o servidor encerra.
+     */
+    struct ClientOutbound
+    {
+        std::mutex mutex;
+        OutboundQueue queue;
+        int wakeFd = -1;
+
+        ~ClientOutbound();
+        void wake();
+    };
+    std::unordered_map<int, std::shared_ptr<ClientOutbound>> clientOutbound;  // Sob ownersMutex
+    std::atomic<uint64_t>& writevCalls;
+    std::atomic<uint64_t>& framesFlushed;
+
+    // Ações de consumidor lento
+    std::atomic<uint64_t>& slowDisconnects;
+    std::atomic<uint64_t>& slowDroppedFrames;
+    std::atomic<uint64_t>& slowDiverted;
+
+    // Pool de comandos (destruído antes dos backends: os jobs os referenciam)
+    std::unique_ptr<WorkerPool> pool;
+
+    // Estruturas de estado (thread-safe via stateMutex), indexadas pelo id
+    // interno do usuário; o apelido só é consultado nas bordas do protocolo
     std::mutex stateMutex;
-    std::unordered_map<std::string, UserData> users;
-    std::unordered_map<std::string, int> sessions;
-    std::unordered_map<std::string, MessageQueue> messageQueues;
-    std::unordered_map<int, std::string> fdToNickname;
+    NicknameTable nicknames;
+    std::vector<UserData> users;                            // Por UserId (vaga livre: id não registrado)
+    std::unordered_map<UserId, int> sessions;
+    std::unordered_map<UserId, MessageQueue> messageQueues;
+    std::unordered_map<int, UserId> fdToUser;
 
     /**
      * Loop principal de aceitação de conexões (Thread Acceptor).
@@ -106,6 +295,135 @@ private:
      */
     void cleanupSession(int client_sockfd);
 
-    // Command handler (friend pra acesso aos dados)
+    /**
+     * Imprime periodicamente as métricas (Thread de métricas).
+     */
+    void metricsLoop();
+
+    /**
+     * Cria, faz bind e listen de um socket de escuta.
+     * @param reuse_port Habilita SO_REUSEPORT (vários listeners na mesma porta)
+     * @param incoming_cpu Núcleo preferido para SO_INCOMING_CPU (-1 = nenhum)
+     * @return Descritor do socket ou -1 em caso de erro
+     */
+    int createListener(bool reuse_port, int incoming_cpu);
+
+    /**
+     * Cria o backend de eventos correspondente ao modo configurado.
+     * @param listen_fd Socket de escuta próprio do backend
+     * @param index Posição do backend (partição no modo SHARDED)
+     * @return nullptr se nenhum backend pôde ser inicializado
+     */
+    std::unique_ptr<IoBackend> createBackend(int listen_fd, int index);
+
+    /**
+     * Executa os backends (o primeiro na thread atual) até todos pararem.
+     */
+    void runBackends();
+
+    // ==================== Atualização a quente ====================
+
+    /**
+     * Conecta ao processo antigo e recebe os listeners, as conexões e o
+     * estado dos usuários (substitui start()).
+     * @param inherited Conexões recebidas, a distribuir entre os backends
+     */
+    bool takeOver(std::vector<HandoffConnection>& inherited);
+
+    /**
+     * Confirma ao processo antigo que as conexões foram assumidas.
+     */
+    void completeTakeover();
+
+    /**
+     * Cria o socket Unix de atualização e a thread que o atende.
+     */
+    bool openUpgradeSocket();
+
+    /**
+     * Aguarda um novo processo no socket de atualização e para os backends
+     * (Thread de atualização).
+     */
+    void upgradeLoop();
+
+    /**
+     * Acorda a thread de atualização para reavaliar o estado.
+     */
+    void wakeUpgradeLoop();
+
+    /**
+     * Transfere listeners, conexões e estado ao novo processo. Se ele não
+     * confirmar, as conexões voltam aos backends e o servidor continua.
+     * @return true se o processo novo assumiu (este deve encerrar)
+     */
+    bool handOff();
+
+    /**
+     * Configura um socket recém-aceito (TCP keepalive).
+     */
+    void prepareClientSocket(int sockfd);
+
+    /**
+     * Registra/remove o backend dono de uma conexão (chamado pelos backends).
+     */
+    void registerConnection(int sockfd, IoBackend* owner, uint64_t conn_id);
+    void unregisterConnection(int sockfd);
+
+    /**
+     * Atualiza o estado de watermark da fila de saída (chamado pelos donos das filas).
+     */
+    void setCongested(int sockfd, bool congested);
+
+    /**
+     * Registra a codificação negociada no HELLO (chamado pelos donos das filas).
+     */
+    void setClientEncoding(int sockfd, SocketUtils::Encoding encoding);
+
+    /**
+     * Aplica os limites de consumidor lento a uma fila que acabou de crescer
+     * (chamado pelo dono da fila). Com DROP_OLDEST descarta os frames mais
+     * antigos (exceto em conexões comprimidas); nas demais políticas o
+     * excesso derruba a conexão.
+     * @param keep_front Frames da frente que não podem ser descartados (em envio)
+     * @return false se a conexão deve ser derrubada
+     */
+    bool enforceOutboundLimits(int sockfd, OutboundQueue& queue, size_t keep_front);
+
+    /**
+     * Política OFFLINE: indica se a mensagem para o destinatário deve ir à
+     * fila offline (saída congestionada ou mensagens desviadas ainda na fila,
+     * preservando a ordem). Chamado com stateMutex adquirido.
+     */
+    bool shouldDivert(int sockfd, UserId id);
+
+    /**
+     * Política OFFLINE: entrega as mensagens desviadas após a saída do
+     * cliente drenar (chamado pelo dono da fila, sem stateMutex).
+     */
+    void deliverDiverted(int sockfd);
+
+    /**
+     * Modo threads: enfileira 'count' mensagens na fila do cliente e envia o
+     * que couber se ela estava vazia.
+     */
+    bool enqueueToClient(int sockfd, const std::string_view* messages, size_t count);
+
+    /**
+     * Modo threads: enfileira na fila já localizada, aplicando os limites de
+     * consumidor lento. Com flush_if_idle, envia na hora se ela estava vazia;
+     * sem, deixa o envio para o flush da thread do cliente (respostas em lote).
+     */
+    bool queueForClient(int sockfd, ClientOutbound& outbound, const std::string_view* messages,
+                        size_t count, bool flush_if_idle);
+
+    /**
+     * Envia a fila de saída de um cliente do modo threads (com o mutex dela adquirido).
+     * @return false em caso de erro fatal no socket
+     */
+    bool flushClient(int sockfd, ClientOutbound& outbound);
+
+    // Command handler e backends de I/O (friends pra acesso aos dados)
     friend class CommandHandler;
+    friend class Reactor;
+    friend class UringBackend;
 };
\ No newline at end of file
@@ -0,0 +1,689 @@
+#include "shard.hpp"
+#include "request_parser.hpp"
+#include "socket_utils.hpp"
+#include <ctime>
+#include <functional>
+#include <iostream>
+
+using json = nlohmann::json;
+using namespace Protocol;
+using namespace std;
+
+namespace
+{
+    constexpr size_t CHANNEL_CAPACITY = 256;   // Slots por fila SPSC (par origem/destino)
+}
+
+// ==================== CONSTRUTOR ====================
+
+Shard::Shard(Server& server, int listen_fd, int id, int count)
+    : Reactor(server, listen_fd), shardId(id), shardCount(count),
+      overflow(count), wakePending(count, false), nextConnId(1), nextRequestId(1) {}
+
+void Shard::connect(const vector<Shard*>& shards)
+{
+    for (Shard* shard : shards)
+    {
+        shard->peers = shards;
+        shard->inbox.clear();
+        for (size_t src = 0; src < shards.size(); ++src)
+            shard->inbox.push_back(make_unique<SpscQueue<ShardMessage>>(CHANNEL_CAPACITY));
+    }
+}
+
+int Shard::ownerOf(string_view nickname) const
+{
+    return static_cast<int>(hash<string_view>{}(nickname) % static_cast<size_t>(shardCount));
+}
+
+// ==================== TROCA DE MENSAGENS ENTRE NÚCLEOS ====================
+
+void Shard::post(int target, ShardMessage&& msg)
+{
+    if (target == shardId)
+    {
+        handleMessage(msg);
+        return;
+    }
+
+    // Preserva a ordem: se já há mensagens retidas para o destino, entra atrás delas
+    if (!overflow[target].empty() || !peers[target]->inbox[shardId]->push(std::move(msg)))
+        overflow[target].push_back(std::move(msg));
+
+    // O destino é acordado uma única vez ao fim do lote (afterEvents)
+    wakePending[target] = true;
+}
+
+void Shard::flushOverflow()
+{
+    for (int target = 0; target < shardCount; ++target)
+    {
+        auto& pending = overflow[target];
+        auto& queue = *peers[target]->inbox[shardId];
+        while (!pending.empty() && queue.push(std::move(pending.front())))
+        {
+            pending.pop_front();
+            // O destino já drenou o que havia: precisa ser acordado de novo
+            wakePending[target] = true;
+        }
+    }
+}
+
+void Shard::drainInbox()
+{
+    ShardMessage msg;
+    for (auto& queue : inbox)
+        while (queue->pop(msg))
+            handleMessage(msg);
+}
+
+void Shard::onWake()
+{
+    drainInbox();
+}
+
+void Shard::afterEvents()
+{
+    flushOverflow();
+
+    bool retained = false;
+    for (int target = 0; target < shardCount; ++target)
+    {
+        if (wakePending[target])
+        {
+            peers[target]->wake();
+            wakePending[target] = false;
+        }
+        retained = retained || !overflow[target].empty();
+    }
+
+    // Fila de algum destino cheia: volta ao loop para tentar de novo
+    if (retained)
+        wake();
+}
+
+void Shard::handleMessage(ShardMessage& msg)
+{
+    switch (msg.kind)
+    {
+        case ShardMessage::Kind::REQUEST:
+            switch (msg.type)
+            {
+                case MessageType::REGISTER    : ownerRegister(msg);    break;
+                case MessageType::LOGIN       : ownerLogin(msg);       break;
+                case MessageType::SEND_MSG    : ownerSendMessage(msg); break;
+                case MessageType::DELETE_USER : ownerDeleteUser(msg);  break;
+                default: break;
+            }
+            break;
+
+        case ShardMessage::Kind::CLEANUP:      ownerLogout(msg);       break;
+        case ShardMessage::Kind::LIST_REQUEST: ownerListUsers(msg);    break;
+        case ShardMessage::Kind::RESPONSE:     completeResponse(msg);  break;
+        case ShardMessage::Kind::LIST_PART:    completeListPart(msg);  break;
+
+        case ShardMessage::Kind::DELIVER:
+        {
+            auto it = localConnections.find(msg.fd);
+            if (it != localConnections.end() && it->second.id == msg.connId)
+                send(msg.fd, encodeDeliverMessage(msg.argument, msg.payload, msg.timestamp,
+                                                  encodingOf(msg.fd)));
+            break;
+        }
+    }
+}
+
+// ==================== LADO DA CONEXÃO ====================
+
+void Shard::onConnectionOpened(int sockfd)
+{
+    localConnections[sockfd] = LocalConnection{nextConnId++, "", false};
+}
+
+void Shard::onConnectionClosed(int sockfd)
+{
+    auto it = localConnections.find(sockfd);
+    if (it != localConnections.end())
+    {
+        // Avisa o dono da partição para encerrar a sessão
+        if (!it->second.nickname.empty())
+        {
+            ShardMessage msg;
+            msg.kind = ShardMessage::Kind::CLEANUP;
+            msg.origin = shardId;
+            msg.fd = sockfd;
+            msg.connId = it->second.id;
+            msg.nickname = it->second.nickname;
+            post(ownerOf(msg.nickname), std::move(msg));
+        }
+        localConnections.erase(it);
+    }
+
+    SocketUtils::closeSocket(sockfd);
+}
+
+bool Shard::isAuthenticated(int sockfd)
+{
+    auto it = localConnections.find(sockfd);
+    return it != localConnections.end() && (!it->second.nickname.empty() || it->second.loginPending);
+}
+
+void Shard::dispatchFrame(int sockfd, string_view message)
+{
+    auto it = localConnections.find(sockfd);
+    if (it == localConnections.end())
+        return;
+
+    // Respondido na hora (local) ou só quando o dono devolver (ver frameAnswered)
+    it->second.awaitingReply = true;
+    SocketUtils::Encoding encoding = encodingOf(sockfd);
+
+    try
+    {
+        Request request = parseRequest(message);
+        if (request.type == MessageType::BATCH)
+            dispatchBatch(sockfd, it->second, message);
+        else
+            dispatchRequest(sockfd, it->second, request, {});
+    }
+    catch (const json::parse_error& e)
+    {
+        cerr << "[CommandHandler] Erro de parsing JSON: " << e.what() << endl;
+        respond(sockfd, {}, errorResponse(ErrorType::BAD_FORMAT, encoding));
+    }
+    catch (const ParseException& e)
+    {
+        cerr << "[CommandHandler] Erro de protocolo: " << e.what() << endl;
+        respond(sockfd, {}, errorResponse(ErrorType::BAD_FORMAT, encoding));
+    }
+    catch (const exception& e)
+    {
+        cerr << "[CommandHandler] Erro interno: " << e.what() << endl;
+        respond(sockfd, {}, errorResponse(ErrorType::INTERNAL_SERVER_ERROR, encoding));
+    }
+
+    // Resposta em outro shard: os próximos frames esperam no buffer de leitura
+    it = localConnections.find(sockfd);
+    if (it != localConnections.end() && it->second.awaitingReply)
+        setReadPaused(sockfd, true);
+}
+
+void Shard::frameAnswered(int sockfd)
+{
+    auto it = localConnections.find(sockfd);
+    if (it == localConnections.end() || !it->second.awaitingReply)
+        return;
+
+    it->second.awaitingReply = false;
+    setReadPaused(sockfd, false);
+}
+
+void Shard::dispatchRequest(int sockfd, LocalConnection& conn, const Request& request, ReplySlot slot)
+{
+    SocketUtils::Encoding encoding = encodingOf(sockfd);
+    try
+    {
+        MessageType type = request.type;
+
+        switch (type)
+        {
+            case MessageType::REGISTER:
+            {
+                string_view nickname = parseNickname(request);
+                string_view fullName = parseFullName(request);
+                forward(sockfd, conn, slot, type, nickname, fullName);
+                return;
+            }
+
+            case MessageType::LOGIN:
+            {
+                string_view nickname = parseNickname(request);
+                if (conn.nickname.empty() && !conn.loginPending)
+                    conn.loginPending = true;
+                else if (conn.nickname.empty())
+                {
+                    // Outro LOGIN ainda em andamento nesta conexão
+                    respond(sockfd, slot, errorResponse(ErrorType::BAD_STATE, encoding));
+                    return;
+                }
+                // O dono verifica existência/sessão antes do estado da conexão
+                forward(sockfd, conn, slot, type, nickname, conn.nickname);
+                return;
+            }
+
+            case MessageType::LOGOUT:
+            {
+                if (conn.nickname.empty())
+                {
+                    respond(sockfd, slot, errorResponse(ErrorType::BAD_STATE, encoding));
+                    return;
+                }
+
+                string nickname = std::move(conn.nickname);
+                conn.nickname.clear();
+
+                ShardMessage msg;
+                msg.kind = ShardMessage::Kind::CLEANUP;
+                msg.origin = shardId;
+                msg.fd = sockfd;
+                msg.connId = conn.id;
+                msg.nickname = nickname;
+                post(ownerOf(nickname), std::move(msg));
+
+                cout << "[Server] Logout: " << nickname << endl;
+                respond(sockfd, slot, okResponse(encoding));
+                return;
+            }
+
+            case MessageType::SEND_MSG:
+            {
+                if (conn.nickname.empty())
+                {
+                    respond(sockfd, slot, errorResponse(ErrorType::UNAUTHORIZED, encoding));
+                    return;
+                }
+                string_view to = parseRecipient(request);
+                string_view text = parseMessageText(request);
+                forward(sockfd, conn, slot, type, to, conn.nickname, text);
+                return;
+            }
+
+            case MessageType::LIST_USERS:
+            {
+                // Scatter-gather: cada partição devolve seus usuários
+                uint64_t request_id = nextRequestId++;
+                pendingLists[request_id] = PendingList{sockfd, conn.id, shardCount, {}, slot};
+
+                for (int target = 0; target < shardCount; ++target)
+                {
+                    ShardMessage msg;
+                    msg.kind = ShardMessage::Kind::LIST_REQUEST;
+                    msg.origin = shardId;
+                    msg.requestId = request_id;
+                    post(target, std::move(msg));
+                }
+                return;
+            }
+
+            case MessageType::DELETE_USER:
+            {
+                string_view nickname = parseNickname(request);
+                forward(sockfd, conn, slot, type, nickname, conn.nickname);
+                return;
+            }
+
+            // Framing só é negociado no primeiro frame (Reactor::negotiateFraming)
+            case MessageType::HELLO:
+                respond(sockfd, slot, errorResponse(ErrorType::BAD_STATE, encoding));
+                return;
+
+            default:
+                respond(sockfd, slot, errorResponse(ErrorType::UNKNOWN_COMMAND, encoding));
+                return;
+        }
+    }
+    catch (const ParseException& e)
+    {
+        cerr << "[CommandHandler] Erro de protocolo: " << e.what() << endl;
+        respond(sockfd, slot, errorResponse(ErrorType::BAD_FORMAT, encoding));
+    }
+    catch (const exception& e)
+    {
+        cerr << "[CommandHandler] Erro interno: " << e.what() << endl;
+        respond(sockfd, slot, errorResponse(ErrorType::INTERNAL_SERVER_ERROR, encoding));
+    }
+}
+
+void Shard::dispatchBatch(int sockfd, LocalConnection& conn, string_view frame)
+{
+    // Os itens são despachados ao longo de várias voltas do loop: a requisição
+    // é interpretada de novo sobre uma cópia do frame
+    uint64_t batch_id = nextRequestId++;
+    PendingBatch& batch = pendingBatches[batch_id];
+    batch.fd = sockfd;
+    batch.connId = conn.id;
+    batch.frame = frame;
+    batch.request = parseRequest(batch.frame);
+
+    if (batch.request.batch.size() > MAX_BATCH_SIZE)
+    {
+        pendingBatches.erase(batch_id);
+        respond(sockfd, {}, errorResponse(ErrorType::BAD_FORMAT, encodingOf(sockfd)));
+        return;
+    }
+
+    batch.responses.resize(batch.request.batch.size());
+    advanceBatch(batch_id);
+}
+
+void Shard::advanceBatch(uint64_t batch_id)
+{
+    auto it = pendingBatches.find(batch_id);
+    if (it == pendingBatches.end() || it->second.advancing)
+        return;
+
+    PendingBatch& batch = it->second;
+    auto conn = localConnections.find(batch.fd);
+    bool alive = conn != localConnections.end() && conn->second.id == batch.connId;
+
+    batch.advancing = true;
+    while (alive && !batch.awaiting && batch.next < batch.responses.size())
+    {
+        ReplySlot slot{batch_id, static_cast<uint32_t>(batch.next++)};
+        const Request& item = batch.request.batch[slot.index];
+        batch.awaiting = true;
+
+        // Envelope dentro de envelope: só um nível
+        if (item.type == MessageType::BATCH)
+            respond(batch.fd, slot, errorResponse(ErrorType::BAD_FORMAT, encodingOf(batch.fd)));
+        else
+            dispatchRequest(batch.fd, conn->second, item, slot);
+    }
+    batch.advancing = false;
+
+    // Item aguardando outro shard: continua quando a resposta chegar
+    if (alive && batch.awaiting)
+        return;
+
+    int sockfd = batch.fd;
+    string response = alive ? encodeBatchOk(batch.responses, encodingOf(sockfd)) : string();
+    pendingBatches.erase(batch_id);
+    if (alive)
+        respond(sockfd, {}, response);
+}
+
+void Shard::respond(int sockfd, ReplySlot slot, string_view payload)
+{
+    if (slot.batchId == 0)
+    {
+        send(sockfd, payload);
+        frameAnswered(sockfd);
+        return;
+    }
+
+    auto it = pendingBatches.find(slot.batchId);
+    if (it == pendingBatches.end())
+        return;
+
+    it->second.responses[slot.index] = payload;
+    it->second.awaiting = false;
+    advanceBatch(slot.batchId);
+}
+
+void Shard::forward(int sockfd, const LocalConnection& conn, ReplySlot slot, MessageType type,
+                    string_view nickname, string_view argument, string_view payload)
+{
+    ShardMessage msg;
+    msg.kind = ShardMessage::Kind::REQUEST;
+    msg.type = type;
+    msg.origin = shardId;
+    msg.fd = sockfd;
+    msg.connId = conn.id;
+    msg.batchId = slot.batchId;
+    msg.batchIndex = slot.index;
+    msg.nickname = nickname;
+    msg.argument = argument;
+    msg.payload = payload;
+    msg.encoding = encodingOf(sockfd);
+    post(ownerOf(msg.nickname), std::move(msg));
+}
+
+void Shard::completeResponse(ShardMessage& msg)
+{
+    auto it = localConnections.find(msg.fd);
+    bool alive = it != localConnections.end() && it->second.id == msg.connId;
+    ReplySlot slot{msg.batchId, msg.batchIndex};
+
+    // Item de BATCH de conexão que caiu: a vaga é preenchida para liberar o envelope
+    if (!alive && slot.batchId != 0)
+        respond(msg.fd, slot, msg.payload);
+
+    if (msg.type == MessageType::LOGIN)
+    {
+        if (alive)
+            it->second.loginPending = false;
+
+        if (msg.sessionChanged && !alive)
+        {
+            // Conexão caiu antes da confirmação: desfaz a sessão no dono
+            ShardMessage cleanup;
+            cleanup.kind = ShardMessage::Kind::CLEANUP;
+            cleanup.origin = shardId;
+            cleanup.fd = msg.fd;
+            cleanup.connId = msg.connId;
+            cleanup.nickname = msg.nickname;
+            post(ownerOf(cleanup.nickname), std::move(cleanup));
+            return;
+        }
+
+        if (msg.sessionChanged)
+            it->second.nickname = msg.nickname;
+    }
+    else if (msg.type == MessageType::DELETE_USER && msg.sessionChanged && alive)
+        it->second.nickname.clear();
+
+    if (!alive)
+        return;
+
+    // Mensagens pendentes chegam antes da confirmação do login, no mesmo lote
+    if (!msg.deliveries.empty())
+    {
+        sendBatch(msg.fd, vector<string_view>(msg.deliveries.begin(), msg.deliveries.end()));
+        cout << "[Server] " << msg.deliveries.size() << " mensagem(ns) pendente(s) entregue(s) a "
+             << msg.nickname << endl;
+    }
+    respond(msg.fd, slot, msg.payload);
+}
+
+void Shard::completeListPart(ShardMessage& msg)
+{
+    auto it = pendingLists.find(msg.requestId);
+    if (it == pendingLists.end())
+        return;
+
+    PendingList& list = it->second;
+    for (auto& user : msg.users)
+        list.users.push_back(std::move(user));
+
+    if (--list.remaining > 0)
+        return;
+
+    // Sai do mapa antes de responder: o próximo item do BATCH pode abrir outra coleta
+    PendingList done = std::move(list);
+    pendingLists.erase(it);
+
+    // Vaga de BATCH é preenchida mesmo com a conexão caída (libera o envelope)
+    auto conn = localConnections.find(done.fd);
+    bool alive = conn != localConnections.end() && conn->second.id == done.connId;
+    if (alive || done.slot.batchId != 0)
+        respond(done.fd, done.slot, encodeUsersList(done.users, encodingOf(done.fd)));
+}
+
+// ==================== LADO DO DONO DA PARTIÇÃO ====================
+
+void Shard::reply(const ShardMessage& request, string payload, bool session_changed)
+{
+    ShardMessage msg;
+    msg.kind = ShardMessage::Kind::RESPONSE;
+    msg.type = request.type;
+    msg.origin = shardId;
+    msg.fd = request.fd;
+    msg.connId = request.connId;
+    msg.batchId = request.batchId;
+    msg.batchIndex = request.batchIndex;
+    msg.nickname = request.nickname;
+    msg.payload = std::move(payload);
+    msg.sessionChanged = session_changed;
+    post(request.origin, std::move(msg));
+}
+
+void Shard::ownerRegister(ShardMessage& msg)
+{
+    // Verifica se apelido já existe
+    if (nicknames.find(msg.nickname) != NO_USER)
+    {
+        reply(msg, string(errorResponse(ErrorType::NICK_TAKEN, msg.encoding)));
+        return;
+    }
+
+    UserId id = nicknames.intern(msg.nickname);
+    if (id >= users.size())
+        users.resize(id + 1);
+    users[id] = {std::move(msg.argument), false};
+    cout << "[Server] Usuário registrado: " << msg.nickname << endl;
+    reply(msg, string(okResponse(msg.encoding)));
+}
+
+void Shard::ownerLogin(ShardMessage& msg)
+{
+    UserId id = nicknames.find(msg.nickname);
+    if (id == NO_USER)
+    {
+        reply(msg, string(errorResponse(ErrorType::NO_SUCH_USER, msg.encoding)));
+        return;
+    }
+
+    if (sessions.count(id))
+    {
+        reply(msg, string(errorResponse(ErrorType::ALREADY_ONLINE, msg.encoding)));
+        return;
+    }
+
+    // A conexão do solicitante já tem sessão
+    if (!msg.argument.empty())
+    {
+        reply(msg, string(errorResponse(ErrorType::BAD_STATE, msg.encoding)));
+        return;
+    }
+
+    sessions[id] = SessionRef{msg.origin, msg.fd, msg.connId};
+    users[id].isLogged = true;
+    cout << "[Server] Login: " << msg.nickname << " (FD: " << msg.fd
+         << ", shard " << msg.origin << ")" << endl;
+
+    ShardMessage response;
+    response.kind = ShardMessage::Kind::RESPONSE;
+    response.type = MessageType::LOGIN;
+    response.origin = shardId;
+    response.fd = msg.fd;
+    response.connId = msg.connId;
+    response.batchId = msg.batchId;
+    response.batchIndex = msg.batchIndex;
+    response.nickname = msg.nickname;
+    response.payload = encodeLoginOk(msg.nickname, msg.encoding);
+    response.sessionChanged = true;
+
+    auto queue = messageQueues.find(id);
+    if (queue != messageQueues.end())
+    {
+        while (!queue->second.empty())
+        {
+            response.deliveries.push_back(std::move(queue->second.front()));
+            queue->second.pop();
+        }
+    }
+
+    post(msg.origin, std::move(response));
+}
+
+void Shard::ownerLogout(ShardMessage& msg)
+{
+    UserId id = nicknames.find(msg.nickname);
+    auto session = sessions.find(id);
+    if (session == sessions.end() || session->second.connId != msg.connId ||
+        session->second.shard != msg.origin)
+        return;
+
+    sessions.erase(session);
+    users[id].isLogged = false;
+
+    cout << "[Server] Sessão limpa para: " << msg.nickname << endl;
+}
+
+void Shard::ownerSendMessage(ShardMessage& msg)
+{
+    const string& to_name = msg.nickname;
+    const string& from = msg.argument;
+
+    // Verifica se destinatário existe
+    UserId to = nicknames.find(to_name);
+    if (to == NO_USER)
+    {
+        reply(msg, string(errorResponse(ErrorType::NO_SUCH_USER, msg.encoding)));
+        return;
+    }
+
+    time_t now = time(nullptr);
+
+    auto session = sessions.find(to);
+    if (session != sessions.end())
+    {
+        // Online: o shard que hospeda a conexão do destinatário monta a
+        // DELIVER_MSG na codificação dela
+        ShardMessage deliver;
+        deliver.kind = ShardMessage::Kind::DELIVER;
+        deliver.origin = shardId;
+        deliver.fd = session->second.fd;
+        deliver.connId = session->second.connId;
+        deliver.argument = from;
+        deliver.payload = std::move(msg.payload);
+        deliver.timestamp = now;
+        post(session->second.shard, std::move(deliver));
+        cout << "[Server] Mensagem entregue: " << from << " -> " << to_name << endl;
+    }
+    else
+    {
+        // Offline: armazena na fila da partição
+        messageQueues[to].push(encodeDeliverMessage(from, msg.payload, now));
+        cout << "[Server] Mensagem armazenada: " << from << " -> " << to_name
+             << " (offline)" << endl;
+    }
+
+    reply(msg, string(okResponse(msg.encoding)));
+}
+
+void Shard::ownerDeleteUser(ShardMessage& msg)
+{
+    UserId id = nicknames.find(msg.nickname);
+    if (id == NO_USER)
+    {
+        reply(msg, string(errorResponse(ErrorType::NO_SUCH_USER, msg.encoding)));
+        return;
+    }
+
+    // Verifica se é o próprio usuário
+    if (msg.argument != msg.nickname)
+    {
+        reply(msg, string(errorResponse(ErrorType::UNAUTHORIZED, msg.encoding)));
+        return;
+    }
+
+    if (!users[id].isLogged)
+    {
+        reply(msg, string(errorResponse(ErrorType::BAD_STATE, msg.encoding)));
+        return;
+    }
+
+    // Encerra a sessão e remove usuário e dados associados
+    sessions.erase(id);
+    messageQueues.erase(id);
+    users[id] = {};
+    nicknames.release(id);
+
+    cout << "[Server] Usuário deletado: " << msg.nickname << endl;
+    reply(msg, string(okResponse(msg.encoding)), true);
+}
+
+void Shard::ownerListUsers(ShardMessage& msg)
+{
+    ShardMessage part;
+    part.kind = ShardMessage::Kind::LIST_PART;
+    part.origin = shardId;
+    part.requestId = msg.requestId;
+    part.users.reserve(nicknames.size());
+    for (UserId id = 0; id < nicknames.idLimit(); ++id)
+        if (nicknames.contains(id))
+            part.users.push_back({string(nicknames.name(id)), users[id].fullName, users[id].isLogged});
+
+    post(msg.origin, std::move(part));
+}
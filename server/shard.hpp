@@ -0,0 +1,256 @@
+#pragma once
+
+#include "protocol.hpp"
+#include "reactor.hpp"
+#include "request_parser.hpp"
+#include "server.hpp"
+#include "spsc_queue.hpp"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Estrutura ShardMessage
+ * ----------------------
+ * Mensagem trocada entre núcleos no modo shared-nothing. Carrega uma
+ * requisição para o shard dono de um usuário ou o resultado de volta ao
+ * shard que hospeda a conexão do solicitante.
+ */
+struct ShardMessage
+{
+    enum class Kind : uint8_t
+    {
+        REQUEST,        // Origem -> dono: comando sobre um usuário da partição
+        RESPONSE,       // Dono -> origem: resposta pronta, na codificação da conexão
+        DELIVER,        // Dono -> shard da sessão: campos da DELIVER_MSG para o destinatário
+        CLEANUP,        // Origem -> dono: conexão com sessão foi encerrada
+        LIST_REQUEST,   // Origem -> todos: coleta da partição para LIST_USERS
+        LIST_PART       // Todos -> origem: usuários de uma partição
+    };
+
+    Kind kind = Kind::REQUEST;
+    Protocol::MessageType type = Protocol::MessageType::UNKNOWN;
+    int origin = 0;                 // Shard que hospeda a conexão do solicitante
+    int fd = -1;                    // Conexão do solicitante (ou destinatário no DELIVER)
+    uint64_t connId = 0;            // Identifica a conexão (fds são reutilizados)
+    uint64_t requestId = 0;         // Correlação do scatter-gather de LIST_USERS
+    uint64_t batchId = 0;           // REQUEST/RESPONSE de um item de BATCH (0 = frame próprio)
+    uint32_t batchIndex = 0;        // Posição do item no BATCH
+    std::string nickname;           // Usuário da partição do dono
+    std::string argument;           // Nome completo / remetente / solicitante
+    std::string payload;            // Texto da mensagem ou resposta pronta
+    int64_t timestamp = 0;          // DELIVER: instante do envio
+    SocketUtils::Encoding encoding = SocketUtils::Encoding::JSON;  // REQUEST: codificação do solicitante
+    bool sessionChanged = false;    // RESPONSE: sessão aberta (LOGIN) ou encerrada (DELETE_USER)
+    std::vector<std::string> deliveries;        // LOGIN: mensagens pendentes
+    std::vector<Protocol::UserInfo> users;      // LIST_PART
+};
+
+/**
+ * Classe Shard
+ * ------------
+ * Reactor do modo shared-nothing (thread-per-core). Cada shard roda em seu
+ * próprio núcleo, com listener SO_REUSEPORT próprio, e é o único dono de uma
+ * partição dos usuários (hash(apelido) % N): UserData, sessão e fila offline.
+ * Nada é compartilhado: o shard que recebe um comando sobre um usuário de
+ * outra partição encaminha a requisição por uma fila SPSC lock-free (uma por
+ * par origem/destino) e acorda o destino pelo eventfd do reactor.
+ *
+ * O estado de login da conexão (apelido autenticado) fica no shard que
+ * hospeda o socket; o dono guarda (shard, fd, connId) da sessão.
+ *
+ * Cada conexão tem no máximo uma requisição em andamento em outro shard:
+ * enquanto a resposta não é escrita, a leitura fica suspensa e os frames
+ * seguintes esperam no buffer de leitura. Assim as respostas saem na ordem
+ * dos comandos e um LOGIN em pipeline vale para os comandos depois dele,
+ * como nos outros modos.
+ *
+ * Um BATCH segue a mesma regra item a item: cada item segue o caminho de um
+ * frame próprio (local ou encaminhado ao dono), o próximo só é despachado
+ * depois da resposta do anterior, e o BATCH_OK sai quando todas chegam.
+ */
+class Shard : public Reactor
+{
+public:
+    /**
+     * @param server Servidor (apenas para registro das conexões)
+     * @param listen_fd Socket de escuta próprio do shard
+     * @param id Índice do shard (0..count-1)
+     * @param count Número total de shards
+     */
+    Shard(Server& server, int listen_fd, int id, int count);
+
+    /**
+     * Cria as filas SPSC entre todos os pares de shards.
+     * Deve ser chamado antes de qualquer shard iniciar o loop.
+     */
+    static void connect(const std::vector<Shard*>& shards);
+
+    const char* name() const override { return "shared-nothing (epoll thread-per-core)"; }
+
+    // O estado dos usuários é particionado entre os shards: sem handoff
+    bool supportsHandoff() const override { return false; }
+
+protected:
+    void dispatchFrame(int sockfd, std::string_view message) override;
+    void onConnectionOpened(int sockfd) override;
+    void onConnectionClosed(int sockfd) override;
+    void onWake() override;
+    void afterEvents() override;
+    bool isAuthenticated(int sockfd) override;
+
+private:
+    /**
+     * Sessão de uma conexão hospedada neste shard
+     */
+    struct LocalConnection
+    {
+        uint64_t id;
+        std::string nickname;       // Vazio enquanto não autenticada
+        bool loginPending = false;  // LOGIN encaminhado aguardando o dono
+        bool awaitingReply = false; // Frame sem resposta ainda (leitura suspensa)
+    };
+
+    /**
+     * Referência à sessão de um usuário da partição
+     */
+    struct SessionRef
+    {
+        int shard;
+        int fd;
+        uint64_t connId;
+    };
+
+    /**
+     * Destino de uma resposta: a conexão (batchId 0) ou a vaga de um item
+     * de BATCH
+     */
+    struct ReplySlot
+    {
+        uint64_t batchId = 0;
+        uint32_t index = 0;
+    };
+
+    /**
+     * LIST_USERS em andamento (aguardando as partições)
+     */
+    struct PendingList
+    {
+        int fd;
+        uint64_t connId;
+        int remaining;
+        std::vector<Protocol::UserInfo> users;
+        ReplySlot slot;
+    };
+
+    /**
+     * BATCH em andamento: os itens são despachados um por vez. A requisição
+     * aponta para a cópia do frame (o buffer de leitura anda enquanto isso).
+     */
+    struct PendingBatch
+    {
+        int fd;
+        uint64_t connId;
+        std::string frame;
+        Protocol::Request request;
+        std::vector<std::string> responses;
+        size_t next = 0;            // Próximo item a despachar
+        bool awaiting = false;      // Item despachado sem resposta
+        bool advancing = false;     // Em advanceBatch (respostas síncronas não reentram)
+    };
+
+    int shardId;
+    int shardCount;
+    std::vector<Shard*> peers;
+
+    // Filas de entrada, indexadas pelo shard de origem (consumidas só por este shard)
+    std::vector<std::unique_ptr<SpscQueue<ShardMessage>>> inbox;
+    // Mensagens que não couberam na fila do destino (reenviadas no próximo lote)
+    std::vector<std::deque<ShardMessage>> overflow;
+    std::vector<bool> wakePending;
+
+    // Partição de usuários (acessada apenas pela thread deste shard), indexada
+    // pelo id interno; as mensagens entre shards levam o apelido, já que cada
+    // partição numera os seus usuários
+    NicknameTable nicknames;
+    std::vector<UserData> users;
+    std::unordered_map<UserId, SessionRef> sessions;
+    std::unordered_map<UserId, MessageQueue> messageQueues;
+
+    // Conexões hospedadas neste shard
+    std::unordered_map<int, LocalConnection> localConnections;
+    std::unordered_map<uint64_t, PendingList> pendingLists;
+    std::unordered_map<uint64_t, PendingBatch> pendingBatches;
+    uint64_t nextConnId;
+    uint64_t nextRequestId;
+
+    /**
+     * Shard dono da partição do apelido.
+     */
+    int ownerOf(std::string_view nickname) const;
+
+    /**
+     * Entrega a mensagem ao shard destino (processada localmente se for este).
+     */
+    void post(int target, ShardMessage&& msg);
+
+    /**
+     * Esvazia as filas de entrada e as mensagens retidas por fila cheia.
+     */
+    void drainInbox();
+    void flushOverflow();
+
+    void handleMessage(ShardMessage& msg);
+
+    // ==================== Lado do dono da partição ====================
+    void ownerRegister(ShardMessage& msg);
+    void ownerLogin(ShardMessage& msg);
+    void ownerLogout(ShardMessage& msg);
+    void ownerSendMessage(ShardMessage& msg);
+    void ownerDeleteUser(ShardMessage& msg);
+    void ownerListUsers(ShardMessage& msg);
+
+    /**
+     * Devolve a resposta ao shard de origem da requisição.
+     */
+    void reply(const ShardMessage& request, std::string payload, bool session_changed = false);
+
+    // ==================== Lado da conexão ====================
+    void completeResponse(ShardMessage& msg);
+    void completeListPart(ShardMessage& msg);
+
+    /**
+     * Executa uma requisição (frame próprio ou item de BATCH); a resposta
+     * vai para 'slot'.
+     */
+    void dispatchRequest(int sockfd, LocalConnection& conn, const Protocol::Request& request, ReplySlot slot);
+    void dispatchBatch(int sockfd, LocalConnection& conn, std::string_view frame);
+
+    /**
+     * Despacha os itens do BATCH até um ficar aguardando outro shard; com
+     * todas as vagas preenchidas, envia o BATCH_OK.
+     */
+    void advanceBatch(uint64_t batch_id);
+
+    /**
+     * Envia a resposta à conexão ou a guarda na vaga do BATCH (e segue para
+     * o próximo item).
+     */
+    void respond(int sockfd, ReplySlot slot, std::string_view payload);
+
+    /**
+     * Resposta do frame atual escrita: retoma a leitura dos próximos.
+     */
+    void frameAnswered(int sockfd);
+
+    /**
+     * Encaminha a requisição ao dono do apelido.
+     */
+    void forward(int sockfd, const LocalConnection& conn, ReplySlot slot, Protocol::MessageType type,
+                 std::string_view nickname, std::string_view argument = {},
+                 std::string_view payload = {});
+};
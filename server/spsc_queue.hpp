@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * Classe SpscQueue
+ * ----------------
+ * Fila circular lock-free de um produtor e um consumidor (single-producer,
+ * single-consumer). Usada para a troca de mensagens entre núcleos no modo
+ * shared-nothing: cada par (origem, destino) tem sua própria fila, então
+ * nenhuma operação precisa de mutex.
+ *
+ * A capacidade é arredondada para potência de 2. push() falha quando a fila
+ * está cheia; o produtor é responsável por reter e reenviar o item.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity)
+    {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * Insere um item (apenas a thread produtora).
+     * @return false se a fila estiver cheia
+     */
+    bool push(T&& item)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead > mask)
+        {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead > mask)
+                return false;
+        }
+
+        slots[t & mask] = std::move(item);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Remove o item mais antigo (apenas a thread consumidora).
+     * @return false se a fila estiver vazia
+     */
+    bool pop(T& out)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail)
+                return false;
+        }
+
+        out = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> slots;
+    size_t mask;
+
+    // Índices em linhas de cache separadas para evitar false sharing
+    alignas(64) std::atomic<size_t> head{0};   // Escrito pelo consumidor
+    alignas(64) size_t cachedTail = 0;         // Cópia local do consumidor
+    alignas(64) std::atomic<size_t> tail{0};   // Escrito pelo produtor
+    alignas(64) size_t cachedHead = 0;         // Cópia local do produtor
+};
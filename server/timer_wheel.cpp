@@ -0,0 +1,204 @@
+#include "timer_wheel.hpp"
+#include <chrono>
+
+using namespace std;
+
+namespace
+{
+    uint64_t monotonicMs()
+    {
+        return chrono::duration_cast<chrono::milliseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void unlinkNode(TimerNode& node)
+    {
+        node.prev->next = node.next;
+        node.next->prev = node.prev;
+        node.prev = node.next = nullptr;
+    }
+}
+
+TimerNode::~TimerNode()
+{
+    if (wheel)
+        wheel->cancel(*this);
+}
+
+// ==================== CONSTRUTOR/DESTRUTOR ====================
+
+TimerWheel::TimerWheel(uint64_t tick_ms)
+    : tickMs(tick_ms ? tick_ms : 1), startMs(monotonicMs()), current(0), count(0)
+{
+    for (auto& level : slots)
+        for (auto& head : level)
+            head.prev = head.next = &head;
+}
+
+TimerWheel::~TimerWheel()
+{
+    // Desarma os nós restantes para que seus destrutores não toquem na roda
+    for (auto& level : slots)
+        for (auto& head : level)
+            while (head.next != &head)
+            {
+                TimerNode& node = *head.next;
+                unlinkNode(node);
+                node.wheel = nullptr;
+            }
+}
+
+// ==================== ARMAR/CANCELAR ====================
+
+uint64_t TimerWheel::nowTick() const
+{
+    return (monotonicMs() - startMs) / tickMs;
+}
+
+void TimerWheel::schedule(TimerNode& node, uint64_t delay_ms)
+{
+    cancel(node);
+
+    // Arredonda para cima e soma o tick corrente (parcial): nunca dispara antes do prazo
+    uint64_t ticks = (delay_ms + tickMs - 1) / tickMs;
+    uint64_t base = nowTick();
+    if (base < current) base = current;
+
+    node.expires = base + ticks + 1;
+    node.wheel = this;
+    ++count;
+    insert(node);
+}
+
+void TimerWheel::cancel(TimerNode& node)
+{
+    if (node.wheel != this)
+        return;
+
+    unlinkNode(node);
+    node.wheel = nullptr;
+    --count;
+}
+
+void TimerWheel::link(TimerNode& head, TimerNode& node)
+{
+    node.prev = head.prev;
+    node.next = &head;
+    head.prev->next = &node;
+    head.prev = &node;
+}
+
+void TimerWheel::insert(TimerNode& node)
+{
+    uint64_t expires = node.expires < current ? current : node.expires;
+    uint64_t delta = expires - current;
+
+    // Nível: o primeiro cujo alcance cobre a distância até a expiração
+    unsigned level = 0;
+    while (level < LEVELS - 1 && delta >= (1ULL << (SLOT_BITS * (level + 1))))
+        ++level;
+
+    // Além do alcance total: estaciona no fim do último nível e reavalia na cascata
+    uint64_t max_delta = (1ULL << (SLOT_BITS * LEVELS)) - 1;
+    if (delta > max_delta)
+        expires = current + max_delta;
+
+    unsigned slot = static_cast<unsigned>((expires >> (SLOT_BITS * level)) & (SLOTS - 1));
+    link(slots[level][slot], node);
+}
+
+void TimerWheel::splice(TimerNode& from, TimerNode& to)
+{
+    if (from.next == &from)
+        return;
+
+    to.next = from.next;
+    to.prev = from.prev;
+    to.next->prev = &to;
+    to.prev->next = &to;
+    from.prev = from.next = &from;
+}
+
+// ==================== AVANÇO ====================
+
+void TimerWheel::advance(const function<void(TimerNode&)>& on_expire)
+{
+    uint64_t target = nowTick();
+
+    // Sem timers não há o que cascatear: salta direto para o tick atual
+    if (count == 0)
+    {
+        if (current <= target)
+            current = target + 1;
+        return;
+    }
+
+    TimerNode pending;
+    pending.prev = pending.next = &pending;
+
+    while (current <= target && count > 0)
+    {
+        // Cascata: ao completar uma volta do nível inferior, redistribui a
+        // posição correspondente do nível superior
+        for (unsigned level = 1; level < LEVELS; ++level)
+        {
+            uint64_t mask = (1ULL << (SLOT_BITS * level)) - 1;
+            if ((current & mask) != 0)
+                break;
+
+            unsigned slot = static_cast<unsigned>((current >> (SLOT_BITS * level)) & (SLOTS - 1));
+            splice(slots[level][slot], pending);
+            while (pending.next != &pending)
+            {
+                TimerNode& node = *pending.next;
+                unlinkNode(node);
+                insert(node);
+            }
+        }
+
+        // Expira a posição do nível 0
+        splice(slots[0][current & (SLOTS - 1)], pending);
+        while (pending.next != &pending)
+        {
+            TimerNode& node = *pending.next;
+            unlinkNode(node);
+
+            if (node.expires > current)
+            {
+                insert(node);
+                continue;
+            }
+
+            node.wheel = nullptr;
+            --count;
+            on_expire(node);
+        }
+
+        ++current;
+    }
+
+    if (count == 0 && current <= target)
+        current = target + 1;
+}
+
+int TimerWheel::nextTimeoutMs() const
+{
+    if (count == 0)
+        return -1;
+
+    // Próxima posição ocupada do nível 0; sem nenhuma, acorda na próxima cascata
+    uint64_t ticks = SLOTS - (current & (SLOTS - 1));
+    for (uint64_t i = 0; i < SLOTS; ++i)
+    {
+        const TimerNode& head = slots[0][(current + i) & (SLOTS - 1)];
+        if (head.next != &head)
+        {
+            ticks = i;
+            break;
+        }
+    }
+
+    uint64_t due = (current + ticks) * tickMs;
+    uint64_t elapsed = monotonicMs() - startMs;
+    return due <= elapsed ? 0 : static_cast<int>(due - elapsed);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+class TimerWheel;
+
+/**
+ * Estrutura TimerNode
+ * -------------------
+ * Nó intrusivo de timer: fica embutido no objeto dono (ex: a conexão), então
+ * armar, rearmar e cancelar não alocam memória. Ao ser destruído o nó se
+ * remove da roda automaticamente.
+ */
+struct TimerNode
+{
+    TimerNode* prev = nullptr;
+    TimerNode* next = nullptr;
+    TimerWheel* wheel = nullptr;    // Roda em que está armado (nullptr = desarmado)
+    uint64_t expires = 0;           // Tick de expiração
+    int data = -1;                  // Identificador livre do dono (ex: fd)
+    int kind = 0;                   // Tipo de timer definido pelo dono
+
+    TimerNode() = default;
+    TimerNode(int data, int kind) : data(data), kind(kind) {}
+    TimerNode(const TimerNode&) = delete;
+    TimerNode& operator=(const TimerNode&) = delete;
+    ~TimerNode();
+
+    bool armed() const { return wheel != nullptr; }
+};
+
+/**
+ * Classe TimerWheel
+ * -----------------
+ * Roda de timers hierárquica (4 níveis de 64 posições) dirigida pelo loop de
+ * eventos. Armar e cancelar são O(1); avançar custa O(1) amortizado por tick
+ * mais os timers expirados. Timers de níveis superiores descem de nível
+ * (cascata) quando a posição do nível inferior completa uma volta.
+ *
+ * Com tick de 100 ms o alcance é de 64^4 ticks (~19 dias); prazos maiores
+ * são reavaliados a cada volta do último nível. Não é thread-safe: pertence
+ * a um único loop.
+ */
+class TimerWheel
+{
+public:
+    static constexpr unsigned LEVELS = 4;
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr unsigned SLOTS = 1u << SLOT_BITS;
+
+    /**
+     * @param tick_ms Resolução da roda em milissegundos
+     */
+    explicit TimerWheel(uint64_t tick_ms = 100);
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * Arma (ou rearma) o timer para expirar em delay_ms a partir de agora.
+     */
+    void schedule(TimerNode& node, uint64_t delay_ms);
+
+    /**
+     * Desarma o timer (sem efeito se não estiver armado).
+     */
+    void cancel(TimerNode& node);
+
+    /**
+     * Processa todos os ticks até o instante atual, chamando on_expire para
+     * cada timer vencido. O callback pode armar/cancelar quaisquer timers.
+     */
+    void advance(const std::function<void(TimerNode&)>& on_expire);
+
+    /**
+     * Milissegundos até o próximo tick com trabalho (-1 se não há timers),
+     * adequado para o timeout do epoll_wait.
+     */
+    int nextTimeoutMs() const;
+
+    size_t size() const { return count; }
+
+private:
+    uint64_t tickMs;
+    uint64_t startMs;
+    uint64_t current;   // Próximo tick a processar
+    size_t count;
+    TimerNode slots[LEVELS][SLOTS];    // Sentinelas das listas circulares
+
+    uint64_t nowTick() const;
+    void insert(TimerNode& node);
+    void link(TimerNode& head, TimerNode& node);
+
+    /**
+     * Move todos os nós da lista 'from' para 'to' (vazia).
+     */
+    static void splice(TimerNode& from, TimerNode& to);
+};
@@ -0,0 +1,693 @@
+#include "uring_backend.hpp"
+#include "server.hpp"
+#include "socket_utils.hpp"
+#include "worker_pool.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace
+{
+    constexpr unsigned RING_ENTRIES = 1024;
+    constexpr unsigned BUF_COUNT = 512;       // Potência de 2 (exigência do anel de buffers)
+    constexpr size_t BUF_SIZE = 4096;
+    constexpr uint16_t BUF_GROUP = 0;
+    constexpr uint64_t ID_MASK = (1ULL << 56) - 1;
+}
+
+// ==================== CONSTRUTOR/DESTRUTOR ====================
+
+UringBackend::UringBackend(Server& server, int listen_fd)
+    : server(server), handler(server), listenFd(listen_fd), wakeFd(-1), wakeValue(0),
+      running(false), pool(nullptr), bufRing(nullptr), bufRingSize(0), bufPool(nullptr), bufPoolSize(0),
+      nextConnId(1) {}
+
+UringBackend::~UringBackend()
+{
+    for (auto& [id, conn] : connections)
+        if (conn->fd >= 0)
+            SocketUtils::closeSocket(conn->fd);
+    connections.clear();
+
+    if (wakeFd >= 0) close(wakeFd);
+    if (bufPool) munmap(bufPool, bufPoolSize);
+    if (bufRing) munmap(bufRing, bufRingSize);
+}
+
+// ==================== INICIALIZAÇÃO ====================
+
+bool UringBackend::init()
+{
+    if (!ring.init(RING_ENTRIES))
+        return false;
+
+    wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (wakeFd < 0)
+    {
+        perror("[Uring] Erro ao criar eventfd");
+        return false;
+    }
+
+    // Anel de buffers fornecidos: o kernel escolhe um buffer livre a cada recv
+    bufRingSize = BUF_COUNT * sizeof(io_uring_buf);
+    void* ring_mem = mmap(nullptr, bufRingSize, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    bufPoolSize = BUF_COUNT * BUF_SIZE;
+    void* pool_mem = mmap(nullptr, bufPoolSize, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring_mem == MAP_FAILED || pool_mem == MAP_FAILED)
+    {
+        perror("[Uring] Erro ao alocar buffers");
+        if (ring_mem != MAP_FAILED) munmap(ring_mem, bufRingSize);
+        if (pool_mem != MAP_FAILED) munmap(pool_mem, bufPoolSize);
+        return false;
+    }
+    bufRing = static_cast<io_uring_buf_ring*>(ring_mem);
+    bufPool = static_cast<char*>(pool_mem);
+
+    if (!ring.registerBufferRing(bufRing, BUF_COUNT, BUF_GROUP))
+        return false;
+
+    for (unsigned i = 0; i < BUF_COUNT; ++i)
+        recycleBuffer(static_cast<uint16_t>(i));
+
+    armWake();
+    armAccept();
+    return true;
+}
+
+// ==================== LOOP DE EVENTOS ====================
+
+void UringBackend::run()
+{
+    running = true;
+    loopThread = this_thread::get_id();
+
+    while (running)
+    {
+        // Submete o lote acumulado e aguarda ao menos uma conclusão (ou o próximo prazo)
+        int ret = ring.submit(1, timers.nextTimeoutMs());
+        if (ret < 0 && ret != -EBUSY && ret != -EAGAIN && ret != -ETIME)
+        {
+            cerr << "[Uring] Erro em io_uring_enter: " << strerror(-ret) << endl;
+            break;
+        }
+
+        io_uring_cqe* cqe;
+        while ((cqe = ring.peekCqe()) != nullptr)
+        {
+            uint64_t data = cqe->user_data;
+            int res = cqe->res;
+            uint32_t flags = cqe->flags;
+            ring.cqeSeen();
+
+            Op op = static_cast<Op>(data >> 56);
+            uint64_t id = data & ID_MASK;
+
+            if (op == Op::WAKE)
+            {
+                if (!running) continue;
+                armWake();
+                drainMailbox();
+                continue;
+            }
+
+            if (op == Op::ACCEPT)
+            {
+                handleAccept(res, flags);
+                continue;
+            }
+
+            // O efeito do cancelamento chega na conclusão do próprio recv
+            if (op == Op::CANCEL)
+                continue;
+
+            auto it = connections.find(id);
+            if (it == connections.end())
+            {
+                // Conclusão tardia de uma conexão já liberada
+                if (flags & IORING_CQE_F_BUFFER)
+                    recycleBuffer(static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT));
+                continue;
+            }
+            Connection& conn = *it->second;
+
+            if (op == Op::RECV)
+                handleRecv(conn, res, flags);
+            else if (op == Op::SEND)
+                handleSend(conn, res);
+        }
+
+        timers.advance([this](TimerNode& timer) { onTimer(timer); });
+    }
+}
+
+void UringBackend::stop()
+{
+    running = false;
+    wake();
+}
+
+void UringBackend::wake()
+{
+    if (wakeFd >= 0)
+    {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+// ==================== PREPARAÇÃO DE SQEs ====================
+
+io_uring_sqe* UringBackend::acquireSqe()
+{
+    io_uring_sqe* sqe = ring.getSqe();
+    while (!sqe)
+    {
+        ring.submit(0);
+        sqe = ring.getSqe();
+    }
+    return sqe;
+}
+
+void UringBackend::armAccept()
+{
+    io_uring_sqe* sqe = acquireSqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listenFd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = encode(Op::ACCEPT, 0);
+}
+
+void UringBackend::armRecv(Connection& conn)
+{
+    io_uring_sqe* sqe = acquireSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = conn.fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUF_GROUP;
+    sqe->user_data = encode(Op::RECV, conn.id);
+    conn.recvArmed = true;
+}
+
+void UringBackend::cancelRecv(Connection& conn)
+{
+    io_uring_sqe* sqe = acquireSqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = encode(Op::RECV, conn.id);
+    sqe->user_data = encode(Op::CANCEL, conn.id);
+}
+
+void UringBackend::armWake()
+{
+    io_uring_sqe* sqe = acquireSqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wakeFd;
+    sqe->addr = reinterpret_cast<uint64_t>(&wakeValue);
+    sqe->len = sizeof(wakeValue);
+    sqe->user_data = encode(Op::WAKE, 0);
+}
+
+void UringBackend::submitSend(Connection& conn)
+{
+    if (conn.outbound.empty())
+    {
+        conn.sending = false;
+        conn.inflightFrames = 0;
+        return;
+    }
+
+    // Os frames apontados ficam intactos na fila até a conclusão do SENDMSG
+    conn.inflightFrames = conn.outbound.gather(conn.sendIov, SEND_IOVECS);
+    conn.sendMsg = msghdr{};
+    conn.sendMsg.msg_iov = conn.sendIov;
+    conn.sendMsg.msg_iovlen = conn.inflightFrames;
+
+    io_uring_sqe* sqe = acquireSqe();
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = conn.fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&conn.sendMsg);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = encode(Op::SEND, conn.id);
+    conn.sending = true;
+}
+
+void UringBackend::recycleBuffer(uint16_t bid)
+{
+    // Indexa as entradas manualmente: em C++ o membro flexível 'bufs' do
+    // cabeçalho do kernel fica deslocado (a struct vazia auxiliar ocupa 1 byte)
+    uint16_t tail = bufRing->tail;
+    io_uring_buf* buf = reinterpret_cast<io_uring_buf*>(bufRing) + (tail & (BUF_COUNT - 1));
+    buf->addr = reinterpret_cast<uint64_t>(bufPool + bid * BUF_SIZE);
+    buf->len = BUF_SIZE;
+    buf->bid = bid;
+    __atomic_store_n(&bufRing->tail, static_cast<uint16_t>(tail + 1), __ATOMIC_RELEASE);
+}
+
+// ==================== CONCLUSÕES ====================
+
+void UringBackend::handleAccept(int res, uint32_t flags)
+{
+    if (!(flags & IORING_CQE_F_MORE) && running)
+        armAccept();
+
+    if (res < 0)
+    {
+        if (running)
+            cerr << "[Uring] Erro em accept: " << strerror(-res) << endl;
+        return;
+    }
+
+    int client_sockfd = res;
+
+    // Obtém IP do cliente
+    sockaddr_in client_addr;
+    socklen_t client_len = sizeof(client_addr);
+    char client_ip[INET_ADDRSTRLEN] = "?";
+    if (getpeername(client_sockfd, (sockaddr*)&client_addr, &client_len) == 0)
+        inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
+
+    auto conn = make_unique<Connection>();
+    conn->id = nextConnId++;
+    conn->fd = client_sockfd;
+    conn->ip = client_ip;
+    conn->idleTimer.data = conn->loginTimer.data = conn->writeTimer.data = client_sockfd;
+    conn->idleTimer.kind = IDLE_TIMER;
+    conn->loginTimer.kind = LOGIN_TIMER;
+    conn->writeTimer.kind = WRITE_STALL_TIMER;
+    armTimer(conn->idleTimer, server.getTimeouts().idleSeconds);
+    armTimer(conn->loginTimer, server.getTimeouts().loginSeconds);
+
+    Connection& ref = *conn;
+    fdToConnId[client_sockfd] = conn->id;
+    connections[conn->id] = std::move(conn);
+    server.registerConnection(client_sockfd, this, ref.id);
+    server.prepareClientSocket(client_sockfd);
+    armRecv(ref);
+
+    cout << "[Server] Nova conexão aceita (FD: " << client_sockfd
+         << ") de: " << client_ip << endl;
+}
+
+void UringBackend::handleRecv(Connection& conn, int res, uint32_t flags)
+{
+    if (!(flags & IORING_CQE_F_MORE))
+        conn.recvArmed = false;
+
+    bool stored = true;
+    if (flags & IORING_CQE_F_BUFFER)
+    {
+        uint16_t bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+        if (res > 0 && !conn.closing)
+            stored = conn.reader.append(bufPool + bid * BUF_SIZE, res);
+        recycleBuffer(bid);
+    }
+
+    if (conn.closing)
+    {
+        releaseIfIdle(conn);
+        return;
+    }
+
+    // Cancelado pela suspensão da leitura; se já retomada, volta a receber
+    if (res == -ECANCELED)
+    {
+        if (!conn.readPaused)
+            armRecv(conn);
+        return;
+    }
+
+    if (res == 0)
+    {
+        closeConnection(conn, "Conexão fechada pelo cliente");
+        return;
+    }
+
+    if (!stored)
+    {
+        closeConnection(conn, "Erro ao alocar buffer de leitura");
+        return;
+    }
+
+    if (res < 0 && res != -ENOBUFS)
+    {
+        closeConnection(conn, string("Erro de rede: ") + strerror(-res));
+        return;
+    }
+
+    if (res > 0)
+        armTimer(conn.idleTimer, server.getTimeouts().idleSeconds);
+
+    if (!processFrames(conn))
+        return;
+
+    // Multishot encerrado (ex: ENOBUFS): rearma
+    if (!conn.recvArmed && !conn.readPaused)
+        armRecv(conn);
+}
+
+bool UringBackend::processFrames(Connection& conn)
+{
+    while (!conn.readPaused)
+    {
+        auto frame = conn.reader.next();
+        if (!frame)
+            break;
+
+        if (!conn.greeted)
+        {
+            conn.greeted = true;
+
+            // HELLO_OK sai em linha; os frames seguintes, no framing e codificação negociados
+            string response;
+            SocketUtils::Framing framing;
+            SocketUtils::Encoding encoding;
+            SocketUtils::Compression compression;
+            if (handler.negotiateFraming(*frame, conn.fd, response, framing, encoding, compression))
+            {
+                send(conn.fd, conn.id, response);
+                conn.outbound.setFraming(framing);
+                conn.outbound.setEncoding(encoding);
+                conn.outbound.setCompression(compression);
+                conn.reader.setFraming(framing);
+                server.setClientEncoding(conn.fd, encoding);
+                conn.reader.setCompression(compression);
+                continue;
+            }
+        }
+
+        if (pool)
+        {
+            conn.pendingFrames.emplace_back(*frame);
+
+            // Cliente mais rápido que o pool: o resto espera no buffer e no socket
+            if (conn.pendingFrames.size() >= MAX_QUEUED_FRAMES)
+            {
+                conn.readPaused = true;
+                if (conn.recvArmed)
+                    cancelRecv(conn);
+            }
+            continue;
+        }
+
+        string response = handler.processCommand(*frame, conn.fd, conn.outbound.getEncoding());
+        if (!response.empty())
+            send(conn.fd, conn.id, response);
+
+        if (conn.closing)
+            return false;
+    }
+
+    // Sem o frame os contextos deflate divergem; o próximo recv pode nunca vir
+    if (conn.reader.hasFailed())
+    {
+        closeConnection(conn, "Frame comprimido inválido");
+        return false;
+    }
+
+    if (pool)
+        scheduleFrames(conn);
+    return true;
+}
+
+void UringBackend::handleSend(Connection& conn, int res)
+{
+    if (conn.closing)
+    {
+        conn.sending = false;
+        releaseIfIdle(conn);
+        return;
+    }
+
+    if (res < 0)
+    {
+        conn.sending = false;
+        closeConnection(conn, string("Erro ao enviar: ") + strerror(-res));
+        return;
+    }
+
+    OutboundQueue::FlushResult result;
+    result.syscalls = 1;
+    conn.outbound.consume(static_cast<size_t>(res), result);
+    server.writevCalls.fetch_add(result.syscalls, memory_order_relaxed);
+    server.framesFlushed.fetch_add(result.frames, memory_order_relaxed);
+
+    // Prazo de escrita travada: conta a partir do último progresso
+    if (conn.outbound.empty())
+        timers.cancel(conn.writeTimer);
+    else if (res > 0 || !conn.writeTimer.armed())
+        armTimer(conn.writeTimer, server.getTimeouts().writeStallSeconds);
+
+    submitSend(conn);
+    updateCongestion(conn);
+}
+
+void UringBackend::updateCongestion(Connection& conn)
+{
+    if (conn.outbound.congested() == conn.congested)
+        return;
+
+    conn.congested = conn.outbound.congested();
+    server.setCongested(conn.fd, conn.congested);
+
+    // Saída drenou: entrega as mensagens desviadas para a fila offline
+    if (!conn.congested && !conn.evicted)
+        server.deliverDiverted(conn.fd);
+}
+
+// ==================== POOL DE COMANDOS ====================
+
+void UringBackend::drainMailbox()
+{
+    for (auto& item : mailbox.take())
+    {
+        // Pelo id da postagem: o fd pode já ser de outra conexão
+        auto it = connections.find(item.connId);
+        if (it == connections.end())
+            continue;
+
+        if (!item.completed)
+        {
+            send(item.sockfd, item.connId, item.message);
+            continue;
+        }
+
+        Connection& conn = *it->second;
+        conn.busy = false;
+
+        // Conexão fechando: o socket já passou por shutdown e as respostas
+        // não têm para onde ir, então os frames restantes são descartados
+        if (conn.closing)
+        {
+            conn.pendingFrames.clear();
+            finishClose(conn);
+            continue;
+        }
+
+        if (!item.message.empty())
+            send(item.sockfd, item.connId, item.message);
+        scheduleFrames(conn);
+
+        // Fila do pool esvaziou: despacha o que ficou no buffer e volta a receber
+        if (conn.readPaused && conn.pendingFrames.size() < MAX_QUEUED_FRAMES / 2)
+        {
+            conn.readPaused = false;
+            if (processFrames(conn) && !conn.recvArmed && !conn.readPaused)
+                armRecv(conn);
+        }
+    }
+}
+
+void UringBackend::scheduleFrames(Connection& conn)
+{
+    if (conn.busy || conn.pendingFrames.empty())
+        return;
+
+    // Pipelining: um job leva até MAX_PIPELINE_DEPTH frames, executados em ordem
+    size_t depth = std::min(conn.pendingFrames.size(), MAX_PIPELINE_DEPTH);
+    PooledDeque<PooledString> frames(std::make_move_iterator(conn.pendingFrames.begin()),
+                                     std::make_move_iterator(conn.pendingFrames.begin() + depth));
+    conn.pendingFrames.erase(conn.pendingFrames.begin(), conn.pendingFrames.begin() + depth);
+    conn.busy = true;
+
+    // As respostas voltam pela caixa de entrada, na ordem das escritas do handler,
+    // e saem no mesmo flush (um único wake por job)
+    int sockfd = conn.fd;
+    uint64_t conn_id = conn.id;
+    SocketUtils::Encoding encoding = conn.outbound.getEncoding();
+    pool->submit([this, sockfd, conn_id, encoding, frames = std::move(frames)]
+    {
+        for (size_t i = 0; i + 1 < frames.size(); ++i)
+        {
+            string response = handler.processCommand(frames[i], sockfd, encoding);
+            if (!response.empty())
+                mailbox.post(sockfd, conn_id, response);
+        }
+        mailbox.complete(sockfd, conn_id, handler.processCommand(frames.back(), sockfd, encoding));
+        wake();
+    });
+}
+
+// ==================== ESCRITA ====================
+
+bool UringBackend::send(int sockfd, uint64_t conn_id, string_view json_message)
+{
+    // Outra thread (ex: outro backend roteando): entrega via caixa de entrada
+    if (this_thread::get_id() != loopThread)
+    {
+        mailbox.post(sockfd, conn_id, json_message);
+        wake();
+        return true;
+    }
+
+    Connection* conn = writableConnection(sockfd, conn_id);
+    if (!conn)
+        return false;
+
+    conn->outbound.push(json_message);
+    return afterEnqueue(*conn);
+}
+
+bool UringBackend::sendBatch(int sockfd, uint64_t conn_id, const vector<string_view>& messages)
+{
+    if (this_thread::get_id() != loopThread)
+    {
+        mailbox.postBatch(sockfd, conn_id, messages);
+        wake();
+        return true;
+    }
+
+    Connection* conn = writableConnection(sockfd, conn_id);
+    if (!conn)
+        return false;
+
+    for (string_view message : messages)
+        conn->outbound.push(message);
+    return afterEnqueue(*conn);
+}
+
+UringBackend::Connection* UringBackend::writableConnection(int sockfd, uint64_t conn_id)
+{
+    auto it = fdToConnId.find(sockfd);
+    if (it == fdToConnId.end() || it->second != conn_id)
+        return nullptr;
+
+    Connection* conn = connections.at(it->second).get();
+    return conn->closing || conn->evicted ? nullptr : conn;
+}
+
+bool UringBackend::afterEnqueue(Connection& conn)
+{
+    if (!server.enforceOutboundLimits(conn.fd, conn.outbound, conn.sending ? conn.inflightFrames : 0))
+    {
+        // O recv multishot conclui com o shutdown e fecha a conexão pelo caminho normal
+        conn.evicted = true;
+        shutdown(conn.fd, SHUT_RDWR);
+        return false;
+    }
+
+    if (!conn.sending)
+        submitSend(conn);
+    if (!conn.writeTimer.armed())
+        armTimer(conn.writeTimer, server.getTimeouts().writeStallSeconds);
+    updateCongestion(conn);
+    return true;
+}
+
+// ==================== TIMERS ====================
+
+void UringBackend::armTimer(TimerNode& timer, int seconds)
+{
+    if (seconds > 0)
+        timers.schedule(timer, static_cast<uint64_t>(seconds) * 1000);
+}
+
+void UringBackend::onTimer(TimerNode& timer)
+{
+    auto it = fdToConnId.find(timer.data);
+    if (it == fdToConnId.end())
+        return;
+    Connection& conn = *connections.at(it->second);
+
+    switch (timer.kind)
+    {
+        case IDLE_TIMER:
+            closeConnection(conn, "Timeout de inatividade");
+            break;
+
+        case LOGIN_TIMER:
+            if (!isAuthenticated(conn.fd))
+                closeConnection(conn, "Login não realizado no prazo");
+            break;
+
+        case WRITE_STALL_TIMER:
+            closeConnection(conn, "Escrita travada (cliente não lê)");
+            break;
+    }
+}
+
+bool UringBackend::isAuthenticated(int sockfd)
+{
+    lock_guard<mutex> lock(server.getStateMutex());
+    return server.getFdToUser().count(sockfd) > 0;
+}
+
+// ==================== FECHAMENTO ====================
+
+void UringBackend::closeConnection(Connection& conn, const string& reason)
+{
+    if (conn.closing)
+        return;
+
+    cerr << "[Server] Cliente (FD: " << conn.fd << ", IP: " << conn.ip
+         << ") desconectado. Motivo: " << reason << endl;
+
+    conn.closing = true;
+    timers.cancel(conn.idleTimer);
+    timers.cancel(conn.loginTimer);
+    timers.cancel(conn.writeTimer);
+
+    // Job do pool ainda usa o fd: interrompe o I/O e termina na conclusão do job
+    if (conn.busy)
+    {
+        shutdown(conn.fd, SHUT_RDWR);
+        return;
+    }
+
+    finishClose(conn);
+}
+
+void UringBackend::finishClose(Connection& conn)
+{
+    fdToConnId.erase(conn.fd);
+    server.unregisterConnection(conn.fd);
+
+    // shutdown (dentro de cleanupSession) conclui o recv multishot e o send pendentes
+    int sockfd = conn.fd;
+    conn.fd = -1;
+    server.cleanupSession(sockfd);
+
+    releaseIfIdle(conn);
+}
+
+void UringBackend::releaseIfIdle(Connection& conn)
+{
+    if (conn.recvArmed || conn.sending || conn.fd >= 0)
+        return;
+    connections.erase(conn.id);
+}
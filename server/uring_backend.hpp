@@ -0,0 +1,233 @@
+#pragma once
+
+#include "command_handler.hpp"
+#include "frame_reader.hpp"
+#include "io_backend.hpp"
+#include "io_uring.hpp"
+#include "outbound_queue.hpp"
+#include "timer_wheel.hpp"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unordered_map>
+
+class Server;
+class WorkerPool;
+
+/**
+ * Classe UringBackend
+ * -------------------
+ * Backend de I/O baseado em io_uring. Accept, recv e send são submetidos em
+ * lote (uma única io_uring_enter por iteração do loop), com accept e recv
+ * multishot: um único SQE continua gerando conclusões enquanto o socket
+ * estiver ativo. A recepção usa um anel de buffers fornecidos (provided
+ * buffer ring), então o kernel escolhe o buffer só quando há dados.
+ *
+ * Assim como o Reactor, despacha cada frame para CommandHandler::processCommand
+ * na thread do loop ou, com um WorkerPool configurado, em um worker, e
+ * mantém os prazos das conexões numa TimerWheel: a espera no io_uring_enter
+ * vai até o próximo tick com timers vencendo.
+ */
+class UringBackend : public IoBackend
+{
+public:
+    /**
+     * @param server Servidor dono do estado global
+     * @param listen_fd Socket de escuta já em listen
+     */
+    UringBackend(Server& server, int listen_fd);
+    ~UringBackend() override;
+
+    /**
+     * Cria o anel, registra o anel de buffers e arma o accept multishot.
+     * @return false se o kernel não suportar os recursos necessários
+     */
+    bool init() override;
+
+    void run() override;
+    void stop() override;
+
+    /**
+     * Acrescenta a mensagem ao buffer de saída da conexão. Se não houver
+     * envio em andamento, prepara um SEND que segue na próxima submissão.
+     * Chamadas de outras threads passam pela caixa de entrada.
+     */
+    bool send(int sockfd, uint64_t conn_id, std::string_view json_message) override;
+
+    bool sendBatch(int sockfd, uint64_t conn_id, const std::vector<std::string_view>& messages) override;
+
+    const char* name() const override { return "io_uring (multishot + buffer ring)"; }
+
+    /**
+     * Passa a executar os comandos no pool (deve ser chamado antes de run()).
+     */
+    void setWorkerPool(WorkerPool* worker_pool) { pool = worker_pool; }
+
+private:
+    /**
+     * Operação codificada nos 8 bits superiores do user_data das SQEs
+     */
+    enum class Op : uint8_t
+    {
+        ACCEPT = 1,
+        RECV,
+        SEND,
+        WAKE,
+        CANCEL
+    };
+
+    // Frames por SENDMSG (o vetor fica na conexão: 4 KiB em vez dos 16 KiB de IOV_MAX)
+    static constexpr size_t SEND_IOVECS = 256;
+
+    /**
+     * Prazos por conexão (TimerNode::kind; TimerNode::data = fd)
+     */
+    enum TimerKind
+    {
+        IDLE_TIMER,
+        LOGIN_TIMER,
+        WRITE_STALL_TIMER
+    };
+
+    /**
+     * Estado de uma conexão gerenciada pelo backend
+     */
+    struct Connection : PoolAllocated
+    {
+        uint64_t id;                // Identificador único (fds são reutilizados pelo kernel)
+        int fd;
+        std::string ip;
+        FrameReader reader;         // Bytes recebidos ainda não despachados
+        OutboundQueue outbound;     // Frames aguardando envio
+        iovec sendIov[SEND_IOVECS]; // Frames entregues ao kernel no SENDMSG em andamento
+        msghdr sendMsg{};
+        size_t inflightFrames = 0;
+        PooledDeque<PooledString> pendingFrames;  // Frames aguardando o pool
+        bool busy = false;          // Há um job desta conexão no pool
+        bool readPaused = false;    // Fila do pool cheia: recv cancelado até ela esvaziar
+        bool recvArmed = false;
+        bool sending = false;
+        bool closing = false;
+        bool congested = false;     // Último estado de watermark informado ao servidor
+        bool evicted = false;       // Excedeu os limites da fila de saída
+        bool greeted = false;       // Primeiro frame já visto (HELLO só vale nele)
+        TimerNode idleTimer;        // Rearmado a cada recv
+        TimerNode loginTimer;       // Armado no accept
+        TimerNode writeTimer;       // Armado enquanto há bytes pendentes sem progresso
+    };
+
+    Server& server;
+    CommandHandler handler;
+    int listenFd;
+    int wakeFd;
+    uint64_t wakeValue;
+    std::atomic<bool> running;
+    std::thread::id loopThread;
+    Mailbox mailbox;
+    WorkerPool* pool;
+    IoUring ring;
+
+    // Anel de buffers fornecidos para recv multishot
+    io_uring_buf_ring* bufRing;
+    size_t bufRingSize;
+    char* bufPool;
+    size_t bufPoolSize;
+
+    uint64_t nextConnId;
+    PooledMap<uint64_t, std::unique_ptr<Connection>> connections;
+    PooledMap<int, uint64_t> fdToConnId;
+    TimerWheel timers;
+
+    static uint64_t encode(Op op, uint64_t id) { return (static_cast<uint64_t>(op) << 56) | id; }
+
+    /**
+     * Obtém uma SQE, submetendo o lote atual se a fila estiver cheia.
+     */
+    io_uring_sqe* acquireSqe();
+
+    void armAccept();
+    void armRecv(Connection& conn);
+
+    /**
+     * Cancela o recv multishot da conexão (a conclusão chega com -ECANCELED).
+     */
+    void cancelRecv(Connection& conn);
+    void armWake();
+    void submitSend(Connection& conn);
+
+    void handleAccept(int res, uint32_t flags);
+    void handleRecv(Connection& conn, int res, uint32_t flags);
+
+    /**
+     * Despacha os frames completos do buffer de leitura até esvaziá-lo ou a
+     * leitura ser suspensa.
+     * @return false se a conexão foi encerrada
+     */
+    bool processFrames(Connection& conn);
+    void handleSend(Connection& conn, int res);
+
+    /**
+     * Arma o timer da conexão (prazo em segundos; 0 = desligado).
+     */
+    void armTimer(TimerNode& timer, int seconds);
+
+    /**
+     * Trata um prazo vencido (fecha a conexão conforme o tipo).
+     */
+    void onTimer(TimerNode& timer);
+
+    /**
+     * Indica se a conexão já autenticou (consultado quando o prazo de login vence).
+     */
+    bool isAuthenticated(int sockfd);
+
+    /**
+     * Informa ao servidor a travessia dos watermarks da saída pendente.
+     */
+    void updateCongestion(Connection& conn);
+
+    /**
+     * Aplica as escritas e conclusões de jobs postadas por outras threads.
+     */
+    void drainMailbox();
+
+    /**
+     * Submete ao pool o próximo frame da conexão, se ela não tiver job em andamento.
+     */
+    void scheduleFrames(Connection& conn);
+
+    /**
+     * Devolve um buffer ao anel de buffers fornecidos.
+     */
+    void recycleBuffer(uint16_t bid);
+
+    /**
+     * Acorda o loop (eventfd) para processar stop() ou a caixa de entrada.
+     */
+    void wake();
+
+    /**
+     * Conexão do socket com o id dado que ainda aceita escritas (nullptr se
+     * o fd já é de outra conexão, fechando ou evicted).
+     */
+    Connection* writableConnection(int sockfd, uint64_t conn_id);
+
+    /**
+     * Aplica os limites de consumidor lento após enfileirar e dispara o envio.
+     * @return false se a conexão foi derrubada
+     */
+    bool afterEnqueue(Connection& conn);
+
+    /**
+     * Limpa a sessão e fecha o socket. A estrutura da conexão só é liberada
+     * quando não houver mais operações do kernel referenciando seus buffers.
+     * Com um job do pool em andamento, a limpeza espera a conclusão dele.
+     */
+    void closeConnection(Connection& conn, const std::string& reason);
+    void finishClose(Connection& conn);
+    void releaseIfIdle(Connection& conn);
+};
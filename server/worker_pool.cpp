@@ -0,0 +1,148 @@
+#include "worker_pool.hpp"
+#include "metrics.hpp"
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+// ==================== CONSTRUTOR/DESTRUTOR ====================
+
+WorkerPool::WorkerPool(size_t thread_count, size_t capacity)
+    : capacity(max<size_t>(1, capacity)), stopping(false), nextWorker(0), queued(0),
+      active(0), maxDepth(0), executed(0), stolen(0), callerRuns(0)
+{
+    thread_count = max<size_t>(1, thread_count);
+    for (size_t i = 0; i < thread_count; ++i)
+        workers.push_back(make_unique<Worker>());
+    for (size_t i = 0; i < thread_count; ++i)
+        threads.emplace_back(&WorkerPool::workerLoop, this, i);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+
+    for (auto& t : threads)
+        if (t.joinable())
+            t.join();
+}
+
+// ==================== SUBMISSÃO ====================
+
+void WorkerPool::submit(Job job)
+{
+    // Reserva uma vaga; sem vaga, o chamador executa (caller-runs)
+    size_t depth = queued.fetch_add(1) + 1;
+    if (depth > capacity)
+    {
+        queued.fetch_sub(1);
+        callerRuns.fetch_add(1, memory_order_relaxed);
+        job();
+        return;
+    }
+
+    size_t seen = maxDepth.load(memory_order_relaxed);
+    while (depth > seen && !maxDepth.compare_exchange_weak(seen, depth, memory_order_relaxed)) {}
+
+    Worker& worker = *workers[nextWorker.fetch_add(1, memory_order_relaxed) % workers.size()];
+    {
+        lock_guard<mutex> lock(worker.mutex);
+        worker.jobs.push_back(std::move(job));
+    }
+
+    // Sincroniza com a espera do worker para não perder a notificação
+    {
+        lock_guard<mutex> lock(sleepMutex);
+    }
+    wakeup.notify_one();
+}
+
+// ==================== WORKERS ====================
+
+bool WorkerPool::takeJob(size_t index, Job& job)
+{
+    {
+        Worker& own = *workers[index];
+        lock_guard<mutex> lock(own.mutex);
+        if (!own.jobs.empty())
+        {
+            job = std::move(own.jobs.front());
+            own.jobs.pop_front();
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < workers.size(); ++i)
+    {
+        Worker& victim = *workers[(index + i) % workers.size()];
+        lock_guard<mutex> lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            job = std::move(victim.jobs.back());
+            victim.jobs.pop_back();
+            stolen.fetch_add(1, memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void WorkerPool::workerLoop(size_t index)
+{
+    Job job;
+
+    while (true)
+    {
+        if (takeJob(index, job))
+        {
+            queued.fetch_sub(1);
+            active.fetch_add(1, memory_order_relaxed);
+
+            try
+            {
+                job();
+            }
+            catch (const exception& e)
+            {
+                cerr << "[WorkerPool] Erro em job: " << e.what() << endl;
+            }
+
+            job = nullptr;
+            active.fetch_sub(1, memory_order_relaxed);
+            executed.fetch_add(1, memory_order_relaxed);
+            continue;
+        }
+
+        unique_lock<mutex> lock(sleepMutex);
+        if (stopping && queued == 0)
+            return;
+        wakeup.wait(lock, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0)
+            return;
+    }
+}
+
+// ==================== MÉTRICAS ====================
+
+void WorkerPool::registerMetrics(Metrics& metrics)
+{
+    metrics.gauge("chat_pool_threads", "Workers do pool de comandos",
+                  [this] { return static_cast<double>(workers.size()); });
+    metrics.gauge("chat_pool_queue_depth", "Jobs aguardando execucao no pool",
+                  [this] { return static_cast<double>(queued.load()); });
+    metrics.gauge("chat_pool_queue_depth_max", "Maior profundidade de fila observada",
+                  [this] { return static_cast<double>(maxDepth.load()); });
+    metrics.gauge("chat_pool_active", "Jobs em execucao",
+                  [this] { return static_cast<double>(active.load()); });
+    metrics.counter("chat_pool_executed_total", "Jobs executados pelos workers",
+                    [this] { return static_cast<double>(executed.load()); });
+    metrics.counter("chat_pool_stolen_total", "Jobs roubados de outro worker",
+                    [this] { return static_cast<double>(stolen.load()); });
+    metrics.counter("chat_pool_caller_runs_total", "Jobs executados no loop de I/O com o pool cheio",
+                    [this] { return static_cast<double>(callerRuns.load()); });
+}
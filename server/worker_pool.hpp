@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Metrics;
+
+/**
+ * Classe WorkerPool
+ * -----------------
+ * Pool fixo de threads que executa os comandos (CommandHandler::processCommand)
+ * entregues pela camada de I/O, desacoplando o parsing e o trabalho sob
+ * stateMutex dos loops de eventos.
+ *
+ * Cada worker tem sua própria deque; jobs são distribuídos em round-robin e
+ * um worker ocioso rouba do fim da deque dos outros (work-stealing). A
+ * capacidade total é limitada: com o pool cheio, submit() executa o job na
+ * própria thread chamadora (caller-runs), o que aplica backpressure natural
+ * ao loop de I/O em vez de crescer a fila sem limite.
+ *
+ * A ordem por conexão é responsabilidade de quem submete (um job por
+ * conexão em andamento, ver Reactor/UringBackend).
+ */
+class WorkerPool
+{
+public:
+    using Job = std::function<void()>;
+
+    /**
+     * @param threads Número de workers (>= 1)
+     * @param capacity Máximo de jobs aguardando execução
+     */
+    WorkerPool(size_t threads, size_t capacity);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * Enfileira o job; se o pool estiver cheio, executa-o imediatamente
+     * na thread chamadora.
+     */
+    void submit(Job job);
+
+    /**
+     * Registra as métricas do pool (profundidade da fila, roubos, etc.).
+     */
+    void registerMetrics(Metrics& metrics);
+
+    size_t threadCount() const { return workers.size(); }
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    size_t capacity;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeup;
+    std::atomic<bool> stopping;
+
+    std::atomic<size_t> nextWorker;
+    std::atomic<size_t> queued;         // Jobs aguardando (profundidade da fila)
+    std::atomic<size_t> active;         // Jobs em execução
+    std::atomic<size_t> maxDepth;       // Maior profundidade observada
+    std::atomic<uint64_t> executed;
+    std::atomic<uint64_t> stolen;
+    std::atomic<uint64_t> callerRuns;   // Jobs executados na thread de I/O (pool cheio)
+
+    void workerLoop(size_t index);
+
+    /**
+     * Retira um job da própria deque (início) ou rouba de outro worker (fim).
+     */
+    bool takeJob(size_t index, Job& job);
+};
@@ -6,10 +6,14 @@
 # Este script automatiza os testes funcionais do mensageiro.
 # Configurar: chmod +x
 # Executar  : test_suite.sh && ./test_suite.sh
+# Modo de I/O: SERVER_ARGS="--mode threads" ./test_suite.sh (padrão: epoll)
 # ==============================================================================
 
 set -e  # Para na primeira falha
 
+# Argumentos extras repassados ao servidor (ex: "--mode threads")
+SERVER_ARGS="${SERVER_ARGS:-}"
+
 # Cores para output
 RED='\033[0;31m'
 GREEN='\033[0;32m'
@@ -47,6 +51,142 @@ print_info() {
     echo -e "${BLUE}→${NC} $1"
 }
 
+# Cliente de protocolo em Python para os testes de HELLO, codificações
+# binárias, compressão e BATCH (o cliente interativo só fala JSON em linha).
+# Cada script recebe a porta em argv[1] e imprime OK no fim se tudo passou.
+PY_PROTOCOL='
+import json, socket, struct, sys, time, zlib
+
+PORT = int(sys.argv[1])
+TYPES = {"REGISTER": 0, "LOGIN": 1, "LOGOUT": 2, "SEND_MSG": 3, "LIST_USERS": 4,
+         "DELETE_USER": 5, "HELLO": 6, "OK": 7, "LOGIN_OK": 8, "ERROR": 9,
+         "DELIVER_MSG": 10, "USERS": 11, "HELLO_OK": 12, "BATCH": 13, "BATCH_OK": 14}
+COMPRESSED = 0x80
+
+def pack(value, encoding):
+    """MessagePack/CBOR mínimo: objetos, listas, strings e inteiros >= 0"""
+    if encoding == "msgpack":
+        if isinstance(value, dict):
+            out = bytes([0x80 | len(value)]) if len(value) < 16 else b"\xde" + struct.pack(">H", len(value))
+            return out + b"".join(pack(k, encoding) + pack(v, encoding) for k, v in value.items())
+        if isinstance(value, list):
+            out = bytes([0x90 | len(value)]) if len(value) < 16 else b"\xdc" + struct.pack(">H", len(value))
+            return out + b"".join(pack(v, encoding) for v in value)
+        if isinstance(value, int):
+            return bytes([value]) if value < 0x80 else b"\xce" + struct.pack(">I", value)
+        raw = value.encode()
+        return (bytes([0xA0 | len(raw)]) if len(raw) < 32 else b"\xda" + struct.pack(">H", len(raw))) + raw
+
+    def head(major, n):
+        return bytes([major | n]) if n < 24 else bytes([major | 25]) + struct.pack(">H", n)
+    if isinstance(value, dict):
+        return head(0xA0, len(value)) + b"".join(pack(k, encoding) + pack(v, encoding) for k, v in value.items())
+    if isinstance(value, list):
+        return head(0x80, len(value)) + b"".join(pack(v, encoding) for v in value)
+    if isinstance(value, int):
+        return head(0x00, value)
+    raw = value.encode()
+    return head(0x60, len(raw)) + raw
+
+def varint(n):
+    out = b""
+    while True:
+        b = n & 0x7F
+        n >>= 7
+        if n:
+            out += bytes([b | 0x80])
+        else:
+            return out + bytes([b])
+
+def compact(kind, *fields):
+    """Payload do protocolo compacto (v2): versão, tipo e strings com tamanho"""
+    out = bytes([0x02, TYPES[kind]])
+    for f in fields:
+        raw = f if isinstance(f, bytes) else f.encode()
+        out += varint(len(raw)) + raw
+    return out
+
+class Session:
+    def __init__(self, framing="line", encoding="json", compression="none"):
+        self.sock = socket.create_connection(("127.0.0.1", PORT))
+        self.sock.settimeout(3)
+        self.buf = b""
+        self.encoding = encoding
+        self.deflate = zlib.compressobj(6, zlib.DEFLATED, -15)
+        self.inflate = zlib.decompressobj(-15)
+        self.length = framing == "length"
+        if (framing, encoding, compression) != ("line", "json", "none"):
+            hello = {"type": "HELLO", "payload": {"framing": framing, "encoding": encoding,
+                                                  "compression": compression}}
+            self.sock.sendall((json.dumps(hello) + "\n").encode())
+            assert json.loads(self.line())["type"] == "HELLO_OK", "HELLO recusado"
+
+    def fill(self):
+        data = self.sock.recv(65536)
+        if not data:
+            raise EOFError
+        self.buf += data
+
+    def line(self):
+        while b"\n" not in self.buf:
+            self.fill()
+        line, self.buf = self.buf.split(b"\n", 1)
+        return line.decode()
+
+    def send_frame(self, payload, kind, compress=False):
+        flags = 0
+        if compress:
+            payload = self.deflate.compress(payload) + self.deflate.flush(zlib.Z_SYNC_FLUSH)
+            payload, flags = payload[:-4], COMPRESSED
+        self.sock.sendall(struct.pack(">IB", len(payload), TYPES[kind] | flags) + payload)
+
+    def frame(self):
+        """(tipo, payload) do próximo frame LENGTH, já descomprimido"""
+        while len(self.buf) < 5:
+            self.fill()
+        size, kind = struct.unpack(">IB", self.buf[:5])
+        while len(self.buf) < 5 + size:
+            self.fill()
+        payload, self.buf = self.buf[5:5 + size], self.buf[5 + size:]
+        if kind & COMPRESSED:
+            payload = self.inflate.decompress(payload + b"\x00\x00\xff\xff")
+        return kind & ~COMPRESSED, payload
+
+    def send(self, message, compress=False):
+        if not self.length:
+            self.sock.sendall((json.dumps(message) + "\n").encode())
+            return
+        payload = json.dumps(message).encode() if self.encoding == "json" else pack(message, self.encoding)
+        self.send_frame(payload, message["type"], compress)
+
+    def request(self, message, compress=False):
+        self.send(message, compress)
+        if not self.length:
+            return json.loads(self.line())
+        kind, payload = self.frame()
+        return json.loads(payload) if self.encoding == "json" else (kind, payload)
+
+    def closed(self):
+        try:
+            while True:
+                self.fill()
+        except EOFError:
+            return True
+        except (socket.timeout, ConnectionResetError):
+            return False
+
+def msg(kind, **payload):
+    return {"type": kind, "payload": payload}
+
+BAD_FORMAT = {"type": "ERROR", "payload": {"message": "BAD_FORMAT"}}
+'
+
+# Executa o script Python (com PY_PROTOCOL) contra a porta 12345; o log fica em $2
+run_protocol_script() {
+    timeout 30 python3 -c "$PY_PROTOCOL$1" 12345 &>"$2"
+    [ "$(tail -n 1 "$2")" = "OK" ]
+}
+
 cleanup() {
     print_info "Limpando processos..."
     pkill -f "build/server" 2>/dev/null || true
@@ -98,7 +238,7 @@ test_server_startup() {
     cleanup
     
     print_test "2.1" "Iniciando servidor na porta 12345"
-    ./build/server 12345 &>/tmp/server.log &
+    ./build/server 12345 $SERVER_ARGS &>/tmp/server.log &
     SERVER_PID=$!
     sleep 1
     
@@ -120,7 +260,7 @@ test_server_startup() {
     fi
     
     print_test "2.3" "Testando múltiplas instâncias (deve falhar)"
-    if ./build/server 12345 &>/tmp/server2.log & SERVER2_PID=$!; then
+    if ./build/server 12345 $SERVER_ARGS &>/tmp/server2.log & SERVER2_PID=$!; then
         sleep 1
         if ps -p $SERVER2_PID > /dev/null; then
             print_fail "Rejeição de porta duplicada" "Segunda instância aceitou"
@@ -142,7 +282,7 @@ test_client_connection() {
     cleanup
     
     print_test "3.1" "Iniciando servidor"
-    ./build/server 12345 &>/tmp/server.log &
+    ./build/server 12345 $SERVER_ARGS &>/tmp/server.log &
     SERVER_PID=$!
     sleep 1
     
@@ -178,7 +318,7 @@ test_user_registration() {
     cleanup
     
     print_test "4.1" "Iniciando servidor"
-    ./build/server 12345 &>/tmp/server.log &
+    ./build/server 12345 $SERVER_ARGS &>/tmp/server.log &
     SERVER_PID=$!
     sleep 1
     
@@ -239,7 +379,7 @@ test_login_logout() {
     cleanup
     
     print_test "5.1" "Iniciando servidor e registrando usuários"
-    ./build/server 12345 &>/tmp/server.log &
+    ./build/server 12345 $SERVER_ARGS &>/tmp/server.log &
     SERVER_PID=$!
     sleep 1
     
@@ -291,7 +431,7 @@ test_messaging_online() {
     cleanup
     
     print_test "6.1" "Iniciando servidor"
-    ./build/server 12345 &>/tmp/server.log &
+    ./build/server 12345 $SERVER_ARGS &>/tmp/server.log &
     SERVER_PID=$!
     sleep 1
     
@@ -354,7 +494,7 @@ test_store_and_forward() {
     cleanup
     
     print_test "7.1" "Iniciando servidor"
-    ./build/server 12345 &>/tmp/server.log &
+    ./build/server 12345 $SERVER_ARGS &>/tmp/server.log &
     SERVER_PID=$!
     sleep 1
     
@@ -411,7 +551,7 @@ test_list_users() {
     cleanup
     
     print_test "8.1" "Iniciando servidor"
-    ./build/server 12345 &>/tmp/server.log &
+    ./build/server 12345 $SERVER_ARGS &>/tmp/server.log &
     SERVER_PID=$!
     sleep 1
     
@@ -479,7 +619,7 @@ test_user_deletion() {
     cleanup
     
     print_test "9.1" "Iniciando servidor"
-    ./build/server 12345 &>/tmp/server.log &
+    ./build/server 12345 $SERVER_ARGS &>/tmp/server.log &
     SERVER_PID=$!
     sleep 1
     
@@ -535,7 +675,7 @@ test_reconnection() {
     cleanup
     
     print_test "10.1" "Iniciando servidor"
-    ./build/server 12345 &>/tmp/server.log &
+    ./build/server 12345 $SERVER_ARGS &>/tmp/server.log &
     SERVER_PID=$!
     sleep 1
     
@@ -585,7 +725,7 @@ test_multiple_clients() {
     cleanup
     
     print_test "11.1" "Iniciando servidor"
-    ./build/server 12345 &>/tmp/server.log &
+    ./build/server 12345 $SERVER_ARGS &>/tmp/server.log &
     SERVER_PID=$!
     sleep 1
     
@@ -623,6 +763,322 @@ test_multiple_clients() {
     cleanup
 }
 
+# ==============================================================================
+# TESTE 12: Codificações Binárias, Compressão e BATCH
+# ==============================================================================
+test_binary_protocols() {
+    print_header "TESTE 12: CODIFICAÇÕES BINÁRIAS, COMPRESSÃO E BATCH"
+    
+    cleanup
+    
+    if ! command -v python3 &>/dev/null; then
+        print_info "python3 não encontrado, pulando testes de protocolo"
+        return 0
+    fi
+    
+    print_test "12.1" "Iniciando servidor"
+    ./build/server 12345 $SERVER_ARGS &>/tmp/server.log &
+    SERVER_PID=$!
+    sleep 1
+    
+    print_test "12.2" "Sessão no protocolo compacto (v2)"
+    if run_protocol_script '
+a = Session("length", "compact")
+b = Session("length", "compact")
+for nick in ("cp_ana", "cp_bia"):
+    a.send_frame(compact("REGISTER", nick, "Usuaria " + nick), "REGISTER")
+    assert a.frame() == (TYPES["OK"], b"\x02\x07"), "REGISTER compacto"
+a.send_frame(compact("LOGIN", "cp_ana"), "LOGIN")
+assert a.frame()[0] == TYPES["LOGIN_OK"], "LOGIN compacto"
+b.send_frame(compact("LOGIN", "cp_bia"), "LOGIN")
+assert b.frame()[0] == TYPES["LOGIN_OK"], "LOGIN compacto"
+a.send_frame(compact("SEND_MSG", "cp_bia", "olá em v2"), "SEND_MSG")
+assert a.frame()[0] == TYPES["OK"], "SEND_MSG compacto"
+kind, payload = b.frame()
+assert kind == TYPES["DELIVER_MSG"] and "olá em v2".encode() in payload, "DELIVER_MSG compacto"
+a.send_frame(compact("LIST_USERS"), "LIST_USERS")
+kind, payload = a.frame()
+assert kind == TYPES["USERS"] and b"cp_ana" in payload and b"cp_bia" in payload, "USERS compacto"
+print("OK")
+' /tmp/proto_compact.log; then
+        print_success "REGISTER, LOGIN, SEND_MSG e LIST_USERS no protocolo compacto"
+    else
+        print_fail "Sessão no protocolo compacto" "$(tail -n 1 /tmp/proto_compact.log)"
+    fi
+    
+    print_test "12.3" "Frames compactos malformados (devem receber BAD_FORMAT)"
+    if run_protocol_script '
+s = Session("length", "compact")
+bad_format = (TYPES["ERROR"], b"\x02\x09\x01")
+cases = {
+    "varint truncado": b"\x02\x00\x80",
+    "varint longo demais": b"\x02\x00" + b"\xff" * 11,
+    "string além do frame": b"\x02\x01\x10cp",
+    "quantidade além do frame": b"\x02\x0d\xff\xff\xff\xff\x0f",
+    "quantidade acima do limite": b"\x02\x0d" + varint(257) + b"\x02\x02\x04" * 257,
+    "item do BATCH truncado": b"\x02\x0d\x01\x03\x02\x01\x80",
+    "bytes extras": compact("LOGOUT") + b"\x00",
+    "UTF-8 inválido": compact("LOGIN", b"\xc3\x28"),
+}
+for name, payload in cases.items():
+    s.send_frame(payload, "REGISTER")
+    assert s.frame() == bad_format, name
+s.send_frame(b"\x02\x0d\x01\x03\x02\x0d\x00", "BATCH")
+assert s.frame() == (TYPES["BATCH_OK"], b"\x02\x0e\x01\x03\x02\x09\x01"), "BATCH dentro de BATCH"
+s.send_frame(compact("LIST_USERS"), "LIST_USERS")
+assert s.frame()[0] == TYPES["USERS"], "sessão inutilizada após frames malformados"
+print("OK")
+' /tmp/proto_compact_bad.log; then
+        print_success "Varint truncado, quantidade excessiva e BATCH aninhado rejeitados"
+    else
+        print_fail "Frames compactos malformados" "$(tail -n 1 /tmp/proto_compact_bad.log)"
+    fi
+    
+    print_test "12.4" "Sessões em MessagePack e CBOR"
+    if run_protocol_script '
+for enc in ("msgpack", "cbor"):
+    a = Session("length", enc)
+    b = Session("length", enc)
+    for nick in ("%s_a" % enc, "%s_b" % enc):
+        assert a.request(msg("REGISTER", nickname=nick, fullname="Teste " + enc))[0] == TYPES["OK"], enc + " REGISTER"
+    assert a.request(msg("LOGIN", nickname=enc + "_a"))[0] == TYPES["LOGIN_OK"], enc + " LOGIN"
+    assert b.request(msg("LOGIN", nickname=enc + "_b"))[0] == TYPES["LOGIN_OK"], enc + " LOGIN"
+    assert a.request(msg("SEND_MSG", to=enc + "_b", text="via " + enc))[0] == TYPES["OK"], enc + " SEND_MSG"
+    kind, payload = b.frame()
+    assert kind == TYPES["DELIVER_MSG"] and ("via " + enc).encode() in payload, enc + " DELIVER_MSG"
+    kind, payload = a.request(msg("SEND_MSG", to="ninguem_aqui", text="x"))
+    assert kind == TYPES["ERROR"] and b"NO_SUCH_USER" in payload, enc + " erro pré-codificado"
+    a.send_frame(pack(msg("LOGIN", nickname="x"), enc)[:-3], "LOGIN")
+    kind, payload = a.frame()
+    assert kind == TYPES["ERROR"] and b"BAD_FORMAT" in payload, enc + " documento truncado"
+print("OK")
+' /tmp/proto_binary.log; then
+        print_success "Requisições e respostas em MessagePack e CBOR"
+    else
+        print_fail "Sessões em MessagePack e CBOR" "$(tail -n 1 /tmp/proto_binary.log)"
+    fi
+    
+    print_test "12.5" "Envelope BATCH"
+    if run_protocol_script '
+s = Session()
+r = s.request(msg("BATCH", requests=[
+    msg("REGISTER", nickname="bt_um", fullname="Batch Um"),
+    msg("REGISTER", nickname="bt_dois", fullname="Batch Dois"),
+    msg("LOGIN", nickname="bt_um"),
+    msg("BATCH", requests=[]),
+    {"type": "FOO", "payload": {}},
+    msg("SEND_MSG", to="bt_dois", text="offline via batch"),
+]))
+assert r["type"] == "BATCH_OK", r
+types = [x["type"] for x in r["payload"]["responses"]]
+assert types == ["OK", "OK", "LOGIN_OK", "ERROR", "ERROR", "OK"], types
+assert r["payload"]["responses"][3] == BAD_FORMAT, "BATCH aninhado"
+assert s.request(msg("BATCH", requests=[]))["payload"]["responses"] == [], "BATCH vazio"
+assert s.request(msg("BATCH", requests=5)) == BAD_FORMAT, "requests não é lista"
+assert s.request(msg("BATCH", requests=[msg("LIST_USERS")] * 257)) == BAD_FORMAT, "BATCH acima do limite"
+c = Session("length", "compact")
+c.send_frame(b"\x02\x0d\x02" + varint(len(compact("LOGIN", "bt_dois"))) + compact("LOGIN", "bt_dois")
+             + varint(len(compact("LIST_USERS"))) + compact("LIST_USERS"), "BATCH")
+frames = dict([c.frame(), c.frame()])
+assert TYPES["BATCH_OK"] in frames and b"bt_um" in frames[TYPES["BATCH_OK"]], "BATCH_OK compacto"
+assert b"offline via batch" in frames.get(TYPES["DELIVER_MSG"], b""), "entrega offline no login do BATCH"
+print("OK")
+' /tmp/proto_batch.log; then
+        print_success "BATCH em JSON e no protocolo compacto, com limites"
+    else
+        print_fail "Envelope BATCH" "$(tail -n 1 /tmp/proto_batch.log)"
+    fi
+    
+    print_test "12.6" "Caminho rápido e DOM concordam (chaves repetidas e escapes)"
+    if run_protocol_script '
+s = Session()
+raw = [
+    r"""{"type":"REGISTER","payload":{"nickname":"dup_a","nickname":"dup_b","fullname":"Rapido"}}""",
+    r"""{"type":"REGISTER","payload":{"nickname":"dup_c","nickname":"dup_d","fullname":"Com \u00e9scape"}}""",
+    r"""{"type":"REGISTER","payload":{"nickname":"esca","fullname":"Aspas \"e\" barra \\ ok"}}""",
+    r"""{"type":"LOGOUT","type":"LIST_USERS","payload":{}}""",
+    r"""{"type":"REGISTER","payload":{"nickname":"dup_e","fullname":"x"},"payload":{}}""",
+]
+for line in raw[:3]:
+    s.sock.sendall(line.encode() + b"\n")
+    assert json.loads(s.line())["type"] == "OK", line
+s.sock.sendall(raw[3].encode() + b"\n")
+users = json.loads(s.line())
+assert users["type"] == "USERS", users
+names = {u["nick"]: u["name"] for u in users["payload"]["users"]}
+assert "dup_b" in names and "dup_a" not in names, "rápido: vale a última chave"
+assert "dup_d" in names and "dup_c" not in names, "DOM: vale a última chave"
+assert names["dup_d"] == "Com éscape" and names["esca"] == "Aspas \"e\" barra \\ ok", names
+s.sock.sendall(raw[4].encode() + b"\n")
+assert json.loads(s.line()) == BAD_FORMAT, "payload repetido: vale o último (vazio)"
+print("OK")
+' /tmp/proto_fastpath.log; then
+        print_success "Chaves repetidas e escapes tratados igual nos dois caminhos"
+    else
+        print_fail "Caminho rápido e DOM" "$(tail -n 1 /tmp/proto_fastpath.log)"
+    fi
+    
+    print_test "12.7" "Compressão deflate e proteção contra bombas"
+    if run_protocol_script '
+a = Session("length", "json", "deflate")
+b = Session("length", "json", "deflate")
+for nick in ("zl_a", "zl_b"):
+    assert a.request(msg("REGISTER", nickname=nick, fullname="Deflate"), compress=True)["type"] == "OK", nick
+assert a.request(msg("LOGIN", nickname="zl_a"), compress=True)["type"] == "LOGIN_OK"
+assert b.request(msg("LOGIN", nickname="zl_b"))["type"] == "LOGIN_OK"
+for i in range(3):
+    text = "mensagem comprimida %d " % i + "bla " * 200
+    assert a.request(msg("SEND_MSG", to="zl_b", text=text), compress=True)["type"] == "OK"
+    kind, payload = b.frame()
+    assert kind == TYPES["DELIVER_MSG"] and json.loads(payload)["payload"]["text"] == text, "DELIVER_MSG comprimido"
+bomb = Session("length", "json", "deflate")
+bomb.send_frame(b" " * (2 * 1024 * 1024), "SEND_MSG", compress=True)
+assert bomb.closed(), "bomba acima do limite não derrubou a conexão"
+assert Session().request(msg("LIST_USERS"))["type"] == "USERS", "servidor parou após a bomba"
+print("OK")
+' /tmp/proto_deflate.log; then
+        print_success "Frames comprimidos entregues e bomba de descompressão recusada"
+    else
+        print_fail "Compressão deflate" "$(tail -n 1 /tmp/proto_deflate.log)"
+    fi
+    
+    cleanup
+}
+
+# ==============================================================================
+# TESTE 13: Estado por UserId nos Modos de I/O e Handoff
+# ==============================================================================
+test_interned_state() {
+    print_header "TESTE 13: ESTADO POR USERID NOS MODOS DE I/O E HANDOFF"
+    
+    cleanup
+    
+    if ! command -v python3 &>/dev/null; then
+        print_info "python3 não encontrado, pulando testes de estado"
+        return 0
+    fi
+    
+    # Cadastro, fila offline, deleção com reaproveitamento do id e listagem
+    local STATE_SCRIPT='
+a, b = Session(), Session()
+for nick in ("id_um", "id_dois", "id_tres"):
+    assert a.request(msg("REGISTER", nickname=nick, fullname="Nome " + nick))["type"] == "OK", nick
+assert a.request(msg("REGISTER", nickname="id_um", fullname="x"))["payload"]["message"] == "NICK_TAKEN"
+assert a.request(msg("LOGIN", nickname="id_um"))["type"] == "LOGIN_OK"
+assert a.request(msg("SEND_MSG", to="id_dois", text="offline 1"))["type"] == "OK"
+b.send(msg("LOGIN", nickname="id_dois"))
+first, second = json.loads(b.line()), json.loads(b.line())
+assert {first["type"], second["type"]} == {"LOGIN_OK", "DELIVER_MSG"}, "entrega offline no login"
+deliver = first if first["type"] == "DELIVER_MSG" else second
+assert deliver["from"] == "id_um" and deliver["payload"]["text"] == "offline 1", deliver
+assert b.request(msg("DELETE_USER", nickname="id_dois"))["type"] == "OK", "DELETE_USER"
+assert a.request(msg("REGISTER", nickname="id_quatro", fullname="Quatro"))["type"] == "OK"
+users = a.request(msg("LIST_USERS"))["payload"]["users"]
+assert sorted(u["nick"] for u in users) == ["id_quatro", "id_tres", "id_um"], users
+assert [u["online"] for u in users if u["nick"] == "id_um"] == [True], users
+assert a.request(msg("SEND_MSG", to="id_dois", text="x"))["payload"]["message"] == "NO_SUCH_USER"
+r = a.request(msg("BATCH", requests=[msg("SEND_MSG", to="id_quatro", text="batch %d" % i) for i in range(3)]))
+assert [x["type"] for x in r["payload"]["responses"]] == ["OK"] * 3, r
+c = Session()
+c.send(msg("LOGIN", nickname="id_quatro"))
+texts = sorted(m["payload"]["text"] for m in (json.loads(c.line()) for _ in range(4)) if m["type"] == "DELIVER_MSG")
+assert texts == ["batch 0", "batch 1", "batch 2"], "id reaproveitado herdou estado antigo: %s" % texts
+assert a.request(msg("LOGOUT"))["type"] == "OK"
+print("OK")
+'
+    
+    local TEST_NUM=1
+    for MODE in epoll threads uring sharded coro; do
+        print_test "13.$TEST_NUM" "Cadastro, fila offline, deleção e BATCH (modo $MODE)"
+        ./build/server 12345 --mode $MODE --reactors 2 &>/tmp/server_$MODE.log &
+        SERVER_PID=$!
+        sleep 1
+        
+        if run_protocol_script "$STATE_SCRIPT" /tmp/state_$MODE.log; then
+            print_success "Estado por UserId consistente no modo $MODE"
+        else
+            print_fail "Estado por UserId (modo $MODE)" "$(tail -n 1 /tmp/state_$MODE.log)"
+        fi
+        
+        cleanup
+        TEST_NUM=$((TEST_NUM+1))
+    done
+    
+    print_test "13.6" "Atualização a quente preserva cadastro, sessões e filas"
+    local UPGRADE_SOCKET=/tmp/chat_test_upgrade.sock
+    rm -f $UPGRADE_SOCKET
+    ./build/server 12345 --upgrade-socket $UPGRADE_SOCKET &>/tmp/server_old.log &
+    SERVER_PID=$!
+    sleep 1
+    
+    if run_protocol_script '
+import subprocess
+a = Session("length", "json", "deflate")
+b = Session("length", "json", "deflate")
+for nick in ("hf_a", "hf_b", "hf_c"):
+    assert a.request(msg("REGISTER", nickname=nick, fullname="Handoff " + nick))["type"] == "OK", nick
+assert a.request(msg("LOGIN", nickname="hf_b"))["type"] == "LOGIN_OK"
+assert a.request(msg("DELETE_USER", nickname="hf_b"))["type"] == "OK", "DELETE_USER"
+assert a.request(msg("REGISTER", nickname="hf_d", fullname="Handoff d"))["type"] == "OK"
+assert a.request(msg("LOGIN", nickname="hf_a"))["type"] == "LOGIN_OK"
+assert b.request(msg("LOGIN", nickname="hf_c"))["type"] == "LOGIN_OK"
+assert a.request(msg("SEND_MSG", to="hf_d", text="fila antes"))["type"] == "OK"
+new = subprocess.Popen(["./build/server", str(PORT), "--takeover", "/tmp/chat_test_upgrade.sock"],
+                       stdout=open("/tmp/server_new.log", "w"), stderr=subprocess.STDOUT)
+time.sleep(1.5)
+assert new.poll() is None, "processo novo não assumiu"
+text = "depois da atualização " + "bla " * 50
+assert a.request(msg("SEND_MSG", to="hf_c", text=text), compress=True)["type"] == "OK"
+kind, payload = b.frame()
+assert json.loads(payload)["payload"]["text"] == text, "sessão comprimida não sobreviveu"
+users = a.request(msg("LIST_USERS"))["payload"]["users"]
+assert sorted(u["nick"] for u in users) == ["hf_a", "hf_c", "hf_d"], users
+d = Session()
+d.send(msg("LOGIN", nickname="hf_d"))
+types = sorted(json.loads(d.line())["type"] for _ in range(2))
+assert types == ["DELIVER_MSG", "LOGIN_OK"], "fila offline perdida: %s" % types
+print("OK")
+' /tmp/state_handoff.log; then
+        print_success "Handoff com UserIds, sessões e fila offline preservados"
+    else
+        print_fail "Atualização a quente" "$(tail -n 1 /tmp/state_handoff.log)"
+    fi
+    
+    rm -f $UPGRADE_SOCKET
+    cleanup
+    
+    print_test "13.7" "Comandos em pipeline respondidos em ordem (modo sharded)"
+    ./build/server 12345 --mode sharded --reactors 4 &>/tmp/server_pipeline.log &
+    SERVER_PID=$!
+    sleep 1
+    
+    if run_protocol_script '
+a = Session()
+nicks = ["pl_%d" % i for i in range(4)]
+frames = [msg("REGISTER", nickname=n, fullname="Pipeline " + n) for n in nicks]
+frames += [msg("LOGIN", nickname=nicks[0])]
+frames += [msg("SEND_MSG", to=n, text="pipeline") for n in nicks[1:3]]
+frames += [msg("LOGOUT")]
+a.sock.sendall("".join(json.dumps(f) + "\n" for f in frames).encode())
+types = [json.loads(a.line())["type"] for _ in frames]
+assert types == ["OK"] * 4 + ["LOGIN_OK"] + ["OK"] * 3, types
+items = [msg("LOGIN", nickname=nicks[1])] + [msg("SEND_MSG", to=n, text="batch") for n in nicks[2:]]
+a.send(msg("BATCH", requests=items + [msg("LOGOUT")]))
+r = json.loads(a.line())
+assert r["type"] == "DELIVER_MSG" and r["payload"]["text"] == "pipeline", r
+r = json.loads(a.line())
+types = [x["type"] for x in r["payload"]["responses"]]
+assert types == ["LOGIN_OK", "OK", "OK", "OK"], types
+print("OK")
+' /tmp/state_pipeline.log; then
+        print_success "Respostas na ordem dos comandos entre shards"
+    else
+        print_fail "Pipelining entre shards" "$(tail -n 1 /tmp/state_pipeline.log)"
+    fi
+    
+    cleanup
+}
+
 # ==============================================================================
 # EXECUÇÃO DOS TESTES
 # ==============================================================================
@@ -654,6 +1110,8 @@ main() {
     test_user_deletion
     test_reconnection
     test_multiple_clients
+    test_binary_protocols
+    test_interned_state
     
     # Relatório final
     print_header "RELATÓRIO FINAL"